@@ -6,23 +6,35 @@
 #define API_OBSERVATION_H
 
 #include "Server_management.h"
+#include "RoverRegistry.h"
 #include "TelemetryStream.h"
+#include "TelemetryHistory.h"
+#include "TelemetryRollup.h"
+#include "SpatialIndex.h"
+#include "ResultTransfer.h"
 #include <stdint.h>
 
 // ============ CONSTANTES ============
 #define API_PORT 8080
 #define API_BUFFER_SIZE 65536
 #define MAX_HTTP_CLIENTS 10
+#define API_LOW_SIGNAL_THRESHOLD 30        // Sinal (%) abaixo do qual um rover conta como fraco
 
 // ============ TIPOS DE ENDPOINTS ============
 typedef enum {
     ENDPOINT_ROVERS_LIST,      // GET /api/rovers
+    ENDPOINT_ROVERS_BBOX,      // GET /api/rovers?bbox=x1,y1,x2,y2
+    ENDPOINT_ROVERS_NEAREST,   // GET /api/rovers/nearest?x=&y=&k=
     ENDPOINT_ROVER_STATUS,     // GET /api/rovers/{id}
     ENDPOINT_MISSIONS_LIST,    // GET /api/missions
     ENDPOINT_MISSION_STATUS,   // GET /api/missions/{id}
     ENDPOINT_TELEMETRY_LAST,   // GET /api/telemetry/latest
     ENDPOINT_TELEMETRY_ROVER,  // GET /api/telemetry/{rover_id}
+    ENDPOINT_TELEMETRY_HISTORY,// GET /api/telemetry/{rover_id}/history?from=&to=&step=
     ENDPOINT_SYSTEM_STATUS,    // GET /api/system/status
+    ENDPOINT_EVENTS,           // GET /api/events?since=N
+    ENDPOINT_RESULTS_LIST,     // GET /api/results
+    ENDPOINT_RESULT_DOWNLOAD,  // GET /api/results/{name}
     ENDPOINT_NOT_FOUND,        // 404
     ENDPOINT_INVALID           // 400
 } APIEndpoint;
@@ -36,23 +48,31 @@ int create_http_server(int port);
 int accept_http_connection(int server_fd);
 
 // Processar requisição HTTP
+// (rovers: vistas do registo ordenadas por rover_id)
 void process_http_request(int client_fd, const char *request,
-                         RoverSession *rovers, int num_rovers,
-                         MissionRecord *missions, int num_missions,
-                         TelemetrySession *telemetry, int num_telemetry);
+                         const RoverView *rovers, int num_rovers,
+                         MissionRecord *missions, int num_missions);
 
 // Identificar tipo de endpoint
 APIEndpoint parse_http_endpoint(const char *request, char *resource_id);
 
+// Ler parâmetro da query string (?nome=valor) da linha de pedido
+// Devolve 1 se encontrado, 0 caso contrário
+int get_query_param(const char *request, const char *name, char *value, size_t size);
+
 // ============ GERAÇÃO DE RESPOSTAS (JSON) ============
 
 // Gerar JSON com lista de rovers
 void generate_rovers_list_json(char *buffer, size_t buf_size,
-                               RoverSession *rovers, int num_rovers);
+                               const RoverView *rovers, int num_rovers);
+
+// Gerar JSON com resultados de uma consulta espacial (bbox ou vizinhos)
+void generate_spatial_json(char *buffer, size_t buf_size, const char *query,
+                           SpatialResult *results, size_t count, int truncated);
 
 // Gerar JSON com status de um rover
 void generate_rover_status_json(char *buffer, size_t buf_size,
-                                RoverSession *rover);
+                                const RoverView *rover);
 
 // Gerar JSON com lista de missões
 void generate_missions_list_json(char *buffer, size_t buf_size,
@@ -64,17 +84,37 @@ void generate_mission_status_json(char *buffer, size_t buf_size,
 
 // Gerar JSON com últimas telemetrias
 void generate_telemetry_latest_json(char *buffer, size_t buf_size,
-                                    TelemetrySession *telemetry, int num_telemetry);
+                                    const RoverView *rovers, int num_rovers);
 
 // Gerar JSON com telemetria de um rover
 void generate_telemetry_rover_json(char *buffer, size_t buf_size,
-                                   TelemetrySession *telemetry);
+                                   const TelemetrySession *telemetry);
+
+// Gerar JSON com histórico de telemetria de um rover
+void generate_telemetry_history_json(char *buffer, size_t buf_size,
+                                     const char *rover_id, const char *source,
+                                     TelemetrySample *samples, size_t count,
+                                     uint32_t from, uint32_t to, uint32_t step,
+                                     int truncated);
+
+// Gerar JSON com agregados de telemetria (min/max/média/último por intervalo)
+void generate_telemetry_rollup_json(char *buffer, size_t buf_size,
+                                    const char *rover_id, uint32_t resolution,
+                                    RollupBucket *buckets, size_t count,
+                                    uint32_t from, uint32_t to, uint32_t step,
+                                    int truncated);
+
+// Gerar JSON com eventos do stream (id > since)
+void generate_events_json(char *buffer, size_t buf_size, uint64_t since);
+
+// Gerar JSON com os resultados de missão recebidos
+void generate_results_list_json(char *buffer, size_t buf_size,
+                                const ResultInfo *results, size_t count, int truncated);
 
 // Gerar JSON com status do sistema
 void generate_system_status_json(char *buffer, size_t buf_size,
-                                 RoverSession *rovers, int num_rovers,
-                                 MissionRecord *missions, int num_missions,
-                                 TelemetrySession *telemetry, int num_telemetry);
+                                 const RoverView *rovers, int num_rovers,
+                                 MissionRecord *missions, int num_missions);
 
 // ============ UTILITÁRIOS ============
 
@@ -82,9 +122,16 @@ void generate_system_status_json(char *buffer, size_t buf_size,
 void send_http_response(int client_fd, int status_code, const char *content_type,
                        const char *body);
 
+// Enviar um ficheiro como corpo da resposta (sendfile, sem cópia)
+void send_http_file(int client_fd, int file_fd, uint64_t size, const char *content_type,
+                    const char *filename);
+
 // Obter nome do estado operacional
 const char* get_rover_state_name(uint8_t state);
 
+// Obter nome do estado de uma missão
+const char* get_mission_status_name(MissionStatus status);
+
 // Converter timestamp para string ISO
 void format_timestamp(uint32_t ts, char *buffer, size_t size);
 
@@ -0,0 +1,60 @@
+// ============ API_Workers.h ============
+// Pool de threads HTTP desacoplado do ciclo principal (MissionLink)
+// O ciclo principal apenas aceita conexões e publica snapshots imutáveis do
+// estado; os workers retiram as conexões de uma fila lock-free e renderizam
+// as respostas JSON a partir do snapshot mais recente.
+
+#ifndef API_WORKERS_H
+#define API_WORKERS_H
+
+#include "Server_management.h"
+#include "RoverRegistry.h"
+#include <stdint.h>
+#include <time.h>
+
+// ============ CONSTANTES ============
+#define API_WORKER_THREADS 4                         // Threads de renderização
+#define API_QUEUE_CAPACITY 64                        // Fila de conexões (potência de 2)
+#define API_SNAPSHOT_BUFFERS (API_WORKER_THREADS + 2) // Garante sempre um buffer livre
+#define API_RECV_TIMEOUT_MS 2000                     // Timeout de leitura do pedido HTTP
+#define API_SNAPSHOT_INTERVAL_MS 200                 // Cadência de publicação dos snapshots
+
+// ============ ESTRUTURA: SNAPSHOT IMUTÁVEL DO ESTADO ============
+// Preenchido apenas pelo ciclo principal; depois de publicado nunca é
+// alterado enquanto existirem leitores (refs > 0).
+typedef struct {
+    RoverView *rovers;              // Vistas do registo, ordenadas por ID (cresce com ele)
+    int num_rovers;
+    size_t rovers_capacity;
+    MissionRecord missions[MAX_MISSIONS];
+    int num_missions;
+
+    time_t published_at;            // Hora da publicação
+    uint64_t version;               // Versão monotónica do snapshot
+    int refs;                       // Workers a ler este snapshot (atómico)
+} APISnapshot;
+
+// ============ FUNÇÕES: POOL DE WORKERS ============
+
+// Arrancar as threads de renderização (0=ok, -1=erro)
+int api_workers_start(void);
+
+// Parar as threads e fechar conexões pendentes
+void api_workers_stop(void);
+
+// Entregar uma conexão aceite aos workers (0=ok, -1=fila cheia)
+int api_workers_submit(int client_fd);
+
+// ============ FUNÇÕES: SNAPSHOTS ============
+
+// Publicar novo snapshot (chamado apenas pelo ciclo principal, a cada
+// API_SNAPSHOT_INTERVAL_MS)
+void api_publish_snapshot(MissionRecord *missions, int num_missions);
+
+// Obter o snapshot atual (incrementa refs); NULL se ainda não houver
+APISnapshot* api_acquire_snapshot(void);
+
+// Libertar snapshot obtido com api_acquire_snapshot
+void api_release_snapshot(APISnapshot *snap);
+
+#endif // API_WORKERS_H
@@ -0,0 +1,48 @@
+// ============ EventLog.h ============
+// Stream de eventos operacionais (alertas de saúde dos rovers, ...)
+// Anel de capacidade fixa: escrito pelo ciclo principal, lido pelos workers
+// HTTP através de /api/events?since=<id>.
+
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+
+// ============ CONSTANTES ============
+#define EVENT_LOG_CAPACITY 256           // Eventos retidos (potência de 2)
+#define EVENT_QUERY_MAX 64               // Eventos máximos por resposta
+
+// ============ TIPOS DE DADOS ============
+typedef enum {
+    EVENT_INFO = 0,
+    EVENT_WARNING = 1,
+    EVENT_CRITICAL = 2
+} EventLevel;
+
+// ============ ESTRUTURA: EVENTO ============
+typedef struct {
+    uint64_t id;                     // Crescente a partir de 1
+    time_t timestamp;
+    uint8_t level;                   // EventLevel
+    char rover_id[32];
+    char type[32];                   // Ex.: "battery_drain", "battery_drain_cleared"
+    char message[128];
+} Event;
+
+// ============ FUNÇÕES ============
+
+// Acrescentar um evento (formato printf na mensagem); devolve o ID
+uint64_t event_log_emit(EventLevel level, const char *rover_id, const char *type,
+                        const char *fmt, ...);
+
+// Eventos com id > since, por ordem. *next recebe o id a usar no próximo
+// pedido; *dropped=1 se eventos pedidos já saíram do anel.
+size_t event_log_read(uint64_t since, Event *out, size_t max_out,
+                      uint64_t *next, int *dropped);
+
+// Nome do nível ("info", "warning", "critical")
+const char* event_level_name(uint8_t level);
+
+#endif // EVENTLOG_H
@@ -1,11 +1,16 @@
 // ============ Heartbeat.h (ATUALIZADO) ============
 // Sistema de heartbeat para verificar saúde dos rovers
 // A Nave-Mãe envia PING periodicamente, rover responde com PONG
+// Cada rover tem os seus eventos (PING, timeout do PONG, expiração) numa
+// roda de temporizadores: o trabalho por tick é proporcional aos eventos
+// que vencem, não ao tamanho da frota.
 #ifndef HEARTBEAT_H
 #define HEARTBEAT_H
 
 #include "MissionLink.h"
+#include "MissionLinkARQ.h"
 #include "Server_management.h"
+#include "TimerWheel.h"
 
 // ============ TIPOS DE HEARTBEAT ============
 typedef enum {
@@ -17,32 +22,55 @@ typedef enum {
 #define HEARTBEAT_INTERVAL 30        // Enviar PING a cada 30 segundos (ALTERADO: era 60)
 #define HEARTBEAT_TIMEOUT 5          // Timeout para resposta: 5 segundos (ALTERADO: era 10)
 #define HEARTBEAT_MAX_RETRIES 2      // Máximo de PINGs sem resposta antes de marcar inativo (ALTERADO: era 1)
+#define ROVER_EXPIRY_TIMEOUT 35      // Sem atividade durante 35 s: rover "inactive" na API
 
 // ============ ESTRUTURA: ESTADO DE HEARTBEAT ============
 typedef struct {
     time_t last_ping_sent;           // Hora do último PING enviado
     time_t last_pong_received;       // Hora do último PONG recebido
+    int waiting_for_pong;            // 1 se aguardando PONG
     int consecutive_missed_pongs;    // PINGs sem resposta consecutivos
     int is_healthy;                  // 1=saudável, 0=inativo/morto
+    uint32_t ping_seq;               // Sequência do PING em curso
+    uint64_t ping_sent_us;           // Envio do PING (0 se foi repetido: Karn)
+    ArqRtt rtt;                      // RTT medido por PING/PONG
+    int expired;                     // Sem atividade há ROVER_EXPIRY_TIMEOUT
+    Timer ping_timer;                // Próximo PING
+    Timer pong_timer;                // Timeout do PING em curso
+    Timer expiry_timer;              // Fim da janela de atividade
 } HeartbeatState;
 
+struct RoverEntity;                  // RoverRegistry.h
+
+// Chamada quando um rover é marcado inativo (p.ex. retirar a fila de missões)
+typedef void (*HeartbeatInactiveFn)(struct RoverEntity *rover);
+
 // ============ FUNÇÕES SERVIDOR (NAVE-MÃE) ============
 
-// Verificar e enviar PING para rovers inativos
-void check_and_send_heartbeats(int sockfd, RoverSession *sessions, int num_rovers);
+// Roda de temporizadores e socket MissionLink usados pelos eventos;
+// on_inactive pode ser NULL
+void heartbeat_init(TimerWheel *wheel, int sockfd, HeartbeatInactiveFn on_inactive);
+
+// Agendar os eventos de um rover que acabou de se ligar
+void heartbeat_start(struct RoverEntity *rover);
+
+// Registar atividade do rover (PONG ou qualquer pacote MissionLink válido):
+// adia a expiração e retoma os PINGs de um rover que estava inativo
+void heartbeat_seen(struct RoverEntity *rover);
 
-// Processar PONG recebido
-void process_pong(RoverSession *rover, HeartbeatState *heartbeat);
+// Processar PONG recebido (amostra de RTT se responde ao PING em curso)
+void process_pong(struct RoverEntity *rover, const PacketView *pong);
 
 // Marcar rover como inativo
-void mark_rover_inactive(RoverSession *rover, HeartbeatState *heartbeat);
+void mark_rover_inactive(struct RoverEntity *rover);
 
 // ============ FUNÇÕES CLIENTE (ROVER) ============
 
-// Processar PING recebido e enviar PONG
-void process_ping_and_respond(int sockfd, Packet *ping_pkt, struct sockaddr_in *server_addr, const char *rover_id);
+// Processar PING recebido e enviar PONG (conn_id: ID de conexão do rover)
+void process_ping_and_respond(int sockfd, const PacketView *ping_pkt, struct sockaddr_in *server_addr,
+                              const char *rover_id, uint32_t conn_id);
 
 // Imprimir status de heartbeat
-void print_heartbeat_status(RoverSession *sessions, int num_rovers);
+void print_heartbeat_status(void);
 
 #endif // HEARTBEAT_H
\ No newline at end of file
@@ -5,15 +5,37 @@
 //
 // ESPECIFICAÇÃO DO PROTOCOLO:
 // ============================
-// 1. HANDSHAKE: Byte 0xFF para iniciar conexão
-// 2. Todos os pacotes têm 228 bytes (sizeof(Packet))
+// 1. HANDSHAKE: MLHandshake (0xFF + rover_id); a Nave-Mãe responde com um
+//    ID de conexão e um token de retoma. O ID segue em todos os pacotes e é
+//    ele que identifica o rover (o endereço de origem pode mudar: a sessão
+//    segue-o). O token vai nos SYN: um rover reiniciado com o par guardado
+//    envia logo o REQUEST, sem handshake. Um ID desconhecido ou um token
+//    errado recebe ML_HS_RETRY (repetir o handshake). Cada handshake emite
+//    um par novo e invalida o anterior; enquanto a conexão do rover está
+//    ativa (heartbeat) só é aceite com o token atual (ML_HS_BUSY caso
+//    contrário), para que ninguém a tome só com o rover_id.
+// 2. Na rede, cada Packet segue codificado em little-endian com versão,
+//    comprimento e CRC32C (MissionLinkWire.h: ML_WIRE_PACKET_SIZE bytes)
 // 3. Sequência de mensagens:
 //    - Rover: REQUEST (seq=N)
-//    - Servidor: ASSIGN (seq=N+1) com parâmetros de missão
+//    - Servidor: ASSIGN com parâmetros de missão, num stream próprio (sequência
+//      da Nave-Mãe), retransmitida até o rover a confirmar; confirma o REQUEST
+//      (ACK levado no próprio pacote, ML_FLAG_ACK)
 //    - Rover: PROGRESS × N (seq incremental)
 //    - Rover: COMPLETE (seq final)
-//    - Ambos: ACK confirmando recepção
-// 4. Confiabilidade: ACK obrigatório, retransmissão automática (5 tentativas)
+//    - Fila de missões: o REQUEST diz quantas missões o rover quer em fila
+//      (queue_depth) e cada ASSIGN devolve a fila concedida (até
+//      MISSION_QUEUE_MAX); o rover volta a pedir enquanto executa, até ter
+//      a fila cheia, e passa à seguinte sem esperar. A Nave-Mãe reserva as
+//      missões e pode retirar as ainda não iniciadas (MISSION_REVOKE, fiável)
+//    - Servidor: MISSION_DEFER (seq do REQUEST, confirma-o) quando não pode
+//      atribuir agora (ASSIGNs por confirmar ou fila já reservada): o rover
+//      volta a pedir mais tarde. REQUEST confirmado sem ASSIGN nem DEFER
+//      significa que não há mais missões
+//    - Ambos: ACK cumulativo (ack_seq) + bitmap seletivo; a Nave-Mãe atrasa
+//      e junta ACKs numa janela curta
+// 4. Confiabilidade: janela deslizante com ACK seletivo e retransmissão
+//    por pacote (MissionLinkARQ.h); entrega por ordem no recetor
 
 #ifndef MISSIONLINK_H
 #define MISSIONLINK_H
@@ -35,6 +57,7 @@
 #define ACK_RETRIES 5
 #define ROVER_ACTIVITY_TIMEOUT 5
 #define FRAG_SIZE 1024
+#define MISSION_QUEUE_MAX 3            // Missões em fila por rover (além da em curso)
 
 // ============ TIPOS DE PACOTES ============
 typedef enum {
@@ -42,18 +65,51 @@ typedef enum {
     PKT_MISSION_ASSIGN = 2,    // Servidor → Rover: Atribui missão com parâmetros
     PKT_PROGRESS = 3,          // Rover → Servidor: Reporta progresso
     PKT_COMPLETE = 4,          // Rover → Servidor: Missão concluída
-    PKT_ACK = 5                // Ambos: Confirmação de recepção
+    PKT_ACK = 5,               // Ambos: Confirmação de recepção
+    PKT_MISSION_REVOKE = 6,    // Servidor → Rover: Retira uma missão reservada
+    PKT_MISSION_DEFER = 7      // Servidor → Rover: Pedido recusado por agora
 } PacketType;
 
+// ============ FLAGS DO CABEÇALHO ============
+#define ML_FLAG_SYN 0x01           // Primeiro pacote de um stream (MissionLinkARQ.h)
+#define ML_FLAG_ACK 0x02           // ack_seq/ack_bitmap válidos (ACK ou piggyback)
+
+// ============ HANDSHAKE ============
+#define ML_HANDSHAKE 0xFF          // Tipo dos datagramas de handshake
+
+typedef enum {
+    ML_HS_OK = 0,              // conn_id e resume_token válidos
+    ML_HS_RETRY = 1,           // conn_id desconhecido ou token errado: novo handshake
+    ML_HS_BUSY = 2             // Conexão ainda ativa e token errado: tentar mais tarde
+} HandshakeStatus;
+
 // ============ ESTRUTURA DO PACOTE ============
 #pragma pack(push, 1)
 typedef struct {
-    // CABEÇALHO (12 bytes)
+    uint8_t type;               // ML_HANDSHAKE
+    char rover_id[32];
+    uint64_t resume_token;      // Token atual, little-endian (0: nenhum)
+} MLHandshake;
+
+typedef struct {
+    uint8_t type;               // ML_HANDSHAKE
+    uint8_t status;             // HandshakeStatus
+    uint32_t conn_id;           // OK: ID a usar; RETRY: ID rejeitado
+    uint64_t resume_token;      // OK: token de retoma
+} MLHandshakeReply;
+
+typedef struct {
+    // CABEÇALHO (32 bytes)
     uint8_t type;               // PacketType enum
     uint32_t seq;               // Número de sequência
     uint8_t battery;            // % Bateria (0-100)
     uint8_t progress;           // % Progresso (0-100)
     uint32_t nonce;             // Número aleatório para segurança
+    uint8_t flags;              // ML_FLAG_*
+    uint32_t ack_seq;           // ML_FLAG_ACK: tudo antes desta sequência recebido
+    uint32_t ack_bitmap;        // ML_FLAG_ACK: bit i = ack_seq+1+i também recebida
+    uint32_t conn_id;           // ID de conexão emitido no handshake
+    uint64_t resume_token;      // Rover → Servidor: token de retoma (verificado nos SYN)
 
     // IDENTIFICADORES (96 bytes)
     char rover_id[32];          // ID do rover (ex: "R-001")
@@ -69,6 +125,9 @@ typedef struct {
     uint32_t mission_duration;     // Duração máxima em segundos
     uint32_t update_interval;      // Intervalo entre atualizações em segundos
 
+    // FILA DE MISSÕES (1 byte)
+    uint8_t queue_depth;           // REQUEST: fila pedida; ASSIGN: fila concedida
+
 } Packet;
 #pragma pack(pop)
 
@@ -78,8 +137,8 @@ int create_udp_socket(void);
 void bind_udp_socket(int sockfd, int port, struct sockaddr_in *addr);
 int receive_udp(int sockfd, char *buffer, size_t buf_size, 
                 struct sockaddr_in *client_addr);
-ssize_t send_udp_with_ack(int sockfd, struct sockaddr_in *server_addr, 
-                          char *data, size_t size);
+ssize_t send_udp_with_ack(int sockfd, struct sockaddr_in *server_addr,
+                          const Packet *pkt);
 void send_ack_packet(int sockfd, struct sockaddr_in *addr, uint32_t seq);
 
 // ============ FUNÇÕES UTILITÁRIAS ============
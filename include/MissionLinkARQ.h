@@ -0,0 +1,153 @@
+// ============ MissionLinkARQ.h ============
+// Entrega fiável do MissionLink com janela deslizante (selective repeat)
+// O emissor mantém até ARQ_WINDOW pacotes em voo, cada um com o seu
+// temporizador de retransmissão. As confirmações são cumulativas: ack_seq
+// é a próxima sequência em falta e ack_bitmap marca as que chegaram depois
+// dela (ACK seletivo). Podem seguir num PKT_ACK ou em qualquer pacote com
+// ML_FLAG_ACK (piggyback). O recetor guarda os pacotes fora de ordem e
+// entrega-os por ordem, uma única vez.
+//
+// O temporizador de cada pacote segue o RTT medido (Jacobson/Karels,
+// RFC 6298): só pacotes confirmados sem retransmissão dão amostras (regra de
+// Karn) e cada retransmissão duplica o timeout, com jitter.
+//
+// O primeiro pacote de um stream leva ML_FLAG_SYN: o recetor (re)começa a
+// contar nessa sequência. Um SYN com outro nonce é um stream novo (rover
+// reiniciado, ou emissor que desistiu de um pacote).
+//
+// Na rede os pacotes seguem codificados (MissionLinkWire.h): o emissor
+// codifica cada pacote uma vez e as retransmissões reenviam esses bytes;
+// o recetor lê os campos na vista e só copia os que ficam guardados.
+
+#ifndef MISSIONLINK_ARQ_H
+#define MISSIONLINK_ARQ_H
+
+#include "MissionLink.h"
+#include "MissionLinkWire.h"
+#include <stdint.h>
+
+// ============ CONSTANTES ============
+#define ARQ_WINDOW 8                     // Pacotes em voo (potência de 2, <= 32)
+#define ARQ_RTO_INITIAL_MS (ACK_TIMEOUT * 1000) // Timeout antes da primeira amostra
+#define ARQ_RTO_MIN_MS 100               // Limites do timeout de retransmissão
+                                         // (mínimo acima do atraso de ACK)
+#define ARQ_RTO_MAX_MS 8000
+#define ARQ_MAX_RETRIES 8                // Retransmissões antes de reiniciar o stream
+                                         // (com backoff: >20 s mesmo com RTO mínimo)
+#define ARQ_SACK_BITS 32                 // Sequências seguintes no ack_bitmap
+#define ARQ_ACK_DELAY_MS 40              // Recetor: atraso máximo de um ACK
+#define ARQ_ACK_EVERY 2                  // Recetor: ACK imediato a cada N pacotes
+
+// ============ ESTRUTURA: ESTIMADOR DE RTT ============
+typedef struct {
+    double srtt_ms;                  // RTT suavizado
+    double rttvar_ms;                // Variação do RTT
+    double last_rtt_ms;              // Última amostra
+    uint32_t rto_ms;                 // Timeout atual (antes de backoff)
+    uint64_t samples;
+} ArqRtt;
+
+// ============ ESTRUTURA: EMISSOR ============
+typedef struct {
+    Packet pkt;
+    uint8_t wire[ML_WIRE_PACKET_SIZE];   // pkt codificado (enviado em cada tentativa)
+    uint64_t sent_at_us;             // Último envio (relógio monótono)
+    uint64_t deadline_ms;            // Retransmitir a partir de
+    int retries;
+    int in_use;                      // Enviado e ainda sem ACK
+} ArqSlot;
+
+typedef struct {
+    int sockfd;
+    struct sockaddr_in peer;
+
+    ArqSlot slots[ARQ_WINDOW];       // Indexado por seq % ARQ_WINDOW
+    uint32_t base;                   // Sequência mais antiga por confirmar
+    uint32_t next_seq;               // Sequência do próximo pacote
+    int syn_pending;                 // O próximo pacote abre um stream
+
+    ArqRtt rtt;
+    uint64_t sent, retransmitted, acked, resets;
+} ArqSender;
+
+// ============ ESTRUTURA: RECETOR ============
+typedef struct {
+    uint64_t delivered;              // Entregues por ordem
+    uint64_t duplicates;             // Retransmissões de pacotes já recebidos
+    uint64_t out_of_order;           // Guardados à espera de anteriores
+} ArqReceiverStats;
+
+typedef struct {
+    int synced;                      // Já recebeu o SYN do stream
+    uint32_t expected;               // Próxima sequência a entregar
+    uint32_t stream_nonce;           // Nonce do SYN que abriu o stream
+
+    Packet slots[ARQ_WINDOW];        // Fora de ordem, à espera dos anteriores
+    uint32_t received;               // Bit i: expected + i já recebida
+
+    ArqReceiverStats stats;
+} ArqReceiver;
+
+// ============ FUNÇÕES: RTT ============
+
+// Estado inicial (sem amostras: timeout ARQ_RTO_INITIAL_MS)
+void arq_rtt_init(ArqRtt *rtt);
+
+// Incorporar uma amostra de RTT
+void arq_rtt_sample(ArqRtt *rtt, double rtt_ms);
+
+// Timeout para a tentativa 'retries' (backoff exponencial com jitter)
+uint32_t arq_rtt_backoff(const ArqRtt *rtt, int retries);
+
+// ============ FUNÇÕES: EMISSOR ============
+
+// Inicializar o emissor (first_seq: sequência do primeiro pacote)
+void arq_sender_init(ArqSender *tx, int sockfd, const struct sockaddr_in *peer,
+                     uint32_t first_seq);
+
+// Há espaço na janela para mais um pacote?
+int arq_sender_window_open(const ArqSender *tx);
+
+// Pacotes enviados e ainda sem ACK
+uint32_t arq_sender_in_flight(const ArqSender *tx);
+
+// Enviar um pacote: atribui-lhe a sequência e guarda-o até ao ACK
+// Devolve 0, ou -1 se a janela está cheia
+int arq_send(ArqSender *tx, Packet *pkt);
+
+// Processar as confirmações de um pacote com ML_FLAG_ACK (PKT_ACK ou
+// piggyback); devolve quantos pacotes ficaram confirmados
+int arq_sender_on_ack(ArqSender *tx, const PacketView *ack);
+
+// Retransmitir os pacotes cujo temporizador expirou
+// Devolve quantos foram retransmitidos, ou -1 se o stream foi reiniciado
+int arq_sender_poll(ArqSender *tx, uint64_t now_ms);
+
+// Milissegundos até ao próximo temporizador (-1 se não há pacotes em voo)
+int arq_sender_next_timeout(const ArqSender *tx, uint64_t now_ms);
+
+// ============ FUNÇÕES: RECETOR ============
+
+// Aceitar um pacote de dados. Aponta em out[] os pacotes que ficam
+// entregáveis por ordem (no máximo ARQ_WINDOW; válidos até à próxima
+// chamada) e devolve quantos.
+// Se ack->type == PKT_ACK à saída, o ACK deve ser enviado ao emissor.
+int arq_receiver_accept(ArqReceiver *rx, const PacketView *pkt,
+                        Packet **out, int max_out, Packet *ack);
+
+// Duplicado (já entregue ou já guardado)? Se sim, preenche o ACK a repetir
+// e devolve 1, sem copiar o pacote: verificação barata antes de qualquer
+// outro processamento
+int arq_receiver_duplicate(ArqReceiver *rx, const PacketView *pkt, Packet *ack);
+
+// Construir o ACK cumulativo (com bitmap seletivo); seq: pacote que o motivou
+void arq_receiver_ack(const ArqReceiver *rx, uint32_t seq, Packet *ack);
+
+// Levar o estado de confirmação num pacote de dados (piggyback)
+void arq_receiver_piggyback(const ArqReceiver *rx, Packet *pkt);
+
+// Relógio monótono em milissegundos / microssegundos
+uint64_t arq_now_ms(void);
+uint64_t arq_now_us(void);
+
+#endif // MISSIONLINK_ARQ_H
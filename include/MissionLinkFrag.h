@@ -0,0 +1,184 @@
+// ============ MissionLinkFrag.h ============
+// Fragmentação e reconstrução de mensagens grandes do MissionLink
+// (resultados de missão: imagens, análises de solo). Cada mensagem tem um
+// msg_id por rover e é partida em fragmentos de FRAG_SIZE bytes com índice
+// próprio. O emissor envia-os seguidos, sem pausas; o recetor guarda-os
+// por qualquer ordem num buffer da mensagem (memória limitada), e quando
+// o fluxo pára pede só os que faltam (FRAG_NACK com bitmap). No fim
+// responde FRAG_DONE. Mensagens paradas expiram.
+//
+// Os fragmentos seguem pela porta MissionLink (PORT), ao lado dos Packet,
+// com os campos numéricos em little-endian (como em MissionLinkWire.h).
+
+#ifndef MISSIONLINK_FRAG_H
+#define MISSIONLINK_FRAG_H
+
+#include "MissionLink.h"
+#include "MissionLinkARQ.h"
+#include "TimerWheel.h"
+#include <stdint.h>
+
+// ============ TIPOS DE PACOTES ============
+typedef enum {
+    PKT_FRAGMENT = 20,        // Rover → Servidor: fragmento de uma mensagem
+    PKT_FRAG_NACK = 21,       // Servidor → Rover: fragmentos em falta
+    PKT_FRAG_DONE = 22        // Servidor → Rover: mensagem completa
+} FragPacketType;
+
+// Conteúdo da mensagem (extensão do ficheiro guardado)
+typedef enum {
+    FRAG_CONTENT_BINARY = 0,
+    FRAG_CONTENT_IMAGE = 1,   // PGM
+    FRAG_CONTENT_TEXT = 2     // CSV / texto
+} FragContentType;
+
+// ============ CONSTANTES ============
+#define FRAG_MAX_FRAGMENTS 1024          // Fragmentos por mensagem (1 MiB)
+#define FRAG_MAX_MESSAGE (FRAG_MAX_FRAGMENTS * FRAG_SIZE)
+#define FRAG_NACK_WINDOW 512             // Fragmentos descritos num NACK
+#define FRAG_MAX_MESSAGES 16             // Recetor: mensagens em reconstrução
+#define FRAG_MEMORY_LIMIT (4 * 1024 * 1024)   // Recetor: bytes em reconstrução
+#define FRAG_NACK_DELAY_MS 20            // Recetor: silêncio antes de pedir os que faltam
+#define FRAG_NACK_MAX_DELAY_MS 1000      // Recetor: teto do intervalo entre NACKs
+#define FRAG_MESSAGE_TIMEOUT_MS 15000    // Recetor: mensagem sem fragmentos novos
+#define FRAG_COMPLETED_MEMORY 32         // Recetor: mensagens concluídas lembradas
+#define FRAG_BURST 32                    // Emissor: fragmentos por chamada a poll
+#define FRAG_MAX_PROBES 8                // Emissor: sondas sem resposta antes de desistir
+
+// ============ ESTRUTURAS NA REDE ============
+#pragma pack(push, 1)
+typedef struct {
+    uint8_t type;               // PKT_FRAGMENT
+    uint8_t content_type;       // FragContentType
+    uint32_t conn_id;           // ID de conexão MissionLink do rover
+    char rover_id[32];
+    char mission_id[32];
+    uint32_t msg_id;            // Mensagem (única por rover)
+    uint32_t total_len;         // Bytes da mensagem completa
+    uint16_t frag_index;
+    uint16_t frag_count;
+    uint16_t frag_len;          // Bytes de dados neste fragmento
+} FragHeader;
+
+typedef struct {
+    FragHeader hdr;
+    uint8_t data[FRAG_SIZE];
+} FragPacket;
+
+typedef struct {
+    uint8_t type;               // PKT_FRAG_NACK / PKT_FRAG_DONE
+    char rover_id[32];
+    uint32_t msg_id;
+    uint16_t base;              // NACK: índice do bit 0
+    uint8_t missing[FRAG_NACK_WINDOW / 8];   // NACK: bit i = base + i em falta
+} FragControl;
+#pragma pack(pop)
+
+// Qualquer datagrama da porta MissionLink
+typedef union {
+    uint8_t type;
+    MLHandshake hello;
+    MLHandshakeReply hello_reply;
+    uint8_t packet[ML_WIRE_PACKET_SIZE];   // Packet codificado (ml_view_init)
+    FragPacket frag;
+    FragControl ctl;
+} MissionLinkDatagram;
+
+// ============ ESTRUTURA: EMISSOR ============
+typedef struct {
+    int sockfd;
+    struct sockaddr_in peer;
+    char rover_id[32];
+    uint32_t conn_id;                // ID de conexão (atualizar após cada handshake)
+    ArqRtt rtt;                      // Timeout das sondas (copiar do ArqSender)
+
+    int active;
+    uint32_t next_msg_id;
+    FragHeader hdr;                  // Cabeçalho da mensagem em curso
+    uint8_t *data;
+    uint16_t next_frag;              // Próximo a enviar pela primeira vez
+    uint8_t resend[FRAG_MAX_FRAGMENTS / 8];  // Pedidos pelo recetor
+    uint16_t resend_pending;
+    uint64_t deadline_ms;            // Sonda se nada chegar até lá
+    int probes;
+
+    uint64_t started_us;
+    uint64_t fragments_sent, fragments_resent, messages_sent, messages_failed;
+} FragSender;
+
+// ============ ESTRUTURA: RECETOR ============
+typedef void (*FragDeliverFn)(const FragHeader *hdr, const uint8_t *data);
+
+struct FragReassembler;
+
+typedef struct {
+    int in_use;
+    struct FragReassembler *owner;
+    struct sockaddr_in from;
+    FragHeader hdr;                  // Do primeiro fragmento (frag_index/len sem uso)
+    uint8_t *data;
+    uint8_t received[FRAG_MAX_FRAGMENTS / 8];
+    uint16_t received_count;
+    int nacks;                       // NACKs seguidos sem fragmentos novos
+    Timer nack_timer;
+    Timer expiry_timer;
+} FragMessage;
+
+typedef struct FragReassembler {
+    int sockfd;
+    TimerWheel *wheel;
+    FragDeliverFn deliver;
+
+    FragMessage slots[FRAG_MAX_MESSAGES];
+    size_t memory_used;
+
+    struct {
+        char rover_id[32];
+        uint32_t msg_id;
+    } completed[FRAG_COMPLETED_MEMORY];  // Para repetir o DONE a sondas tardias
+    int completed_next;
+
+    uint64_t messages_completed, messages_expired, messages_rejected;
+    uint64_t fragments_received, fragments_duplicate, nacks_sent;
+} FragReassembler;
+
+// ============ FUNÇÕES: EMISSOR ============
+
+// Inicializar o emissor do rover
+void frag_sender_init(FragSender *tx, int sockfd, const struct sockaddr_in *peer,
+                      const char *rover_id);
+
+// Começar a enviar uma mensagem (copiada). Devolve o msg_id, ou -1 se há
+// outra em curso ou é demasiado grande
+int64_t frag_send(FragSender *tx, const void *data, uint32_t len,
+                  uint8_t content_type, const char *mission_id);
+
+// Enviar até FRAG_BURST fragmentos (novos ou pedidos) e tratar as sondas
+// Devolve -1 se a mensagem foi abandonada, 0 caso contrário
+int frag_sender_poll(FragSender *tx, uint64_t now_ms);
+
+// Processar FRAG_NACK / FRAG_DONE; devolve 1 se a mensagem ficou entregue
+int frag_sender_on_control(FragSender *tx, const FragControl *ctl);
+
+// Milissegundos até ao próximo trabalho (0: há fragmentos por enviar,
+// -1: nenhuma mensagem em curso)
+int frag_sender_next_timeout(const FragSender *tx, uint64_t now_ms);
+
+// ============ FUNÇÕES: RECETOR ============
+
+// Inicializar o recetor; deliver recebe cada mensagem completa, uma vez
+void frag_reassembler_init(FragReassembler *rx, int sockfd, TimerWheel *wheel,
+                           FragDeliverFn deliver);
+
+// ID de conexão de um datagrama PKT_FRAGMENT (0 se é curto demais), para
+// o servidor o validar antes de o aceitar
+uint32_t frag_conn_id(const FragPacket *frag, size_t len);
+
+// Processar um datagrama PKT_FRAGMENT de len bytes
+void frag_reassembler_on_fragment(FragReassembler *rx, const FragPacket *frag, size_t len,
+                                  const struct sockaddr_in *from);
+
+// Libertar as mensagens em reconstrução
+void frag_reassembler_destroy(FragReassembler *rx);
+
+#endif // MISSIONLINK_FRAG_H
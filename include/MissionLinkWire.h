@@ -0,0 +1,173 @@
+// ============ MissionLinkWire.h ============
+// Formato na rede dos pacotes MissionLink
+// Os Packet deixam de seguir como structs em memória (ordem de bytes do
+// host): cada campo é escrito explicitamente em little-endian, atrás de um
+// cabeçalho com versão, comprimento e CRC32C:
+//
+//   0  type      u8    PacketType (primeiro byte, como nos restantes datagramas)
+//   1  version   u8    ML_WIRE_VERSION
+//   2  length    u16   Bytes do datagrama, cabeçalho incluído
+//   4  crc32c    u32   Bytes [0,4) e [8,length)
+//   8  corpo     (offsets ML_OFF_*)
+//
+// Versões futuras só acrescentam campos no fim: um recetor aceita qualquer
+// versão >= 1 com length >= ML_WIRE_MIN_SIZE e lê os campos que conhece;
+// os que o emissor não enviou valem 0.
+//
+//   v1  corpo até ML_OFF_UPDATE_INTERVAL (191 bytes)
+//   v2  + queue_depth (fila de missões)
+//
+// Receção sem cópias: ml_view_init() valida o datagrama e os handlers leem
+// os campos diretamente do buffer de receção (ml_view_*). Só o que precisa
+// de ficar guardado (pacotes fora de ordem na janela ARQ) é descodificado
+// para um Packet, com ml_view_decode().
+//
+// O CRC32C usa a instrução crc32 do SSE4.2 quando o CPU a tem (escolhida em
+// tempo de execução, como em TelemetryKernels.h) e uma tabela caso contrário.
+
+#ifndef MISSIONLINK_WIRE_H
+#define MISSIONLINK_WIRE_H
+
+#include "MissionLink.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// ============ CONSTANTES ============
+#define ML_WIRE_VERSION 2
+#define ML_WIRE_HEADER_SIZE 8
+
+// Offsets do corpo (versão 1)
+#define ML_OFF_SEQ 8
+#define ML_OFF_BATTERY 12
+#define ML_OFF_PROGRESS 13
+#define ML_OFF_NONCE 14
+#define ML_OFF_FLAGS 18
+#define ML_OFF_ACK_SEQ 19
+#define ML_OFF_ACK_BITMAP 23
+#define ML_OFF_CONN_ID 27
+#define ML_OFF_RESUME_TOKEN 31
+#define ML_OFF_ROVER_ID 39
+#define ML_OFF_MISSION_ID 71
+#define ML_OFF_TASK_TYPE 103
+#define ML_OFF_MISSION_X1 167
+#define ML_OFF_MISSION_Y1 171
+#define ML_OFF_MISSION_X2 175
+#define ML_OFF_MISSION_Y2 179
+#define ML_OFF_DURATION 183
+#define ML_OFF_UPDATE_INTERVAL 187
+#define ML_OFF_QUEUE_DEPTH 191           // v2
+#define ML_WIRE_MIN_SIZE 191             // Pacote completo da versão 1
+#define ML_WIRE_PACKET_SIZE 192          // Pacote completo da versão atual
+
+// Resultado da validação
+typedef enum {
+    ML_WIRE_OK = 0,
+    ML_WIRE_TRUNCATED,                   // Menos bytes do que o cabeçalho indica
+    ML_WIRE_BAD_VERSION,                 // Versão 0 ou corpo menor que o da v1
+    ML_WIRE_BAD_CRC
+} MLWireStatus;
+
+// ============ LITTLE-ENDIAN ============
+// Montagem byte a byte: o compilador reduz a um load/store nos hosts
+// little-endian e faz a troca nos restantes
+
+static inline uint16_t ml_get_le16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t ml_get_le32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint64_t ml_get_le64(const uint8_t *p) {
+    return (uint64_t)ml_get_le32(p) | ((uint64_t)ml_get_le32(p + 4) << 32);
+}
+
+static inline float ml_get_lef32(const uint8_t *p) {
+    uint32_t u = ml_get_le32(p);
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+static inline void ml_put_le16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void ml_put_le32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static inline void ml_put_le64(uint8_t *p, uint64_t v) {
+    ml_put_le32(p, (uint32_t)v);
+    ml_put_le32(p + 4, (uint32_t)(v >> 32));
+}
+
+static inline void ml_put_lef32(uint8_t *p, float f) {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    ml_put_le32(p, u);
+}
+
+// ============ ESTRUTURA: VISTA DE UM PACOTE RECEBIDO ============
+// Aponta para o buffer de receção: válida enquanto o buffer não for reutilizado
+typedef struct {
+    const uint8_t *buf;
+    uint16_t len;
+    uint8_t version;
+} PacketView;
+
+// ============ FUNÇÕES: CRC32C ============
+
+// CRC32C (Castagnoli) de len bytes, a continuar de crc (0 no início)
+uint32_t crc32c(uint32_t crc, const void *data, size_t len);
+
+// Implementação em uso ("sse4.2" ou "table")
+const char *crc32c_impl(void);
+
+// ============ FUNÇÕES: CODIFICAÇÃO ============
+
+// Escrever o pacote em buf (ML_WIRE_PACKET_SIZE bytes); devolve o tamanho
+size_t ml_wire_encode(const Packet *pkt, uint8_t *buf);
+
+// Codificar e enviar para addr (resultado do sendto)
+ssize_t ml_wire_send(int sockfd, const Packet *pkt, const struct sockaddr_in *addr);
+
+// ============ FUNÇÕES: VISTA ============
+
+// Validar len bytes recebidos (versão, comprimento, CRC) e apontar a vista
+// para eles. Devolve ML_WIRE_OK ou o motivo da rejeição
+MLWireStatus ml_view_init(PacketView *view, const void *buf, size_t len);
+
+// Copiar os campos para um Packet (strings sempre terminadas)
+void ml_view_decode(const PacketView *view, Packet *pkt);
+
+// Nome do motivo de rejeição (logs)
+const char *ml_wire_status_name(MLWireStatus status);
+
+// Campos lidos no próprio buffer
+static inline uint8_t ml_view_type(const PacketView *v) { return v->buf[0]; }
+static inline uint32_t ml_view_seq(const PacketView *v) { return ml_get_le32(v->buf + ML_OFF_SEQ); }
+static inline uint8_t ml_view_battery(const PacketView *v) { return v->buf[ML_OFF_BATTERY]; }
+static inline uint8_t ml_view_progress(const PacketView *v) { return v->buf[ML_OFF_PROGRESS]; }
+static inline uint32_t ml_view_nonce(const PacketView *v) { return ml_get_le32(v->buf + ML_OFF_NONCE); }
+static inline uint8_t ml_view_flags(const PacketView *v) { return v->buf[ML_OFF_FLAGS]; }
+static inline uint32_t ml_view_ack_seq(const PacketView *v) { return ml_get_le32(v->buf + ML_OFF_ACK_SEQ); }
+static inline uint32_t ml_view_ack_bitmap(const PacketView *v) { return ml_get_le32(v->buf + ML_OFF_ACK_BITMAP); }
+static inline uint32_t ml_view_conn_id(const PacketView *v) { return ml_get_le32(v->buf + ML_OFF_CONN_ID); }
+static inline uint64_t ml_view_resume_token(const PacketView *v) { return ml_get_le64(v->buf + ML_OFF_RESUME_TOKEN); }
+static inline uint8_t ml_view_queue_depth(const PacketView *v) {
+    return v->len > ML_OFF_QUEUE_DEPTH ? v->buf[ML_OFF_QUEUE_DEPTH] : 0;
+}
+
+// Campos de texto: 32 bytes, não necessariamente terminados (usar "%.32s")
+static inline const char *ml_view_rover_id(const PacketView *v) { return (const char *)v->buf + ML_OFF_ROVER_ID; }
+static inline const char *ml_view_mission_id(const PacketView *v) { return (const char *)v->buf + ML_OFF_MISSION_ID; }
+
+#endif // MISSIONLINK_WIRE_H
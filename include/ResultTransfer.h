@@ -0,0 +1,193 @@
+// ============ ResultTransfer.h ============
+// Canal de transferência em massa de resultados de missão (TCP)
+// O rover anuncia um artefacto (ResultOffer: nome, tamanho, tipo) e a
+// Nave-Mãe responde com o offset a partir do qual o quer receber: o que já
+// está no ficheiro parcial de uma tentativa anterior. O rover envia o resto
+// diretamente do ficheiro com sendfile(); o servidor escreve-o no disco com
+// splice() (socket → pipe → ficheiro), sem copiar os dados para o processo.
+// Uma conexão perdida deixa o ficheiro .part: a próxima oferta retoma.
+// No fim o .part é renomeado e o servidor confirma com RESULT_STATUS_COMPLETE.
+// A oferta leva o ID de conexão e o token de retoma MissionLink do rover:
+// só são aceites ofertas de um rover com essa conexão.
+//
+// Os resultados pequenos continuam a poder seguir em fragmentos MissionLink
+// (MissionLinkFrag.h); ambos acabam em RESULTS_DIR e na API (/api/results).
+
+#ifndef RESULTTRANSFER_H
+#define RESULTTRANSFER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/select.h>
+
+// ============ CONSTANTES ============
+#define RESULT_PORT 5008
+#define RESULTS_DIR "mission_results"
+#define RESULT_OFFER_MAGIC 0xFEED7E50u
+#define RESULT_REPLY_MAGIC 0xFEED7E51u
+#define RESULT_MAX_SIZE (256u * 1024 * 1024)  // Maior artefacto aceite
+#define RESULT_MAX_SESSIONS 16           // Servidor: transferências em simultâneo
+#define RESULT_SPLICE_CHUNK 65536        // Servidor: bytes por splice()
+#define RESULT_IDLE_TIMEOUT 30           // Servidor: segundos sem dados até fechar
+#define RESULT_CONNECT_TIMEOUT 5         // Rover: segundos até desistir do connect()
+#define RESULT_RETRY_MIN 1               // Rover: espera inicial entre tentativas (s)
+#define RESULT_RETRY_MAX 30              // Rover: teto da espera (s)
+#define RESULT_MAX_ATTEMPTS 8            // Rover: conexões falhadas antes de desistir
+#define RESULT_LIST_MAX 128              // API: artefactos por resposta
+
+// Estado devolvido na ResultReply
+typedef enum {
+    RESULT_STATUS_RESUME = 0,        // Enviar a partir de offset
+    RESULT_STATUS_COMPLETE = 1,      // Artefacto completo no servidor
+    RESULT_STATUS_REJECTED = 2       // Oferta inválida (nome, tamanho, disco, credenciais)
+} ResultStatus;
+
+// ============ ESTRUTURAS NA REDE ============
+#pragma pack(push, 1)
+typedef struct {
+    uint32_t magic;                  // RESULT_OFFER_MAGIC
+    char rover_id[32];
+    uint32_t conn_id;                // Conexão MissionLink do rover
+    uint64_t resume_token;           // Token de retoma dessa conexão
+    char mission_id[32];
+    char name[64];                   // Nome do ficheiro (sem diretórios)
+    uint64_t total_len;
+    uint8_t content_type;            // FragContentType
+} ResultOffer;
+
+typedef struct {
+    uint32_t magic;                  // RESULT_REPLY_MAGIC
+    uint8_t status;                  // ResultStatus
+    uint64_t offset;                 // RESUME: bytes que o servidor já tem
+} ResultReply;
+#pragma pack(pop)
+
+// ============ ESTRUTURA: SERVIDOR ============
+typedef enum {
+    RS_FREE = 0,
+    RS_OFFER,                        // A ler a ResultOffer
+    RS_DATA                          // A receber o artefacto
+} ResultSessionState;
+
+typedef struct {
+    ResultSessionState state;
+    int sockfd;
+    int file_fd;                     // Ficheiro .part
+    int pipe_fd[2];                  // Intermediário do splice()
+    size_t pipe_bytes;               // No pipe, ainda por escrever no disco
+    ResultOffer offer;
+    size_t offer_got;
+    uint64_t offset;                 // Bytes já no disco
+    uint64_t resumed_from;
+    char path[192];                  // Destino final
+    time_t last_activity;
+} ResultSession;
+
+// Servidor: 1 se conn_id e resume_token da oferta são os de offer->rover_id
+typedef int (*ResultAuthorizeFn)(const ResultOffer *offer);
+
+typedef struct {
+    int listen_fd;
+    ResultSession sessions[RESULT_MAX_SESSIONS];
+    int splice_ok;                   // 0: splice() indisponível, usar read/write
+    ResultAuthorizeFn authorize;
+    uint64_t completed, resumed, bytes_received;
+} ResultServer;
+
+// ============ ESTRUTURA: ROVER ============
+typedef enum {
+    RU_IDLE = 0,
+    RU_WAITING,                      // À espera de voltar a tentar
+    RU_CONNECTING,                   // connect() não bloqueante em curso
+    RU_OFFERED,                      // Oferta enviada, à espera do offset
+    RU_SENDING,                      // sendfile() em curso
+    RU_FINISHING                     // Tudo enviado, à espera da confirmação
+} ResultUploadState;
+
+typedef struct {
+    ResultUploadState state;
+    const char *host;
+    int port;
+    uint32_t conn_id;                // Credenciais MissionLink atuais
+    uint64_t resume_token;
+    int sockfd;
+    int file_fd;
+    char path[192];
+    ResultOffer offer;
+    ResultReply reply;
+    size_t reply_got;
+    off_t offset;
+    int attempts;
+    time_t retry_at;
+    time_t connect_at;               // Início do connect() em curso
+    uint64_t started_ms;
+} ResultUploader;
+
+// ============ ESTRUTURA: ARTEFACTO (API) ============
+typedef struct {
+    char name[160];
+    uint64_t size;
+    time_t modified;
+    int partial;                     // Transferência por terminar (.part)
+} ResultInfo;
+
+// ============ FUNÇÕES: SERVIDOR ============
+
+// Criar o servidor (RESULTS_DIR tem de existir); authorize valida as
+// credenciais de cada oferta. Devolve o socket ou -1
+int result_server_init(ResultServer *srv, int port, ResultAuthorizeFn authorize);
+
+// Acrescentar os sockets do servidor ao conjunto do select()
+void result_server_fill_fdset(const ResultServer *srv, fd_set *readfds, int *max_fd);
+
+// Aceitar conexões e receber dados dos sockets prontos
+void result_server_handle(ResultServer *srv, const fd_set *readfds);
+
+// Fechar sessões sem atividade (os .part ficam para retomar)
+void result_server_reap(ResultServer *srv, time_t now);
+
+// Fechar tudo
+void result_server_close(ResultServer *srv);
+
+// ============ FUNÇÕES: ROVER ============
+
+// Inicializar (sem transferência em curso)
+void result_uploader_init(ResultUploader *up, const char *host, int port);
+
+// Credenciais MissionLink a levar nas ofertas (depois de cada handshake)
+void result_uploader_set_conn(ResultUploader *up, uint32_t conn_id, uint64_t resume_token);
+
+// Começar a enviar o ficheiro path; devolve 0, ou -1 se há outro em curso
+// ou o ficheiro não pode ser aberto
+int result_upload_start(ResultUploader *up, const char *path, const char *rover_id,
+                        const char *mission_id, const char *name, uint8_t content_type);
+
+// Avançar a transferência (não bloqueia). Devolve 1 quando o servidor
+// confirmou, -1 se desistiu, 0 caso contrário
+int result_upload_poll(ResultUploader *up, time_t now);
+
+// Socket a vigiar no select() (-1 se nenhum); *want_write: à espera de
+// poder escrever
+int result_upload_fd(const ResultUploader *up, int *want_write);
+
+// ============ FUNÇÕES: ARTEFACTOS ============
+
+// Nome seguro para usar num caminho de RESULTS_DIR: só [A-Za-z0-9._-], sem
+// começar por '.', terminado antes de max bytes
+int result_valid_name(const char *name, size_t max);
+
+// Extensão do ficheiro para um FragContentType
+const char *result_extension(uint8_t content_type);
+
+// Tipo MIME pela extensão do nome
+const char *result_mime_type(const char *name);
+
+// Listar os artefactos de RESULTS_DIR (ordenados por nome); devolve quantos
+size_t result_list(ResultInfo *out, size_t max_out, int *truncated);
+
+// Abrir um artefacto completo para leitura (nome validado); -1 se não existe
+int result_open(const char *name, uint64_t *size);
+
+#endif // RESULTTRANSFER_H
@@ -0,0 +1,86 @@
+// ============ RoverHealth.h ============
+// Análise de saúde por rover, calculada incrementalmente à chegada da telemetria
+// Médias móveis exponenciais (EWMA) e declive de uma regressão linear sobre
+// uma janela deslizante (somas atualizadas em O(1) por amostra) para bateria,
+// temperatura e sinal. Cruzar um limiar gera um evento no EventLog.
+// As amostras (5 Hz) são agregadas em pontos de 1 segundo antes de entrar na
+// janela, para que esta cubra HEALTH_WINDOW_SECONDS a qualquer taxa. Um alerta
+// de declive só dispara com janela longa, declive estatisticamente
+// significativo e HEALTH_DEBOUNCE_POINTS pontos seguidos a confirmá-lo.
+
+#ifndef ROVERHEALTH_H
+#define ROVERHEALTH_H
+
+#include "TelemetryStream.h"
+#include <stdint.h>
+
+// ============ CONSTANTES ============
+#define HEALTH_WINDOW_SAMPLES 128        // Pontos (1/s) na regressão (potência de 2, >= segundos)
+#define HEALTH_WINDOW_SECONDS 120        // Pontos mais antigos saem da janela
+#define HEALTH_MIN_SPAN 60               // Segundos de janela antes de avaliar declives
+#define HEALTH_MIN_POINTS 30             // Pontos na janela antes de avaliar declives
+#define HEALTH_MIN_T_SCORE 3.0           // |declive| / erro padrão para disparar
+#define HEALTH_DEBOUNCE_POINTS 5         // Pontos seguidos antes de mudar um alerta
+#define HEALTH_EWMA_ALPHA 0.1            // Peso da amostra nova na EWMA
+
+// Limiares de alerta (declives por minuto); limpam abaixo de metade
+#define HEALTH_BATTERY_DRAIN_ALERT 2.0   // Perda de bateria (%/min)
+#define HEALTH_BATTERY_LOW_ALERT 20.0    // Bateria (EWMA, %)
+#define HEALTH_TEMPERATURE_RISE_ALERT 1.0 // Aquecimento (°C/min)
+#define HEALTH_SIGNAL_DROP_ALERT 5.0     // Perda de sinal (%/min)
+
+// Alertas ativos (máscara)
+#define HEALTH_ALERT_BATTERY_DRAIN    0x01
+#define HEALTH_ALERT_BATTERY_LOW      0x02
+#define HEALTH_ALERT_TEMPERATURE_RISE 0x04
+#define HEALTH_ALERT_SIGNAL_DROP      0x08
+
+// ============ ESTRUTURA: REGRESSÃO DESLIZANTE ============
+// Tempos relativos a 'base' para manter as somas bem condicionadas
+typedef struct {
+    double sum_y, sum_ty, sum_yy;
+} HealthSeries;
+
+// ============ ESTRUTURA: ESTADO DE SAÚDE DE UM ROVER ============
+typedef struct {
+    uint64_t samples;
+    float battery_ewma, temperature_ewma, signal_ewma;
+
+    // Ponto em construção: médias das amostras do mesmo segundo
+    uint32_t pending_second;
+    uint32_t pending_count;
+    float pending_ms, pending_battery, pending_temperature, pending_signal;
+
+    // Janela: tempos partilhados, valores por métrica (um ponto por segundo)
+    uint32_t base;                   // Timestamp de referência
+    float t[HEALTH_WINDOW_SAMPLES];
+    float battery[HEALTH_WINDOW_SAMPLES];
+    float temperature[HEALTH_WINDOW_SAMPLES];
+    float signal[HEALTH_WINDOW_SAMPLES];
+    uint32_t head, count;
+    double sum_t, sum_tt;
+    HealthSeries s_battery, s_temperature, s_signal;
+
+    uint32_t alerts;                 // HEALTH_ALERT_* ativos
+    uint8_t streak[4];               // Pontos seguidos a pedir a mudança de cada alerta
+} RoverHealth;
+
+// ============ ESTRUTURA: RESUMO (API) ============
+typedef struct {
+    uint64_t samples;
+    float battery_ewma, temperature_ewma, signal_ewma;
+    float battery_slope, temperature_slope, signal_slope;  // Por minuto
+    uint32_t window_samples;         // Pontos (1 por segundo)
+    uint32_t window_seconds;
+    uint32_t alerts;
+} RoverHealthSummary;
+
+// ============ FUNÇÕES ============
+
+// Incorporar uma amostra (emite eventos quando um alerta muda de estado)
+void rover_health_update(RoverHealth *h, const char *rover_id, const TelemetryMessage *msg);
+
+// Resumo atual (O(1))
+void rover_health_summary(const RoverHealth *h, RoverHealthSummary *out);
+
+#endif // ROVERHEALTH_H
@@ -0,0 +1,114 @@
+// ============ RoverRegistry.h ============
+// Registo único de rovers na Nave-Mãe
+// Cada rover tem uma só entrada, indexada por rover_id, que junta o estado
+// MissionLink, o heartbeat e uma referência direta à sessão de telemetria.
+// Quem já tem a entidade não volta a procurar o rover pelo ID.
+
+#ifndef ROVERREGISTRY_H
+#define ROVERREGISTRY_H
+
+#include "Server_management.h"
+#include "Heartbeat.h"
+#include "TelemetryStream.h"
+#include "RoverHealth.h"
+#include "MissionLinkARQ.h"
+#include "TimerWheel.h"
+#include <stddef.h>
+#include <time.h>
+
+// ============ CONSTANTES ============
+#define ROVER_REGISTRY_SLAB 16           // Entidades alocadas de cada vez
+#define ROVER_REGISTRY_BUCKETS 256       // Tabela de IDs (potência de 2)
+#define ROVER_REGISTRY_MAX 1024          // Rovers conhecidos
+#define ROVER_CONN_SLOT_BITS 11          // Bits baixos do ID de conexão: posição no registo
+#define ROVER_REGISTRY_PENDING_MAX 64    // Entradas só com handshake (sem tráfego MissionLink)
+
+// ============ ESTRUTURA: ENTIDADE ROVER ============
+// Os endereços são estáveis (slabs): podem ser guardados por outros módulos.
+typedef struct RoverEntity {
+    char rover_id[32];
+
+    uint32_t conn_id;                // ID de conexão MissionLink (0: sem handshake)
+    uint64_t resume_token;           // Exigido nos SYN (retoma sem handshake)
+    uint64_t handshake_order;        // Ordem do último handshake (reutilização)
+
+    int has_link;                    // Já comunicou por MissionLink
+    RoverSession link;               // Missão, sequência, endereço UDP
+    ArqReceiver link_rx;             // Janela de receção dos pacotes do rover
+    Packet last_assign;              // Última ASSIGN (ou DEFER), repetida se o REQUEST chegar duplicado
+    uint32_t last_assign_request;    // Sequência do REQUEST que a originou
+    int has_last_assign;
+    uint8_t queue_depth;             // Fila de missões concedida (MISSION_QUEUE_MAX)
+    int ack_pending;                 // Pacotes entregues ainda sem ACK (atrasado)
+    uint32_t ack_trigger;            // Sequência do último desses pacotes
+    Timer ack_timer;                 // Envio do ACK atrasado
+
+    int has_link_tx;                 // Emissor para o rover já inicializado
+    ArqSender link_tx;               // Fila de saída da Nave-Mãe (ASSIGN) até ao ACK
+    Timer link_tx_timer;             // Próxima retransmissão de link_tx
+    HeartbeatState heartbeat;        // PING/PONG
+    TelemetrySession *telemetry;     // Sessão de telemetria ativa, ou NULL
+
+    uint8_t battery;                 // Bateria mais recente (MissionLink ou telemetria)
+    time_t battery_updated;
+    RoverHealth health;              // Tendências calculadas à chegada da telemetria
+
+    int slot;                        // Posição no registo (base 1)
+    int id_next;                     // Tabela de IDs
+} RoverEntity;
+
+// ============ ESTRUTURA: VISTA PARA SNAPSHOTS ============
+// Cópia de uma entidade sem ponteiros vivos (a telemetria segue por valor)
+typedef struct {
+    char rover_id[32];
+    int has_link;
+    RoverSession link;
+    ArqReceiverStats link_stats;
+    ArqRtt link_rtt;                 // Emissor da Nave-Mãe (ASSIGN, REVOKE)
+    uint64_t link_sent, link_retransmitted, link_acked, link_resets;
+    HeartbeatState heartbeat;
+    int has_telemetry;
+    TelemetrySession telemetry;
+    uint8_t battery;
+    RoverHealthSummary health;
+} RoverView;
+
+// ============ FUNÇÕES ============
+
+// Entidade de um rover, ou NULL
+RoverEntity* rover_registry_find(const char *rover_id);
+
+// Entidade de um rover, criada se ainda não existir (NULL se o registo está
+// cheio). As entradas que só fizeram o handshake (sem has_link) são no máximo
+// ROVER_REGISTRY_PENDING_MAX: acima disso a mais antiga é reutilizada
+RoverEntity* rover_registry_get(const char *rover_id);
+
+// Entidade dona de um ID de conexão, ou NULL (O(1): o ID inclui a posição)
+RoverEntity* rover_registry_by_conn(uint32_t conn_id);
+
+// Emitir um ID de conexão e um token de retoma novos para o rover; os
+// anteriores deixam de ser aceites (um handshake nunca revela o par em uso)
+void rover_registry_issue_conn(RoverEntity *rover);
+
+// Iteração: entidades 0 .. rover_registry_count() - 1
+size_t rover_registry_count(void);
+RoverEntity* rover_registry_at(size_t i);
+
+// Atualizar a bateria (o relato mais recente ganha, venha de onde vier)
+void rover_registry_set_battery(RoverEntity *rover, uint8_t battery);
+
+// Ligar/desligar a sessão de telemetria (já com rover_id) à entidade;
+// a ligação só acontece se o rover já fez o handshake MissionLink
+void rover_registry_attach_telemetry(TelemetrySession *session);
+void rover_registry_detach_telemetry(TelemetrySession *session);
+
+// Copiar as entidades para vistas ordenadas por rover_id (devolve quantas)
+size_t rover_registry_views(RoverView *out, size_t max_out);
+
+// Procurar numa lista de vistas ordenada (pesquisa binária)
+const RoverView* rover_view_find(const RoverView *views, size_t count, const char *rover_id);
+
+// Libertar todas as entidades
+void rover_registry_clear(void);
+
+#endif // ROVERREGISTRY_H
@@ -13,18 +13,24 @@ typedef struct {
     uint32_t last_seq;              // Última sequência recebida
     char mission_id[32];            // Missão atual
     char task_type[64];             // Tipo de tarefa atual
-    uint8_t battery;                // % Bateria
     uint8_t progress;               // % Progresso
     time_t last_update;             // Timestamp do último pacote
-    time_t last_ping_sent;          // Timestamp do último PING enviado
     struct sockaddr_in addr;        // Endereço do rover
     int active;                     // Flag de atividade (1=ativo, 0=inativo)
-    
-    // ===== NOVO: Rastreamento de PING/PONG =====
-    int waiting_for_pong;           // 1 se aguardando PONG, 0 caso contrário
-    int consecutive_missed_pongs;   // Contador de PONGs não recebidos
+    // (bateria e PING/PONG vivem na entidade do rover: RoverRegistry.h)
 } RoverSession;
 
+// ============ ESTADO DE UMA MISSÃO ============
+// Criada já reservada para um rover (na fila dele); passa a ativa com o
+// primeiro PROGRESS. Reservas podem ser retiradas (rover reiniciado ou
+// inativo): os PROGRESS/COMPLETE que ainda cheguem são ignorados.
+typedef enum {
+    MISSION_RESERVED = 0,           // Atribuída, ainda na fila do rover
+    MISSION_ACTIVE,                 // Em execução
+    MISSION_COMPLETED,
+    MISSION_REVOKED                 // Reserva retirada pela Nave-Mãe
+} MissionStatus;
+
 // ============ ESTRUTURA: MISSÃO NA NAVE-MÃE ============
 typedef struct {
     char mission_id[32];            // Identificador único
@@ -40,7 +46,7 @@ typedef struct {
     float x1, y1, x2, y2;           // Coordenadas da área
     uint32_t duration;              // Duração máxima em segundos
     uint32_t update_interval;       // Intervalo entre updates em segundos
-    int completed;                  // Flag de conclusão (1=concluída)
+    MissionStatus status;
 } MissionRecord;
 
 // ============ FUNÇÕES DE GESTÃO ============
@@ -51,17 +57,29 @@ void init_server_tables(void);
 // Criar nova missão para um rover
 MissionRecord* create_mission_for_rover(const char *rover_id);
 
-// Atualizar informações de uma missão
-void add_or_update_mission(const char *mission_id, uint8_t progress, uint8_t battery);
+// Atualizar informações de uma missão (reservada passa a ativa)
+// Devolve a missão, ou NULL se não existe ou foi retirada
+MissionRecord* add_or_update_mission(const char *mission_id, uint8_t progress, uint8_t battery);
+
+// Marcar missão como concluída; devolve 0, ou -1 se não existe ou foi retirada
+int mark_mission_complete(const char *mission_id);
+
+// Missões reservadas ou ativas de um rover
+int count_open_missions(const char *rover_id);
+
+// Retirar as missões reservadas de um rover (e as ativas, com include_active)
+// Retira todas; guarda até max_out em out[] e devolve quantas guardou
+int revoke_rover_missions(const char *rover_id, int include_active,
+                          MissionRecord **out, int max_out);
 
-// Marcar missão como concluída
-void mark_mission_complete(const char *mission_id);
+// Retirar uma missão se ainda está reservada; devolve-a, ou NULL
+MissionRecord* revoke_reserved_mission(const char *mission_id);
 
-// Obter sessão de rover (sem modificar)
-RoverSession* get_rover_session(const char *rover_id);
+// Obter rover já registado por MissionLink (sem modificar)
+struct RoverEntity* get_rover_session(const char *rover_id);
 
-// Registar ou atualizar sessão de rover
-RoverSession* register_or_update_rover(const char *rover_id, struct sockaddr_in *addr);
+// Registar ou atualizar o estado MissionLink de um rover
+struct RoverEntity* register_or_update_rover(const char *rover_id, struct sockaddr_in *addr);
 
 // Imprimir tabela de missões
 void print_mission_status(void);
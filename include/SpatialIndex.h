@@ -0,0 +1,52 @@
+// ============ SpatialIndex.h ============
+// Índice espacial das posições dos rovers (grelha uniforme com hashing)
+// Cada rover ocupa uma célula de SPATIAL_CELL_SIZE x SPATIAL_CELL_SIZE; as
+// células são guardadas numa tabela de dispersão, pelo que o mapa não tem
+// limites. Atualizado incrementalmente a cada amostra de telemetria.
+
+#ifndef SPATIALINDEX_H
+#define SPATIALINDEX_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+
+// ============ CONSTANTES ============
+#define SPATIAL_CELL_SIZE 10.0f          // Lado de cada célula (unidades do mapa)
+#define SPATIAL_MAX_ENTRIES 1024         // Rovers indexados (= ROVER_REGISTRY_MAX)
+#define SPATIAL_CELL_BUCKETS 4096        // Entradas da tabela de células (potência de 2)
+#define SPATIAL_ID_BUCKETS 1024          // Entradas da tabela de IDs (potência de 2)
+#define SPATIAL_MAX_RINGS 32             // Anéis visitados antes de recorrer a varrimento
+#define SPATIAL_MAX_K 32                 // Vizinhos máximos por consulta
+#define SPATIAL_MAX_RESULTS 256          // Resultados máximos de uma bbox
+
+// ============ ESTRUTURA: RESULTADO ============
+typedef struct {
+    char rover_id[32];
+    float x;
+    float y;
+    float distance;                  // Apenas nas consultas de vizinhos
+    time_t last_update;
+} SpatialResult;
+
+// ============ FUNÇÕES ============
+
+// Inserir ou mover um rover (posições não finitas são ignoradas)
+void spatial_index_update(const char *rover_id, float x, float y);
+
+// Remover um rover do índice
+void spatial_index_remove(const char *rover_id);
+
+// Rovers dentro do retângulo [x1, x2] x [y1, y2]. Devolve o número de
+// resultados; *truncated=1 se existiam mais do que max_out. Coordenadas
+// não finitas não dão resultados.
+size_t spatial_index_query_bbox(float x1, float y1, float x2, float y2,
+                                SpatialResult *out, size_t max_out, int *truncated);
+
+// Os k rovers mais próximos de (x, y), por distância crescente
+size_t spatial_index_nearest(float x, float y, size_t k, SpatialResult *out);
+
+// Número de rovers indexados
+size_t spatial_index_count(void);
+
+#endif // SPATIALINDEX_H
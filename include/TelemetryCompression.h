@@ -0,0 +1,48 @@
+// ============ TelemetryCompression.h ============
+// Compressão de blocos de telemetria (estilo Gorilla)
+// - Timestamps: delta-of-delta em milissegundos, com códigos de prefixo
+//   de tamanho variável (exige timestamps não decrescentes)
+// - Floats (posição, temperatura): XOR com o valor anterior
+// - Bytes (bateria, sinal, estado): 1 bit se igual ao anterior
+// Cada coluna é codificada num troço contíguo do stream, para que o
+// descodificador percorra uma coluna de cada vez.
+
+#ifndef TELEMETRYCOMPRESSION_H
+#define TELEMETRYCOMPRESSION_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Bytes extra no fim de cada stream: o leitor lê palavras de 64 bits
+#define TC_STREAM_PADDING 8
+
+// Pior caso por amostra: 52 bits (timestamp) + 3 x 44 bits (floats) + 3 x 9 bits,
+// mais o valor inicial do timestamp (42 bits) e dos floats/bytes
+#define TC_MAX_ENCODED_SIZE(n) (((n) * 211 + 7) / 8 + 18 + TC_STREAM_PADDING)
+
+// ============ ESTRUTURA: VISTA SOA DE UM BLOCO ============
+typedef struct {
+    uint32_t *timestamp;
+    uint16_t *timestamp_ms;          // 0-999
+    float *position_x;
+    float *position_y;
+    float *temperature;
+    uint8_t *battery;
+    uint8_t *signal_strength;
+    uint8_t *state;
+} TelemetryColumns;
+
+// ============ FUNÇÕES ============
+
+// Tamanho máximo (pior caso, com padding) do stream para n amostras
+size_t tc_max_encoded_size(size_t n);
+
+// Comprimir n amostras. 'out' deve ter tc_max_encoded_size(n) bytes.
+// Devolve o número de bytes úteis (sem padding).
+size_t tc_encode_block(const TelemetryColumns *cols, size_t n, uint8_t *out);
+
+// Descomprimir n amostras. 'in' deve incluir TC_STREAM_PADDING bytes
+// após os in_len bytes úteis. Devolve 0 em sucesso, -1 se o stream for inválido.
+int tc_decode_block(const uint8_t *in, size_t in_len, size_t n, TelemetryColumns *cols);
+
+#endif // TELEMETRYCOMPRESSION_H
@@ -0,0 +1,102 @@
+// ============ TelemetryHistory.h ============
+// Histórico de telemetria em memória (série temporal por rover)
+// As amostras recentes ficam num bloco aberto em layout structure-of-arrays
+// (timestamps, posição, bateria, temperatura, sinal, estado). Quando o bloco
+// enche é comprimido (Gorilla) e passa para um buffer circular de blocos
+// fechados, imutáveis.
+
+#ifndef TELEMETRYHISTORY_H
+#define TELEMETRYHISTORY_H
+
+#include "TelemetryStream.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+// ============ CONSTANTES ============
+#define TELEMETRY_HISTORY_DEFAULT_CAPACITY 3600  // 12 minutos a 5 Hz (o disco guarda o resto)
+#define MAX_HISTORY_ROVERS 1024                  // Rovers com histórico (= ROVER_REGISTRY_MAX)
+#define HISTORY_QUERY_MAX_POINTS 400             // Pontos máximos por resposta (cabe em API_BUFFER_SIZE)
+#define HISTORY_BLOCK_SAMPLES 128                // Amostras por bloco comprimido
+
+// ============ ESTRUTURA: AMOSTRA (RESULTADO DE CONSULTA) ============
+typedef struct {
+    uint32_t timestamp;
+    uint16_t timestamp_ms;           // Milissegundos (0-999)
+    float position_x;
+    float position_y;
+    uint8_t battery;
+    uint8_t state;
+    float temperature;
+    uint8_t signal_strength;
+} TelemetrySample;
+
+// ============ ESTRUTURA: BLOCO FECHADO (COMPRIMIDO) ============
+typedef struct {
+    uint32_t first_ts;               // Intervalo temporal do bloco
+    uint32_t last_ts;
+    uint16_t last_ms;                // Milissegundos da última amostra
+    uint16_t count;                  // Amostras no bloco
+    uint32_t nbytes;                 // Bytes úteis do stream
+    uint8_t *data;                   // Stream Gorilla (+ padding)
+} HistoryBlock;
+
+// ============ ESTRUTURA: HISTÓRICO DE UM ROVER ============
+typedef struct {
+    char rover_id[32];               // ID do rover
+    uint64_t written;                // Total de amostras escritas (monotónico)
+
+    // Blocos fechados (buffer circular, do mais antigo para o mais recente)
+    HistoryBlock *blocks;
+    size_t max_blocks;
+    size_t block_head;               // Índice do bloco mais antigo
+    size_t num_blocks;
+    size_t compressed_bytes;         // Bytes ocupados pelos blocos fechados
+
+    // Bloco aberto (SoA, não comprimido)
+    uint32_t open_timestamps[HISTORY_BLOCK_SAMPLES];
+    uint16_t open_timestamp_ms[HISTORY_BLOCK_SAMPLES];
+    float open_position_x[HISTORY_BLOCK_SAMPLES];
+    float open_position_y[HISTORY_BLOCK_SAMPLES];
+    float open_temperature[HISTORY_BLOCK_SAMPLES];
+    uint8_t open_battery[HISTORY_BLOCK_SAMPLES];
+    uint8_t open_signal_strength[HISTORY_BLOCK_SAMPLES];
+    uint8_t open_state[HISTORY_BLOCK_SAMPLES];
+    size_t open_count;
+
+    // Escrita pelo ciclo principal, leitura pelos workers HTTP.
+    // Secções críticas são O(1) na escrita (mais a compressão de um bloco
+    // a cada HISTORY_BLOCK_SAMPLES amostras) e limitadas na leitura.
+    pthread_mutex_t lock;
+} TelemetryHistory;
+
+// ============ ESTRUTURA: ESTATÍSTICAS DE MEMÓRIA ============
+typedef struct {
+    uint64_t samples;                // Amostras retidas
+    uint64_t raw_bytes;              // Tamanho equivalente sem compressão
+    uint64_t stored_bytes;           // Bytes realmente ocupados
+} TelemetryHistoryStats;
+
+// ============ FUNÇÕES ============
+
+// Definir capacidade (em amostras) dos históricos criados a partir de agora
+void telemetry_history_init(size_t capacity);
+
+// Obter histórico de um rover (NULL se não existir)
+TelemetryHistory* telemetry_history_get(const char *rover_id);
+
+// Obter o timestamp mais antigo ainda em memória (1=existe, 0=vazio)
+int telemetry_history_oldest(const char *rover_id, uint32_t *oldest);
+
+// Consultar amostras com timestamp em [from, to], no máximo uma por cada
+// 'step' segundos (step=0 devolve todas). Devolve o número de amostras
+// copiadas para 'out' (as max_out mais recentes, por ordem cronológica);
+// *truncated=1 se o intervalo tinha mais pontos.
+size_t telemetry_history_query(const char *rover_id, uint32_t from, uint32_t to,
+                               uint32_t step, TelemetrySample *out, size_t max_out,
+                               int *truncated);
+
+// Estatísticas agregadas de todos os históricos
+void telemetry_history_stats(TelemetryHistoryStats *stats);
+
+#endif // TELEMETRYHISTORY_H
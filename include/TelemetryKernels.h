@@ -0,0 +1,48 @@
+// ============ TelemetryKernels.h ============
+// Kernels de agregação sobre colunas de telemetria (min/max/soma/contagem)
+// Implementações escalar, SSE2 e AVX2; a melhor suportada pelo CPU é
+// escolhida em tempo de execução na primeira chamada a telemetry_kernels().
+
+#ifndef TELEMETRYKERNELS_H
+#define TELEMETRYKERNELS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ============ VARIANTES ============
+typedef enum {
+    TK_SCALAR = 0,
+    TK_SSE2,
+    TK_AVX2,
+    TK_VARIANTS
+} TelemetryKernelISA;
+
+// ============ ESTRUTURA: TABELA DE KERNELS ============
+// Com n=0, min/max devolvem 0 e somas/contagens devolvem 0.
+typedef struct {
+    const char *name;
+
+    // Mínimo e máximo de uma coluna float
+    void (*minmax_f32)(const float *v, size_t n, float *min, float *max);
+
+    // Soma (acumulada em double)
+    double (*sum_f32)(const float *v, size_t n);
+
+    // Número de valores estritamente abaixo de 'threshold'
+    size_t (*count_below_f32)(const float *v, size_t n, float threshold);
+
+    // Equivalentes para colunas de bytes (bateria, sinal)
+    void (*minmax_u8)(const uint8_t *v, size_t n, uint8_t *min, uint8_t *max);
+    uint64_t (*sum_u8)(const uint8_t *v, size_t n);
+    size_t (*count_below_u8)(const uint8_t *v, size_t n, uint8_t threshold);
+} TelemetryKernels;
+
+// ============ FUNÇÕES ============
+
+// Melhor implementação suportada pelo CPU atual
+const TelemetryKernels* telemetry_kernels(void);
+
+// Implementação específica (NULL se não for suportada/compilada)
+const TelemetryKernels* telemetry_kernels_variant(TelemetryKernelISA isa);
+
+#endif // TELEMETRYKERNELS_H
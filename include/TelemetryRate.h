@@ -0,0 +1,38 @@
+// ============ TelemetryRate.h ============
+// Controlo adaptativo da taxa de telemetria (Nave-Mãe -> rovers)
+// O servidor calcula periodicamente o intervalo de amostragem de cada rover
+// a partir da carga de ingestão, do orçamento de CPU, de haver alguém a
+// observar o rover na API e do estado do rover (missão, bateria fraca).
+
+#ifndef TELEMETRYRATE_H
+#define TELEMETRYRATE_H
+
+#include "TelemetryStream.h"
+#include <stdint.h>
+#include <time.h>
+
+// ============ CONSTANTES ============
+#define TELEMETRY_RATE_PERIOD 2              // Recalcular a cada 2 segundos
+#define TELEMETRY_RATE_REFRESH 30            // Reenviar o controlo mesmo sem alterações
+#define TELEMETRY_INGEST_BUDGET 500.0        // Amostras/s que o servidor aceita sem travar
+#define TELEMETRY_CPU_BUDGET 0.50            // Fração de um core para o processo
+#define TELEMETRY_RATE_MIN_MS 100            // Intervalo mínimo (10 Hz)
+#define TELEMETRY_RATE_MAX_MS 10000          // Intervalo máximo (0.1 Hz)
+#define TELEMETRY_IDLE_FACTOR 5              // Rovers parados e não observados: 5x mais lentos
+#define TELEMETRY_LOW_BATTERY 20             // Bateria (%) que dá prioridade
+#define TELEMETRY_WATCH_WINDOW 30            // Segundos em que um pedido à API conta como "a observar"
+#define TELEMETRY_WATCH_SLOTS 64
+
+// ============ FUNÇÕES ============
+
+// Registar que alguém consultou um rover na API (chamado pelos workers HTTP)
+void telemetry_watch_touch(const char *rover_id);
+
+// Indicar se o rover foi consultado nos últimos TELEMETRY_WATCH_WINDOW segundos
+int telemetry_watch_active(const char *rover_id, time_t now);
+
+// Recalcular as taxas e enviar controlo aos rovers cuja taxa mudou
+// (chamado no ciclo principal; só atua a cada TELEMETRY_RATE_PERIOD)
+void telemetry_rate_control(TelemetryPool *pool, time_t now);
+
+#endif // TELEMETRYRATE_H
@@ -0,0 +1,79 @@
+// ============ TelemetryRollup.h ============
+// Agregados de telemetria em várias resoluções (10 s, 1 min, 1 h)
+// Atualizados incrementalmente a cada amostra recebida: min/max/média/último
+// de bateria, temperatura e sinal, mais a bounding box das posições.
+
+#ifndef TELEMETRYROLLUP_H
+#define TELEMETRYROLLUP_H
+
+#include "TelemetryStream.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+// ============ CONSTANTES ============
+#define ROLLUP_LEVELS 3
+#define ROLLUP_MAX_ROVERS 1024           // Rovers com agregados (= ROVER_REGISTRY_MAX)
+#define ROLLUP_QUERY_MAX_POINTS 200      // Intervalos máximos por resposta
+
+// Resolução (segundos) e retenção (intervalos) de cada nível
+#define ROLLUP_10S_RESOLUTION 10
+#define ROLLUP_10S_BUCKETS 2160          // 6 horas
+#define ROLLUP_1MIN_RESOLUTION 60
+#define ROLLUP_1MIN_BUCKETS 1440         // 24 horas
+#define ROLLUP_1H_RESOLUTION 3600
+#define ROLLUP_1H_BUCKETS 720            // 30 dias
+
+// ============ ESTRUTURA: AGREGADO DE UMA MÉTRICA ============
+typedef struct {
+    float min;
+    float max;
+    double sum;
+    float last;
+} RollupStat;
+
+// ============ ESTRUTURA: INTERVALO AGREGADO ============
+typedef struct {
+    uint32_t start;                  // Início do intervalo (alinhado à resolução)
+    uint32_t count;                  // Amostras agregadas
+    RollupStat battery;
+    RollupStat temperature;
+    RollupStat signal_strength;
+    float min_x, min_y;              // Bounding box das posições
+    float max_x, max_y;
+    uint8_t last_state;
+} RollupBucket;
+
+// ============ ESTRUTURA: NÍVEL (BUFFER CIRCULAR) ============
+typedef struct {
+    uint32_t resolution;             // Segundos por intervalo
+    size_t capacity;
+    size_t head;                     // Índice do intervalo mais antigo
+    size_t count;
+    RollupBucket *buckets;
+} RollupLevel;
+
+// ============ ESTRUTURA: AGREGADOS DE UM ROVER ============
+typedef struct {
+    char rover_id[32];
+    RollupLevel levels[ROLLUP_LEVELS];   // Da resolução mais fina para a mais grossa
+    pthread_mutex_t lock;            // Escrita pelo ciclo principal, leitura pelos workers
+} RoverRollups;
+
+// ============ FUNÇÕES ============
+
+// Incorporar uma amostra em todos os níveis
+void telemetry_rollup_update(const char *rover_id, const TelemetryMessage *msg);
+
+// Resolução mais grossa que não excede 'step' (0 se nenhuma serve)
+uint32_t telemetry_rollup_resolution(uint32_t step);
+
+// Consultar agregados com início em [from, to] na resolução indicada,
+// reagrupados em intervalos de 'step' segundos (step >= resolução).
+// Se houver mais de max_out, devolve os mais recentes (por ordem cronológica).
+// Devolve o número de intervalos; -1 se o rover não tiver agregados.
+int telemetry_rollup_query(const char *rover_id, uint32_t resolution,
+                           uint32_t from, uint32_t to, uint32_t step,
+                           RollupBucket *out, size_t max_out, int *truncated);
+
+#endif // TELEMETRYROLLUP_H
@@ -0,0 +1,102 @@
+// ============ TelemetryStore.h ============
+// Armazenamento persistente de telemetria em disco
+// Segmentos append-only de registos de largura fixa escritos via mmap, com
+// índice temporal esparso no cabeçalho de cada segmento. As consultas leem
+// diretamente dos segmentos mapeados, sem cópias e sem replay no arranque.
+// Cada bloco do índice tem ainda um filtro de Bloom dos rover_id que contém:
+// uma consulta salta os blocos onde o rover não está sem ler os registos.
+// Retenção por idade (STORE_RETENTION_SECONDS) e por espaço: quando os
+// segmentos chegam ao limite, os fechados mais antigos são apagados.
+
+#ifndef TELEMETRYSTORE_H
+#define TELEMETRYSTORE_H
+
+#include "TelemetryStream.h"
+#include <stdint.h>
+#include <stddef.h>
+
+// ============ CONSTANTES ============
+#define TELEMETRY_STORE_DIR "telemetry_store"
+#define STORE_MAGIC 0x47455354              // "TSEG"
+#define STORE_VERSION 2                      // v2: filtros de rover por bloco
+#define STORE_SEGMENT_RECORDS 65536          // Registos por segmento (4 MB)
+#define STORE_INDEX_STRIDE 256               // Registos por entrada do índice
+#define STORE_INDEX_ENTRIES (STORE_SEGMENT_RECORDS / STORE_INDEX_STRIDE)
+#define STORE_FILTER_BITS 2048               // Filtro de Bloom por bloco (~3% falsos positivos com 256 rovers)
+#define STORE_FILTER_HASHES 3
+#define STORE_FILTER_BYTES (STORE_FILTER_BITS / 8)
+#define STORE_HEADER_SIZE_V1 4096            // Cabeçalho + índice (1 página)
+#define STORE_HEADER_SIZE (STORE_HEADER_SIZE_V1 + STORE_INDEX_ENTRIES * STORE_FILTER_BYTES)
+#define STORE_SEGMENT_MAX_AGE 3600           // Rollover por tempo (segundos)
+#define STORE_RETENTION_SECONDS (7 * 24 * 3600)  // Apagar segmentos com mais de 7 dias
+#define STORE_MAINTENANCE_INTERVAL 60        // Verificar retenção a cada 60 s
+#define STORE_MAX_SEGMENTS 512               // Limite de espaço (~2 GB): apagar os mais antigos
+#define STORE_SEGMENT_HEADROOM 4             // Slots mantidos livres pela manutenção
+
+// ============ ESTRUTURA: REGISTO (64 BYTES, LARGURA FIXA) ============
+#pragma pack(push, 1)
+typedef struct {
+    uint32_t timestamp;              // Unix timestamp da amostra
+    char rover_id[32];               // ID do rover
+    float position_x;
+    float position_y;
+    float temperature;
+    uint8_t battery;
+    uint8_t state;
+    uint8_t signal_strength;
+    uint16_t timestamp_ms;           // Milissegundos (0 em registos antigos)
+    uint8_t reserved[11];            // Alinhamento a 64 bytes / extensões futuras
+} TelemetryRecord;
+
+// ============ ESTRUTURA: ENTRADA DO ÍNDICE ESPARSO ============
+// Intervalo temporal de um bloco de STORE_INDEX_STRIDE registos
+typedef struct {
+    uint32_t min_ts;
+    uint32_t max_ts;
+} StoreIndexEntry;
+
+// ============ ESTRUTURA: CABEÇALHO DO SEGMENTO (EM DISCO) ============
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t capacity;               // Registos máximos
+    uint32_t count;                  // Registos escritos (atualizado após o registo)
+    uint32_t sealed;                 // 1 = segmento fechado (só leitura)
+    uint32_t created_at;             // Hora de criação (rollover por tempo)
+    uint32_t min_ts;                 // Intervalo temporal do segmento
+    uint32_t max_ts;
+    StoreIndexEntry index[STORE_INDEX_ENTRIES];
+} StoreSegmentHeader;
+#pragma pack(pop)
+
+// v2: filtros de rover, a seguir à primeira página (STORE_HEADER_SIZE_V1)
+typedef uint8_t StoreRoverFilter[STORE_FILTER_BYTES];
+
+// Visitante de consultas: recebe um ponteiro para o registo no mapeamento
+// (válido apenas durante a chamada). Devolver 0 interrompe a consulta.
+typedef int (*TelemetryStoreVisitor)(const TelemetryRecord *rec, void *ctx);
+
+// ============ FUNÇÕES ============
+
+// Abrir (ou criar) o armazenamento no diretório indicado (0=ok, -1=erro)
+int telemetry_store_open(const char *dir);
+
+// Fechar todos os segmentos
+void telemetry_store_close(void);
+
+// Acrescentar uma amostra (no-op se o armazenamento não estiver aberto)
+void telemetry_store_append(const char *rover_id, const TelemetryMessage *msg);
+
+// Rollover por tempo e apagamento por retenção: idade e espaço (chamado periodicamente)
+void telemetry_store_maintain(time_t now);
+
+// Percorrer os registos de um rover com timestamp em [from, to], por ordem
+// de escrita. Devolve o número de registos visitados.
+size_t telemetry_store_query(const char *rover_id, uint32_t from, uint32_t to,
+                             TelemetryStoreVisitor visit, void *ctx);
+
+// Indicar se o armazenamento está aberto
+int telemetry_store_is_open(void);
+
+#endif // TELEMETRYSTORE_H
@@ -12,9 +12,50 @@
 
 // ============ CONSTANTES ============
 #define TELEMETRY_PORT 5006
-#define MAX_TELEMETRY_CONNECTIONS 10
+#define MAX_TELEMETRY_CONNECTIONS 512       // Sessões vivas (limitado pelo select())
 #define TELEMETRY_SEND_INTERVAL 1  // Enviar telemetria a cada 5 segundos
 
+// Lotes de telemetria (rover): amostragem mais fina, um envio por lote
+#define TELEMETRY_SAMPLE_INTERVAL_MS 200     // Amostragem a 5 Hz
+#define TELEMETRY_BATCH_SAMPLES 16           // Enviar quando o lote tiver 16 amostras...
+#define TELEMETRY_BATCH_LATENCY_MS 1000      // ...ou quando a mais antiga tiver 1 s
+#define TELEMETRY_BATCH_MAX_SAMPLES 64       // Máximo aceite pelo servidor num lote
+#define TELEMETRY_BATCH_MAGIC 0xFEED7E1Eu    // Maior que qualquer timestamp plausível
+
+// Stream v2 (negociado no início da conexão): amostras com deltas
+#define TELEMETRY_HELLO_MAGIC 0xFEED7E20u
+#define TELEMETRY_VERSION_MAX 3              // Versão mais recente suportada
+#define TELEMETRY_HELLO_TIMEOUT 2            // Segundos à espera da resposta
+#define TELEMETRY_POSITION_SCALE 100.0f      // Posições em centésimas (ponto fixo)
+#define TELEMETRY_V2_MAX_SAMPLE 33           // Pior caso de uma amostra codificada (v3)
+
+// Canal UDP opcional (posições de alta frequência, sem garantias de entrega)
+#define TELEMETRY_UDP_PORT 5007
+#define TELEMETRY_DATAGRAM_MAGIC 0xFEED7E35u
+#define TELEMETRY_DATAGRAM_VERSION 1
+#define TELEMETRY_UDP_RESTART_GAP 1024       // Sequência muito atrás = rover reiniciou
+#define TELEMETRY_UDP_LIVE_WINDOW 3          // Segundos em que o UDP manda no estado ao vivo
+
+// Pool de sessões (servidor)
+#define TELEMETRY_SLAB_SESSIONS 16           // Sessões alocadas de cada vez
+#define TELEMETRY_POOL_ID_BUCKETS 256        // Tabela de IDs (potência de 2)
+#define TELEMETRY_IDLE_TIMEOUT 60            // Segundos sem dados até fechar a sessão
+#define TELEMETRY_REAP_INTERVAL 5            // Verificar sessões inativas a cada 5 s
+
+// Controlo de taxa (servidor -> rover, na conexão TCP de telemetria)
+#define TELEMETRY_CONTROL_MAGIC 0xFEED7E36u
+
+// Bits do mapa de presença de cada amostra v2/v3. A v3 só muda o timestamp:
+// o delta passa a ser em milissegundos (varint de 64 bits), a v2 em segundos.
+#define TV2_TIMESTAMP   0x01         // Delta zigzag/varint
+#define TV2_POSITION_X  0x02         // Delta zigzag/varint (ponto fixo)
+#define TV2_POSITION_Y  0x04         // Delta zigzag/varint (ponto fixo)
+#define TV2_BATTERY     0x08         // Valor absoluto (1 byte)
+#define TV2_STATE       0x10         // Valor absoluto (1 byte)
+#define TV2_TEMPERATURE 0x20         // Valor absoluto (float, 4 bytes)
+#define TV2_SIGNAL      0x40         // Valor absoluto (1 byte)
+#define TV2_NONCE       0x80         // Valor absoluto (varint)
+
 // ============ TIPOS DE DADOS ============
 typedef enum {
     STATE_IDLE = 0,          // Parado à base
@@ -28,6 +69,7 @@ typedef enum {
 #pragma pack(push, 1)
 typedef struct {
     uint32_t timestamp;              // Unix timestamp
+    uint16_t timestamp_ms;           // Milissegundos (0-999); 0 em streams v1/v2
     
     char rover_id[32];               // ID do rover
     float position_x;                // Coordenada X
@@ -39,8 +81,108 @@ typedef struct {
     
     uint32_t nonce;                  // Número aleatório (segurança)
 } TelemetryMessage;
+
+// ============ ESTRUTURA: MENSAGEM V1 (WIRE) ============
+// Formato original, ainda usado no stream v1 (mensagens isoladas e lotes):
+// sem milissegundos, que chegam ao servidor como 0.
+typedef struct {
+    uint32_t timestamp;
+    char rover_id[32];
+    float position_x;
+    float position_y;
+    uint8_t battery;
+    uint8_t state;
+    float temperature;
+    uint8_t signal_strength;
+    uint32_t nonce;
+} TelemetryMessageV1;
+
+// ============ ESTRUTURA: CABEÇALHO DE LOTE ============
+// Seguido de 'count' TelemetryMessageV1. Mensagens isoladas (sem cabeçalho)
+// continuam a ser aceites: começam por um timestamp, nunca igual ao magic.
+typedef struct {
+    uint32_t magic;                  // TELEMETRY_BATCH_MAGIC
+    uint16_t count;                  // Amostras no lote
+    uint16_t reserved;
+} TelemetryBatchHeader;
+
+// ============ ESTRUTURA: NEGOCIAÇÃO (ROVER -> SERVIDOR) ============
+// O ID do rover segue uma única vez, no início da conexão
+typedef struct {
+    uint32_t magic;                  // TELEMETRY_HELLO_MAGIC
+    uint8_t version;                 // Versão mais alta suportada pelo rover
+    uint8_t reserved;
+    char rover_id[32];
+} TelemetryHello;
+
+// ============ ESTRUTURA: RESPOSTA À NEGOCIAÇÃO ============
+typedef struct {
+    uint32_t magic;                  // TELEMETRY_HELLO_MAGIC
+    uint8_t version;                 // Versão aceite pelo servidor
+} TelemetryHelloAck;
+
+// ============ ESTRUTURA: CABEÇALHO DE FRAME V2 ============
+// Seguido de 'length' bytes com 'count' amostras codificadas
+typedef struct {
+    uint16_t length;
+    uint8_t count;
+} TelemetryV2Header;
+
+// ============ ESTRUTURA: CONTROLO DE TAXA (SERVIDOR -> ROVER) ============
+// Só enviado a rovers que negociaram v2 (os restantes nunca leem o socket)
+typedef struct {
+    uint32_t magic;                  // TELEMETRY_CONTROL_MAGIC
+    uint16_t sample_interval_ms;     // Intervalo de amostragem pedido
+    uint16_t batch_latency_ms;       // Latência máxima de cada lote
+} TelemetryRateControl;
 #pragma pack(pop)
 
+// ============ DATAGRAMA UDP (FORMATO NA REDE) ============
+// Autocontido (inclui o ID do rover): cada datagrama pode perder-se sozinho.
+// Campos escritos explicitamente em little-endian (MissionLinkWire.h), atrás
+// de um cabeçalho com versão, comprimento e CRC32C:
+//
+//   0  magic     u32   TELEMETRY_DATAGRAM_MAGIC
+//   4  version   u8    TELEMETRY_DATAGRAM_VERSION
+//   5  reserved  u8
+//   6  length    u16   Bytes do datagrama, cabeçalho incluído
+//   8  crc32c    u32   Bytes [0,8) e [12,length)
+//  12  corpo     (offsets TDG_OFF_*)
+//
+// Como no MissionLink, versões futuras só acrescentam campos no fim: o
+// recetor aceita qualquer versão >= 1 com length >= TELEMETRY_DATAGRAM_SIZE.
+#define TDG_OFF_SEQ 12                       // Sequência crescente por rover
+#define TDG_OFF_TIMESTAMP 16
+#define TDG_OFF_TIMESTAMP_MS 20
+#define TDG_OFF_ROVER_ID 22
+#define TDG_OFF_POSITION_X 54
+#define TDG_OFF_POSITION_Y 58
+#define TDG_OFF_BATTERY 62
+#define TDG_OFF_STATE 63
+#define TDG_OFF_TEMPERATURE 64
+#define TDG_OFF_SIGNAL 68
+#define TDG_OFF_NONCE 69
+#define TELEMETRY_DATAGRAM_SIZE 73           // Datagrama completo da versão 1
+
+#define TELEMETRY_RX_BUFFER_SIZE (sizeof(TelemetryBatchHeader) + \
+                                  TELEMETRY_BATCH_MAX_SAMPLES * sizeof(TelemetryMessageV1))
+
+// ============ ESTRUTURA: ESTADO DO CODEC V2 ============
+// Última amostra enviada/recebida; os deltas são relativos a ela
+typedef struct {
+    uint32_t timestamp;
+    uint16_t timestamp_ms;           // Só avança na v3
+    int32_t position_x;              // Ponto fixo (x TELEMETRY_POSITION_SCALE)
+    int32_t position_y;
+    uint8_t battery;
+    uint8_t state;
+    uint8_t signal_strength;
+    float temperature;
+    uint32_t nonce;
+} TelemetryV2State;
+
+struct RoverEntity;                  // RoverRegistry.h
+
 // ============ ESTRUTURA: SESSÃO DE TELEMETRIA ============
 typedef struct {
     char rover_id[32];               // ID do rover
@@ -55,24 +197,117 @@ typedef struct {
     int sockfd;                      // Socket TCP do rover
     struct sockaddr_in addr;         // Endereço do rover
     int active;                      // Flag: ativo ou inativo
+    
+    uint8_t *rx_buf;                 // Bytes recebidos ainda sem frame completo
+    size_t rx_len;
+    
+    uint8_t version;                 // Versão do stream negociada (1 a 3)
+    TelemetryV2State v2;             // Estado do descodificador v2/v3
+    
+    // Canal UDP (opcional)
+    int udp_active;                  // Já recebeu datagramas
+    uint32_t udp_max_seq;            // Maior sequência aceite
+    uint64_t udp_received;           // Datagramas aceites
+    uint64_t udp_lost;               // Sequências em falta
+    uint64_t udp_stale;              // Datagramas atrasados/duplicados descartados
+    time_t udp_last_update;          // Último datagrama aceite
+    
+    // Controlo de taxa
+    uint32_t rate_interval_ms;       // Último intervalo enviado (0 = nunca)
+    time_t rate_sent_at;
+    uint8_t rate_pending[sizeof(TelemetryRateControl)];  // Resto de um envio parcial
+    uint8_t rate_pending_len;
+    uint8_t rate_pending_off;
+    
+    // Ligações do pool (índices base 1, 0 = nenhum)
+    int slot;                        // Posição desta sessão no pool
+    int pool_next;                   // Lista livre
+    int id_next;                     // Tabela de IDs
+    int id_linked;                   // Já registada na tabela de IDs
+    int lru_prev, lru_next;          // Lista por atividade (mais antiga primeiro)
+    time_t last_activity;            // Últimos bytes recebidos (TCP ou UDP)
+    
+    struct RoverEntity *entity;      // Entrada do rover no registo (servidor)
 } TelemetrySession;
 
+// ============ ESTRUTURA: POOL DE SESSÕES ============
+// Sessões alocadas em slabs de TELEMETRY_SLAB_SESSIONS: os endereços nunca
+// mudam, os slots libertados são reutilizados (lista livre) e no máximo
+// existe uma sessão por rover_id.
+typedef struct {
+    TelemetrySession **slabs;
+    size_t num_slabs;
+    size_t used;                     // Slots já usados alguma vez (limite das iterações)
+    size_t live;                     // Sessões ativas
+    int free_head;
+    int id_heads[TELEMETRY_POOL_ID_BUCKETS];
+    int lru_head, lru_tail;
+} TelemetryPool;
+
+// ============ ESTRUTURA: BATCHER DE TELEMETRIA (ROVER) ============
+typedef struct {
+    int fd;                          // Socket TCP (não bloqueante)
+    int version;                     // Versão do stream (1 a 3)
+    TelemetryV2State v2;             // Estado do codificador v2/v3
+    TelemetryMessage samples[TELEMETRY_BATCH_MAX_SAMPLES];
+    size_t count;                    // Amostras à espera de envio
+    size_t max_samples;              // Limite de tamanho do lote
+    uint32_t max_latency_ms;         // Limite de latência do lote
+    uint64_t first_sample_ms;        // Momento da amostra mais antiga do lote
+
+    // Frame parcialmente enviado (socket cheio); enviado antes do próximo lote
+    uint8_t pending[TELEMETRY_RX_BUFFER_SIZE];
+    size_t pending_len;
+    size_t pending_off;
+
+    // Mensagem de controlo parcialmente recebida
+    uint8_t control[sizeof(TelemetryRateControl)];
+    size_t control_len;
+
+    // Estatísticas
+    uint64_t frames_sent;
+    uint64_t samples_sent;
+    uint64_t samples_dropped;
+} TelemetryBatcher;
+
 // ============ FUNÇÕES: SERVIDOR (NAVE-MÃE) ============
 
+// Inicializar / destruir o pool (destruir fecha todas as sessões)
+void telemetry_pool_init(TelemetryPool *pool);
+void telemetry_pool_destroy(TelemetryPool *pool);
+
+// Sessão no slot i (0 <= i < pool->used); verificar 'active'
+TelemetrySession* telemetry_pool_at(const TelemetryPool *pool, size_t i);
+
+// Sessão ativa de um rover, ou NULL
+TelemetrySession* telemetry_pool_find(const TelemetryPool *pool, const char *rover_id);
+
+// Fechar sessões sem atividade há TELEMETRY_IDLE_TIMEOUT (devolve quantas)
+size_t telemetry_pool_reap(TelemetryPool *pool, time_t now);
+
 // Criar socket servidor TCP para telemetria
 int create_telemetry_server(int port);
 
 // Aceitar nova conexão TCP de rover
-void accept_telemetry_connection(int server_fd, TelemetrySession *sessions, int *count);
+void accept_telemetry_connection(int server_fd, TelemetryPool *pool);
 
 // Receber dados de telemetria de um rover
-void receive_telemetry_data(TelemetrySession *session);
+void receive_telemetry_data(TelemetryPool *pool, TelemetrySession *session);
+
+// Criar socket UDP para o canal rápido de telemetria
+int create_telemetry_udp_server(int port);
+
+// Receber um datagrama de telemetria e atualizar a sessão do rover
+void receive_telemetry_datagram(int fd, TelemetryPool *pool);
 
 // Armazenar dados de telemetria no histórico
 void store_telemetry(TelemetrySession *session, TelemetryMessage *msg);
 
+// Total de amostras processadas desde o arranque (carga de ingestão)
+uint64_t telemetry_samples_ingested(void);
+
 // Imprimir status de telemetria
-void print_telemetry_status(TelemetrySession *sessions, int count);
+void print_telemetry_status(const TelemetryPool *pool);
 
 // ============ FUNÇÕES: CLIENTE (ROVER) ============
 
@@ -82,4 +317,33 @@ int create_telemetry_connection(const char *host, int port);
 // Enviar mensagem de telemetria
 void send_telemetry_message(int fd, TelemetryMessage *msg);
 
+// Criar socket UDP ligado ao canal rápido do servidor (não bloqueante)
+int create_telemetry_udp_connection(const char *host, int port);
+
+// Enviar uma amostra por UDP (perdas são toleradas, nunca bloqueia)
+void send_telemetry_datagram(int fd, uint32_t seq, const TelemetryMessage *msg);
+
+// Negociar a versão do stream logo após connect() (bloqueante, com timeout).
+// Devolve a versão aceite; 1 se o servidor não respondeu (a conexão deve
+// então ser reaberta, pois o servidor pode ter lido a negociação como dados).
+int telemetry_negotiate(int fd, const char *rover_id);
+
+// Inicializar batcher (coloca o socket em modo não bloqueante)
+void telemetry_batcher_init(TelemetryBatcher *b, int fd, int version,
+                            size_t max_samples, uint32_t max_latency_ms);
+
+// Acrescentar uma amostra; envia o lote se atingir o tamanho máximo.
+// Devolve -1 se a conexão falhou, 0 caso contrário.
+int telemetry_batcher_add(TelemetryBatcher *b, const TelemetryMessage *msg);
+
+// Enviar o lote se o prazo de latência expirou (chamar no ciclo principal)
+int telemetry_batcher_poll(TelemetryBatcher *b);
+
+// Enviar imediatamente o que estiver pendente
+int telemetry_batcher_flush(TelemetryBatcher *b);
+
+// Ler (sem bloquear) uma mensagem de controlo de taxa do servidor.
+// Devolve 1 se *ctl foi preenchido, 0 se não há nada, -1 se a conexão fechou.
+int telemetry_batcher_read_control(TelemetryBatcher *b, TelemetryRateControl *ctl);
+
 #endif // TELEMETRYSTREAM_H
\ No newline at end of file
@@ -0,0 +1,70 @@
+// ============ TimerWheel.h ============
+// Roda de temporizadores hierárquica para o ciclo select()
+// TIMER_WHEEL_LEVELS rodas de TIMER_WHEEL_SLOTS ranhuras: o nível 0 tem a
+// resolução de um tick, cada nível seguinte cobre uma volta inteira do
+// anterior por ranhura. Um temporizador entra no nível mais baixo que o
+// alcança e desce de nível ("cascata") quando a roda chega à sua ranhura.
+// Armar e cancelar são O(1); avançar só toca nos temporizadores que vencem
+// ou descem de nível, nunca em todos os armados. Um bitmap por nível diz
+// que ranhuras têm temporizadores, o que torna o próximo timeout barato.
+// Os nós são intrusivos: vivem dentro de quem os usa (p.ex. RoverEntity),
+// sem alocações. Relógio: monótono, em milissegundos (arq_now_ms).
+
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ============ CONSTANTES ============
+#define TIMER_WHEEL_TICK_MS 10           // Resolução
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)   // Ranhuras por nível (64)
+#define TIMER_WHEEL_LEVELS 4             // 640 ms, 41 s, 44 min, 46 h
+
+// ============ ESTRUTURA: TEMPORIZADOR ============
+typedef struct Timer Timer;
+typedef void (*TimerCallback)(Timer *timer, void *arg);
+
+struct Timer {
+    Timer *next, *prev;              // Lista da ranhura (NULL: desarmado)
+    uint64_t expires_ms;
+    int level, slot;                 // Onde está (para o bitmap ao cancelar)
+    TimerCallback fn;
+    void *arg;
+};
+
+// ============ ESTRUTURA: RODA ============
+typedef struct {
+    Timer slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];  // Sentinelas das listas
+    uint64_t occupied[TIMER_WHEEL_LEVELS];               // Bit s: ranhura s não vazia
+    uint64_t tick;                   // Último tick processado
+    size_t armed;
+} TimerWheel;
+
+// ============ FUNÇÕES ============
+
+// Inicializar a roda no instante now_ms
+void timer_wheel_init(TimerWheel *wheel, uint64_t now_ms);
+
+// Preparar um temporizador (desarmado)
+void timer_init(Timer *timer, TimerCallback fn, void *arg);
+
+// Armar (ou rearmar) para expires_ms; no passado expira no próximo avanço
+void timer_arm(TimerWheel *wheel, Timer *timer, uint64_t expires_ms);
+
+// Desarmar (sem efeito se não estiver armado)
+void timer_cancel(TimerWheel *wheel, Timer *timer);
+
+// Está armado?
+int timer_armed(const Timer *timer);
+
+// Disparar os temporizadores expirados até now_ms; devolve quantos
+// (os callbacks podem rearmar ou cancelar temporizadores)
+int timer_wheel_advance(TimerWheel *wheel, uint64_t now_ms);
+
+// Milissegundos até a roda ter trabalho: o próximo temporizador, ou antes
+// disso a próxima descida de nível (-1 se não há nenhum armado)
+int timer_wheel_next_timeout(const TimerWheel *wheel, uint64_t now_ms);
+
+#endif // TIMERWHEEL_H
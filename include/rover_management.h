@@ -21,8 +21,21 @@ typedef struct {
     uint32_t update_interval;       // Intervalo entre updates
     
     int has_mission;                // Flag: tem missão ativa? (1=sim)
+    uint8_t queue_depth;            // Missões em fila pedidas à Nave-Mãe
+
+    // Conexão MissionLink (handshake; guardada para retomar sem ele)
+    uint32_t conn_id;               // ID de conexão (0: sem handshake)
+    uint64_t resume_token;          // Token de retoma
 } RoverState;
 
+// ============ ESTRUTURA: FILA DE MISSÕES ============
+// ASSIGNs recebidas e ainda por começar (FIFO circular)
+typedef struct {
+    Packet items[MISSION_QUEUE_MAX];
+    int head;                       // Próxima a começar
+    int count;
+} MissionQueue;
+
 // ============ FUNÇÕES ============
 
 // Inicializar estado do rover
@@ -43,4 +56,18 @@ void prepare_progress_packet(RoverState *state, Packet *pkt, uint8_t progress, u
 // Preparar pacote COMPLETE
 void prepare_complete_packet(RoverState *state, Packet *pkt, uint8_t battery);
 
+// ============ FUNÇÕES: FILA DE MISSÕES ============
+
+// Esvaziar a fila
+void mission_queue_init(MissionQueue *queue);
+
+// Acrescentar uma ASSIGN; devolve 0, ou -1 se está cheia ou já lá está
+int mission_queue_push(MissionQueue *queue, const Packet *assign_pkt);
+
+// Tirar a próxima ASSIGN; devolve 0, ou -1 se está vazia
+int mission_queue_pop(MissionQueue *queue, Packet *assign_pkt);
+
+// Retirar a missão mission_id; devolve 1 se estava na fila
+int mission_queue_remove(MissionQueue *queue, const char *mission_id);
+
 #endif // ROVER_MANAGEMENT_H
\ No newline at end of file
@@ -17,6 +17,8 @@ typedef struct {
     float position_x;               // Posição X
     float position_y;               // Posição Y
     uint32_t timestamp;             // Timestamp do estado
+    uint32_t conn_id;               // ID de conexão MissionLink
+    uint64_t resume_token;          // Token de retoma (0-RTT após reinício)
 } RoverPersistedState;
 
 // ============ FUNÇÕES DE PERSISTÊNCIA ============
@@ -1,13 +1,19 @@
 // ============ API_Observation.c (COMPLETO - SEM DUPLICATAS) ============
 // Implementação da API de Observação (HTTP REST)
 #include "API_Observation.h"
+#include "TelemetryStore.h"
+#include "TelemetryKernels.h"
+#include "TelemetryRate.h"
+#include "EventLog.h"
 #include "MissionLink.h"
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <time.h>
+#include <sys/sendfile.h>
 
 // ============ SERVIDOR HTTP ============
 
@@ -69,6 +75,15 @@ APIEndpoint parse_http_endpoint(const char *request, char *resource_id) {
     if (strncmp(request, "GET /api/rovers HTTP", 20) == 0) {
         return ENDPOINT_ROVERS_LIST;
     }
+    else if (strncmp(request, "GET /api/rovers?", 16) == 0) {
+        char bbox[8];
+        return get_query_param(request, "bbox", bbox, sizeof(bbox)) ?
+               ENDPOINT_ROVERS_BBOX : ENDPOINT_ROVERS_LIST;
+    }
+    else if (strncmp(request, "GET /api/rovers/nearest", 23) == 0 &&
+             (request[23] == '?' || request[23] == ' ')) {
+        return ENDPOINT_ROVERS_NEAREST;
+    }
     else if (strncmp(request, "GET /api/rovers/", 16) == 0) {
         sscanf(request, "GET /api/rovers/%s HTTP", resource_id);
         for (int i = 0; i < 256; i++) {
@@ -103,15 +118,58 @@ APIEndpoint parse_http_endpoint(const char *request, char *resource_id) {
                 break;
             }
         }
+        char *history = strstr(resource_id, "/history");
+        if (history && (history[8] == '\0' || history[8] == '?')) {
+            *history = '\0';
+            return ENDPOINT_TELEMETRY_HISTORY;
+        }
         return ENDPOINT_TELEMETRY_ROVER;
     }
     else if (strncmp(request, "GET /api/system/status HTTP", 27) == 0) {
         return ENDPOINT_SYSTEM_STATUS;
     }
+    else if (strncmp(request, "GET /api/results HTTP", 21) == 0) {
+        return ENDPOINT_RESULTS_LIST;
+    }
+    else if (strncmp(request, "GET /api/results/", 17) == 0) {
+        sscanf(request, "GET /api/results/%255s HTTP", resource_id);
+        return ENDPOINT_RESULT_DOWNLOAD;
+    }
+    else if (strncmp(request, "GET /api/events", 15) == 0 &&
+             (request[15] == '?' || request[15] == ' ')) {
+        return ENDPOINT_EVENTS;
+    }
     
     return ENDPOINT_NOT_FOUND;
 }
 
+int get_query_param(const char *request, const char *name, char *value, size_t size) {
+    if (!request || !name || !value || size == 0) return 0;
+    
+    // Apenas a linha de pedido ("GET /caminho?a=1&b=2 HTTP/1.1")
+    const char *line_end = strpbrk(request, "\r\n");
+    const char *query = strchr(request, '?');
+    if (!query || (line_end && query > line_end)) return 0;
+    
+    size_t name_len = strlen(name);
+    const char *p = query + 1;
+    
+    while (*p && *p != ' ' && *p != '\r' && *p != '\n') {
+        const char *end = p;
+        while (*end && *end != '&' && *end != ' ' && *end != '\r' && *end != '\n') end++;
+        
+        if ((size_t)(end - p) > name_len && strncmp(p, name, name_len) == 0 && p[name_len] == '=') {
+            size_t len = (size_t)(end - (p + name_len + 1));
+            if (len >= size) len = size - 1;
+            memcpy(value, p + name_len + 1, len);
+            value[len] = '\0';
+            return 1;
+        }
+        p = (*end == '&') ? end + 1 : end;
+    }
+    return 0;
+}
+
 // ============ UTILITÁRIOS ============
 
 const char* get_rover_state_name(uint8_t state) {
@@ -125,20 +183,82 @@ const char* get_rover_state_name(uint8_t state) {
     }
 }
 
+const char* get_mission_status_name(MissionStatus status) {
+    switch(status) {
+        case MISSION_RESERVED:  return "reserved";
+        case MISSION_ACTIVE:    return "in_progress";
+        case MISSION_COMPLETED: return "completed";
+        case MISSION_REVOKED:   return "revoked";
+        default:                return "unknown";
+    }
+}
+
 void format_timestamp(uint32_t ts, char *buffer, size_t size) {
     if (ts == 0) {
         snprintf(buffer, size, "2024-01-01T00:00:00Z");
         return;
     }
     time_t t = (time_t)ts;
-    struct tm *tm_info = localtime(&t);
-    strftime(buffer, size, "%Y-%m-%dT%H:%M:%SZ", tm_info);
+    struct tm tm_info;
+    localtime_r(&t, &tm_info);
+    strftime(buffer, size, "%Y-%m-%dT%H:%M:%SZ", &tm_info);
+}
+
+// ============ CONSULTA AO ARMAZENAMENTO EM DISCO ============
+
+// Contexto do visitante: aplica o 'step' enquanto percorre os segmentos
+// Guarda os max_out pontos mais recentes (buffer circular em out[]): um
+// intervalo largo devolve o fim, como a consulta em memória
+typedef struct {
+    TelemetrySample *out;
+    size_t max_out;
+    size_t count;
+    size_t seen;                     // Pontos aceites (count = min(seen, max_out))
+    uint32_t step;
+    uint32_t next_ts;
+    int truncated;
+} HistoryDiskQuery;
+
+static int history_disk_visit(const TelemetryRecord *rec, void *ctx) {
+    HistoryDiskQuery *q = (HistoryDiskQuery *)ctx;
+    
+    if (q->step > 0 && q->seen > 0 && rec->timestamp < q->next_ts) return 1;
+    
+    TelemetrySample *s = &q->out[q->seen % q->max_out];
+    q->seen++;
+    if (q->count < q->max_out) {
+        q->count++;
+    } else {
+        q->truncated = 1;
+    }
+    s->timestamp = rec->timestamp;
+    s->timestamp_ms = rec->timestamp_ms;
+    s->position_x = rec->position_x;
+    s->position_y = rec->position_y;
+    s->battery = rec->battery;
+    s->temperature = rec->temperature;
+    s->signal_strength = rec->signal_strength;
+    s->state = rec->state;
+    
+    q->next_ts = rec->timestamp + q->step;
+    return 1;
+}
+
+// Pôr o buffer circular por ordem cronológica
+static void history_disk_finish(HistoryDiskQuery *q) {
+    size_t head = q->seen % q->max_out;
+    if (q->seen <= q->max_out || head == 0) return;
+    
+    TelemetrySample tmp[HISTORY_QUERY_MAX_POINTS];
+    memcpy(tmp, q->out + head, (q->max_out - head) * sizeof(*tmp));
+    memcpy(tmp + (q->max_out - head), q->out, head * sizeof(*tmp));
+    memcpy(q->out, tmp, q->max_out * sizeof(*tmp));
 }
 
 // ============ GERAÇÃO DE JSON ============
 
 void generate_rovers_list_json(char *buffer, size_t buf_size,
-                               RoverSession *rovers, int num_rovers) {
+                               const RoverView *rovers, int num_rovers) {
     if (!buffer || !rovers) {
         snprintf(buffer, buf_size, "{\"rovers\": []}\n");
         return;
@@ -151,12 +271,13 @@ void generate_rovers_list_json(char *buffer, size_t buf_size,
     int count = 0;
     
     for (int i = 0; i < num_rovers; i++) {
-        if (!rovers[i].active) continue;
+        const RoverSession *link = &rovers[i].link;
+        if (!rovers[i].has_link || !link->active) continue;
         
         if (!first) len += snprintf(buffer + len, buf_size - len, ",\n");
         
         time_t now = time(NULL);
-        time_t time_since = now - rovers[i].last_update;
+        time_t time_since = now - link->last_update;
         
         len += snprintf(buffer + len, buf_size - len,
             "    {\n"
@@ -168,10 +289,10 @@ void generate_rovers_list_json(char *buffer, size_t buf_size,
             "      \"last_update_seconds_ago\": %ld\n"
             "    }",
             rovers[i].rover_id,
-            (time_since < 35) ? "active" : "inactive",
+            !rovers[i].heartbeat.expired ? "active" : "inactive",
             rovers[i].battery,
-            rovers[i].progress,
-            rovers[i].mission_id[0] ? rovers[i].mission_id : "null",
+            link->progress,
+            link->mission_id[0] ? link->mission_id : "null",
             time_since);
         
         first = 0;
@@ -184,12 +305,97 @@ void generate_rovers_list_json(char *buffer, size_t buf_size,
     printf("[API] Rovers JSON: %d rovers, %d bytes\n", count, len);
 }
 
+void generate_spatial_json(char *buffer, size_t buf_size, const char *query,
+                           SpatialResult *results, size_t count, int truncated) {
+    if (!buffer) return;
+    
+    time_t now = time(NULL);
+    size_t len = 0;
+    len += snprintf(buffer + len, buf_size - len,
+        "{\n"
+        "  \"query\": \"%s\",\n"
+        "  \"count\": %zu,\n"
+        "  \"truncated\": %s,\n"
+        "  \"rovers\": [\n",
+        query, count, truncated ? "true" : "false");
+    
+    for (size_t i = 0; i < count && len < buf_size; i++) {
+        len += snprintf(buffer + len, buf_size - len,
+            "    {\"rover_id\": \"%s\", \"x\": %.2f, \"y\": %.2f, "
+            "\"distance\": %.2f, \"age\": %ld}%s\n",
+            results[i].rover_id,
+            results[i].x,
+            results[i].y,
+            results[i].distance,
+            (long)(now - results[i].last_update),
+            (i + 1 < count) ? "," : "");
+    }
+    
+    if (len < buf_size) {
+        len += snprintf(buffer + len, buf_size - len, "  ]\n}\n");
+    }
+}
+
 void generate_rover_status_json(char *buffer, size_t buf_size,
-                                RoverSession *rover) {
+                                const RoverView *rover) {
     if (!buffer || !rover) return;
     
+    const RoverSession *link = &rover->link;
     time_t now = time(NULL);
-    time_t time_since = now - rover->last_update;
+    time_t time_since = rover->has_link ? now - link->last_update : -1;
+    
+    char addr_str[INET_ADDRSTRLEN] = "none";
+    if (rover->has_link) inet_ntop(AF_INET, &link->addr.sin_addr, addr_str, sizeof(addr_str));
+    
+    // Telemetria da mesma entidade: posição e estado ao vivo, se houver
+    char telemetry_json[256];
+    if (rover->has_telemetry) {
+        snprintf(telemetry_json, sizeof(telemetry_json),
+            "{\"position\": {\"x\": %.2f, \"y\": %.2f}, \"state\": \"%s\", "
+            "\"last_update_ago\": %ld}",
+            rover->telemetry.last_position_x,
+            rover->telemetry.last_position_y,
+            get_rover_state_name(rover->telemetry.last_state),
+            (long)(now - rover->telemetry.last_update));
+    } else {
+        snprintf(telemetry_json, sizeof(telemetry_json), "null");
+    }
+    
+    // Tendências de saúde já calculadas à chegada da telemetria (O(1))
+    const RoverHealthSummary *health = &rover->health;
+    static const struct { uint32_t bit; const char *name; } alert_names[] = {
+        {HEALTH_ALERT_BATTERY_DRAIN, "battery_drain"},
+        {HEALTH_ALERT_BATTERY_LOW, "battery_low"},
+        {HEALTH_ALERT_TEMPERATURE_RISE, "temperature_rise"},
+        {HEALTH_ALERT_SIGNAL_DROP, "signal_degrading"}
+    };
+    char alerts_json[128];
+    int alen = snprintf(alerts_json, sizeof(alerts_json), "[");
+    for (size_t i = 0; i < sizeof(alert_names) / sizeof(alert_names[0]); i++) {
+        if (!(health->alerts & alert_names[i].bit)) continue;
+        alen += snprintf(alerts_json + alen, sizeof(alerts_json) - alen, "%s\"%s\"",
+                         (alen > 1) ? ", " : "", alert_names[i].name);
+    }
+    snprintf(alerts_json + alen, sizeof(alerts_json) - alen, "]");
+    
+    char health_json[512];
+    if (health->samples > 0) {
+        snprintf(health_json, sizeof(health_json),
+            "{\"samples\": %llu, "
+            "\"battery\": {\"ewma\": %.2f, \"slope_per_min\": %.3f}, "
+            "\"temperature\": {\"ewma\": %.2f, \"slope_per_min\": %.3f}, "
+            "\"signal\": {\"ewma\": %.2f, \"slope_per_min\": %.3f}, "
+            "\"window\": {\"samples\": %u, \"seconds\": %u}, "
+            "\"alerts\": %s}",
+            (unsigned long long)health->samples,
+            health->battery_ewma, health->battery_slope,
+            health->temperature_ewma, health->temperature_slope,
+            health->signal_ewma, health->signal_slope,
+            health->window_samples, health->window_seconds,
+            alerts_json);
+    } else {
+        snprintf(health_json, sizeof(health_json), "null");
+    }
     
     snprintf(buffer, buf_size,
         "{\n"
@@ -202,19 +408,46 @@ void generate_rover_status_json(char *buffer, size_t buf_size,
         "    \"current_task\": \"%s\",\n"
         "    \"last_sequence\": %u,\n"
         "    \"last_update_ago\": %ld,\n"
-        "    \"address\": \"%s:%d\"\n"
+        "    \"address\": \"%s:%d\",\n"
+        "    \"heartbeat\": {\"healthy\": %s, \"waiting_for_pong\": %s, "
+        "\"rtt_ms\": %.3f, \"srtt_ms\": %.3f, \"rtt_samples\": %llu},\n"
+        "    \"link\": {\"rtt_ms\": %.3f, \"srtt_ms\": %.3f, \"rttvar_ms\": %.3f, "
+        "\"rto_ms\": %u, \"rtt_samples\": %llu, \"sent\": %llu, \"retransmitted\": %llu, "
+        "\"acked\": %llu, \"resets\": %llu, \"delivered\": %llu, "
+        "\"retransmissions_received\": %llu, \"out_of_order\": %llu},\n"
+        "    \"telemetry\": %s,\n"
+        "    \"health\": %s\n"
         "  }\n"
         "}\n",
         rover->rover_id,
-        (time_since < 35) ? "active" : "inactive",
+        (rover->has_link && link->active && !rover->heartbeat.expired) ? "active" : "inactive",
         rover->battery,
-        rover->progress,
-        rover->mission_id[0] ? rover->mission_id : "none",
-        rover->task_type[0] ? rover->task_type : "none",
-        rover->last_seq,
-        time_since,
-        inet_ntoa(rover->addr.sin_addr),
-        ntohs(rover->addr.sin_port));
+        link->progress,
+        link->mission_id[0] ? link->mission_id : "none",
+        link->task_type[0] ? link->task_type : "none",
+        link->last_seq,
+        (long)time_since,
+        addr_str,
+        ntohs(link->addr.sin_port),
+        rover->heartbeat.is_healthy ? "true" : "false",
+        rover->heartbeat.waiting_for_pong ? "true" : "false",
+        rover->heartbeat.rtt.last_rtt_ms,
+        rover->heartbeat.rtt.srtt_ms,
+        (unsigned long long)rover->heartbeat.rtt.samples,
+        rover->link_rtt.last_rtt_ms,
+        rover->link_rtt.srtt_ms,
+        rover->link_rtt.rttvar_ms,
+        rover->link_rtt.rto_ms,
+        (unsigned long long)rover->link_rtt.samples,
+        (unsigned long long)rover->link_sent,
+        (unsigned long long)rover->link_retransmitted,
+        (unsigned long long)rover->link_acked,
+        (unsigned long long)rover->link_resets,
+        (unsigned long long)rover->link_stats.delivered,
+        (unsigned long long)rover->link_stats.duplicates,
+        (unsigned long long)rover->link_stats.out_of_order,
+        telemetry_json,
+        health_json);
 }
 
 void generate_missions_list_json(char *buffer, size_t buf_size,
@@ -254,7 +487,7 @@ void generate_missions_list_json(char *buffer, size_t buf_size,
             missions[i].task_type,
             missions[i].progress,
             missions[i].battery,
-            missions[i].completed ? "completed" : "in_progress",
+            get_mission_status_name(missions[i].status),
             missions[i].x1, missions[i].y1, missions[i].x2, missions[i].y2,
             missions[i].duration,
             start_time,
@@ -302,7 +535,7 @@ void generate_mission_status_json(char *buffer, size_t buf_size,
         mission->task_type,
         mission->progress,
         mission->battery,
-        mission->completed ? "completed" : "in_progress",
+        get_mission_status_name(mission->status),
         mission->x1, mission->y1, mission->x2, mission->y2,
         mission->duration,
         start_time,
@@ -310,8 +543,8 @@ void generate_mission_status_json(char *buffer, size_t buf_size,
 }
 
 void generate_telemetry_latest_json(char *buffer, size_t buf_size,
-                                    TelemetrySession *telemetry, int num_telemetry) {
-    if (!buffer || !telemetry) {
+                                    const RoverView *rovers, int num_rovers) {
+    if (!buffer || !rovers) {
         snprintf(buffer, buf_size, "{\"telemetry\": []}\n");
         return;
     }
@@ -322,11 +555,12 @@ void generate_telemetry_latest_json(char *buffer, size_t buf_size,
     int first = 1;
     int count = 0;
     
-    for (int i = 0; i < num_telemetry; i++) {
-        if (!telemetry[i].active) continue;
+    for (int i = 0; i < num_rovers; i++) {
+        const TelemetrySession *t = &rovers[i].telemetry;
+        if (!rovers[i].has_telemetry) continue;
         
         time_t now = time(NULL);
-        time_t time_since = now - telemetry[i].last_update;
+        time_t time_since = now - t->last_update;
         
         if (!first) len += snprintf(buffer + len, buf_size - len, ",\n");
         
@@ -340,13 +574,13 @@ void generate_telemetry_latest_json(char *buffer, size_t buf_size,
             "      \"state\": \"%s\",\n"
             "      \"last_update_ago\": %ld\n"
             "    }",
-            telemetry[i].rover_id,
-            telemetry[i].last_position_x,
-            telemetry[i].last_position_y,
-            telemetry[i].last_battery,
-            telemetry[i].last_temperature,
-            telemetry[i].last_signal_strength,
-            get_rover_state_name(telemetry[i].last_state),
+            t->rover_id,
+            t->last_position_x,
+            t->last_position_y,
+            t->last_battery,
+            t->last_temperature,
+            t->last_signal_strength,
+            get_rover_state_name(t->last_state),
             time_since);
         
         first = 0;
@@ -360,11 +594,13 @@ void generate_telemetry_latest_json(char *buffer, size_t buf_size,
 }
 
 void generate_telemetry_rover_json(char *buffer, size_t buf_size,
-                                   TelemetrySession *telemetry) {
+                                   const TelemetrySession *telemetry) {
     if (!buffer || !telemetry) return;
     
     time_t now = time(NULL);
     time_t time_since = now - telemetry->last_update;
+    uint64_t udp_expected = telemetry->udp_received + telemetry->udp_lost;
+    double udp_loss_rate = udp_expected ? (double)telemetry->udp_lost / (double)udp_expected : 0.0;
     
     snprintf(buffer, buf_size,
         "{\n"
@@ -378,7 +614,16 @@ void generate_telemetry_rover_json(char *buffer, size_t buf_size,
         "    \"temperature\": %.1f,\n"
         "    \"signal_strength\": %u,\n"
         "    \"state\": \"%s\",\n"
-        "    \"last_update_ago\": %ld\n"
+        "    \"last_update_ago\": %ld,\n"
+        "    \"stream_version\": %u,\n"
+        "    \"sample_interval_ms\": %u,\n"
+        "    \"udp\": {\n"
+        "      \"active\": %s,\n"
+        "      \"received\": %llu,\n"
+        "      \"lost\": %llu,\n"
+        "      \"stale\": %llu,\n"
+        "      \"loss_rate\": %.4f\n"
+        "    }\n"
         "  }\n"
         "}\n",
         telemetry->rover_id,
@@ -388,39 +633,240 @@ void generate_telemetry_rover_json(char *buffer, size_t buf_size,
         telemetry->last_temperature,
         telemetry->last_signal_strength,
         get_rover_state_name(telemetry->last_state),
-        time_since);
+        time_since,
+        telemetry->version ? telemetry->version : 1,
+        telemetry->rate_interval_ms ? telemetry->rate_interval_ms : TELEMETRY_SAMPLE_INTERVAL_MS,
+        telemetry->udp_active ? "true" : "false",
+        (unsigned long long)telemetry->udp_received,
+        (unsigned long long)telemetry->udp_lost,
+        (unsigned long long)telemetry->udp_stale,
+        udp_loss_rate);
+}
+
+void generate_telemetry_history_json(char *buffer, size_t buf_size,
+                                     const char *rover_id, const char *source,
+                                     TelemetrySample *samples, size_t count,
+                                     uint32_t from, uint32_t to, uint32_t step,
+                                     int truncated) {
+    if (!buffer || !rover_id) return;
+    
+    size_t len = 0;
+    len += snprintf(buffer + len, buf_size - len,
+        "{\n"
+        "  \"rover_id\": \"%s\",\n"
+        "  \"source\": \"%s\",\n"
+        "  \"from\": %u,\n"
+        "  \"to\": %u,\n"
+        "  \"step\": %u,\n"
+        "  \"count\": %zu,\n"
+        "  \"truncated\": %s,\n"
+        "  \"samples\": [\n",
+        rover_id, source ? source : "memory", from, to, step, count,
+        truncated ? "true" : "false");
+    
+    for (size_t i = 0; i < count && len < buf_size; i++) {
+        len += snprintf(buffer + len, buf_size - len,
+            "    {\"t\": %u, \"ms\": %u, \"x\": %.2f, \"y\": %.2f, \"battery\": %u, "
+            "\"temperature\": %.1f, \"signal_strength\": %u, \"state\": \"%s\"}%s\n",
+            samples[i].timestamp,
+            samples[i].timestamp_ms,
+            samples[i].position_x,
+            samples[i].position_y,
+            samples[i].battery,
+            samples[i].temperature,
+            samples[i].signal_strength,
+            get_rover_state_name(samples[i].state),
+            (i + 1 < count) ? "," : "");
+    }
+    
+    if (len < buf_size) {
+        len += snprintf(buffer + len, buf_size - len, "  ]\n}\n");
+    }
+    
+    print_timestamp();
+    printf("[API] History JSON: %s, %zu amostras, %zu bytes\n", rover_id, count, len);
+}
+
+void generate_telemetry_rollup_json(char *buffer, size_t buf_size,
+                                    const char *rover_id, uint32_t resolution,
+                                    RollupBucket *buckets, size_t count,
+                                    uint32_t from, uint32_t to, uint32_t step,
+                                    int truncated) {
+    if (!buffer || !rover_id) return;
+    
+    size_t len = 0;
+    len += snprintf(buffer + len, buf_size - len,
+        "{\n"
+        "  \"rover_id\": \"%s\",\n"
+        "  \"source\": \"rollup\",\n"
+        "  \"resolution\": %u,\n"
+        "  \"from\": %u,\n"
+        "  \"to\": %u,\n"
+        "  \"step\": %u,\n"
+        "  \"count\": %zu,\n"
+        "  \"truncated\": %s,\n"
+        "  \"buckets\": [\n",
+        rover_id, resolution, from, to, step, count,
+        truncated ? "true" : "false");
+    
+    // Métricas no formato [min, max, média, último]
+    for (size_t i = 0; i < count && len < buf_size; i++) {
+        RollupBucket *b = &buckets[i];
+        double n = b->count ? (double)b->count : 1.0;
+        len += snprintf(buffer + len, buf_size - len,
+            "    {\"t\": %u, \"n\": %u, "
+            "\"battery\": [%.0f, %.0f, %.1f, %.0f], "
+            "\"temperature\": [%.1f, %.1f, %.1f, %.1f], "
+            "\"signal_strength\": [%.0f, %.0f, %.1f, %.0f], "
+            "\"bbox\": [%.2f, %.2f, %.2f, %.2f], \"state\": \"%s\"}%s\n",
+            b->start, b->count,
+            b->battery.min, b->battery.max, b->battery.sum / n, b->battery.last,
+            b->temperature.min, b->temperature.max, b->temperature.sum / n, b->temperature.last,
+            b->signal_strength.min, b->signal_strength.max, b->signal_strength.sum / n,
+            b->signal_strength.last,
+            b->min_x, b->min_y, b->max_x, b->max_y,
+            get_rover_state_name(b->last_state),
+            (i + 1 < count) ? "," : "");
+    }
+    
+    if (len < buf_size) {
+        len += snprintf(buffer + len, buf_size - len, "  ]\n}\n");
+    }
+    
+    print_timestamp();
+    printf("[API] Rollup JSON: %s, %zu intervalos de %u s, %zu bytes\n",
+           rover_id, count, step, len);
+}
+
+void generate_events_json(char *buffer, size_t buf_size, uint64_t since) {
+    if (!buffer) return;
+
+    Event events[EVENT_QUERY_MAX];
+    uint64_t next = since;
+    int dropped = 0;
+    size_t count = event_log_read(since, events, EVENT_QUERY_MAX, &next, &dropped);
+
+    size_t len = 0;
+    len += snprintf(buffer + len, buf_size - len,
+        "{\n"
+        "  \"since\": %llu,\n"
+        "  \"next\": %llu,\n"
+        "  \"dropped\": %s,\n"
+        "  \"count\": %zu,\n"
+        "  \"events\": [\n",
+        (unsigned long long)since, (unsigned long long)next,
+        dropped ? "true" : "false", count);
+
+    for (size_t i = 0; i < count && len < buf_size; i++) {
+        len += snprintf(buffer + len, buf_size - len,
+            "    {\"id\": %llu, \"timestamp\": %ld, \"level\": \"%s\", "
+            "\"rover_id\": \"%s\", \"type\": \"%s\", \"message\": \"%s\"}%s\n",
+            (unsigned long long)events[i].id,
+            (long)events[i].timestamp,
+            event_level_name(events[i].level),
+            events[i].rover_id,
+            events[i].type,
+            events[i].message,
+            (i + 1 < count) ? "," : "");
+    }
+
+    if (len < buf_size) {
+        len += snprintf(buffer + len, buf_size - len, "  ]\n}\n");
+    }
+}
+
+void generate_results_list_json(char *buffer, size_t buf_size,
+                                const ResultInfo *results, size_t count, int truncated) {
+    if (!buffer) return;
+
+    size_t len = 0;
+    len += snprintf(buffer + len, buf_size - len,
+        "{\n"
+        "  \"count\": %zu,\n"
+        "  \"truncated\": %s,\n"
+        "  \"results\": [\n",
+        count, truncated ? "true" : "false");
+
+    for (size_t i = 0; i < count && len < buf_size; i++) {
+        char modified[32], url[192];
+        format_timestamp((uint32_t)results[i].modified, modified, sizeof(modified));
+        // Transferências a meio (.part) ainda não se podem descarregar
+        if (results[i].partial) {
+            snprintf(url, sizeof(url), "null");
+        } else {
+            snprintf(url, sizeof(url), "\"/api/results/%s\"", results[i].name);
+        }
+        len += snprintf(buffer + len, buf_size - len,
+            "    {\"name\": \"%s\", \"size\": %llu, \"modified\": \"%s\", "
+            "\"complete\": %s, \"url\": %s}%s\n",
+            results[i].name,
+            (unsigned long long)results[i].size,
+            modified,
+            results[i].partial ? "false" : "true",
+            url,
+            (i + 1 < count) ? "," : "");
+    }
+
+    if (len < buf_size) {
+        len += snprintf(buffer + len, buf_size - len, "  ]\n}\n");
+    }
 }
 
 void generate_system_status_json(char *buffer, size_t buf_size,
-                                 RoverSession *rovers, int num_rovers,
-                                 MissionRecord *missions, int num_missions,
-                                 TelemetrySession *telemetry, int num_telemetry) {
+                                 const RoverView *rovers, int num_rovers,
+                                 MissionRecord *missions, int num_missions) {
     if (!buffer) return;
     
-    int active_rovers = 0, active_missions = 0, active_telemetry = 0;
+    int linked_rovers = 0, active_rovers = 0;
+    int mission_counts[MISSION_REVOKED + 1] = {0};
+    int num_telemetry = 0, active_telemetry = 0;
     
-    if (rovers) {
-        for (int i = 0; i < num_rovers; i++) {
-            if (rovers[i].active && (time(NULL) - rovers[i].last_update) < 35) {
+    for (int i = 0; rovers && i < num_rovers; i++) {
+        if (rovers[i].has_link) {
+            linked_rovers++;
+            if (rovers[i].link.active && !rovers[i].heartbeat.expired) {
                 active_rovers++;
             }
         }
+        if (rovers[i].has_telemetry) num_telemetry++;
     }
     
     if (missions) {
         for (int i = 0; i < num_missions; i++) {
-            if (!missions[i].completed) active_missions++;
+            if (missions[i].status <= MISSION_REVOKED) mission_counts[missions[i].status]++;
         }
     }
     
-    if (telemetry) {
-        for (int i = 0; i < num_telemetry; i++) {
-            if (telemetry[i].active && (time(NULL) - telemetry[i].last_update) < 10) {
-                active_telemetry++;
-            }
+    // Colunas da frota (sessões ativas) para os kernels de agregação
+    float fleet_x[MAX_TELEMETRY_CONNECTIONS], fleet_y[MAX_TELEMETRY_CONNECTIONS];
+    float fleet_temperature[MAX_TELEMETRY_CONNECTIONS];
+    uint8_t fleet_battery[MAX_TELEMETRY_CONNECTIONS], fleet_signal[MAX_TELEMETRY_CONNECTIONS];
+    
+    for (int i = 0; rovers && i < num_rovers && active_telemetry < MAX_TELEMETRY_CONNECTIONS; i++) {
+        const TelemetrySession *t = &rovers[i].telemetry;
+        if (rovers[i].has_telemetry && (time(NULL) - t->last_update) < 10) {
+            fleet_x[active_telemetry] = t->last_position_x;
+            fleet_y[active_telemetry] = t->last_position_y;
+            fleet_temperature[active_telemetry] = t->last_temperature;
+            fleet_battery[active_telemetry] = rovers[i].battery;
+            fleet_signal[active_telemetry] = t->last_signal_strength;
+            active_telemetry++;
         }
     }
     
+    const TelemetryKernels *k = telemetry_kernels();
+    size_t n = (size_t)active_telemetry;
+    uint8_t battery_min, battery_max;
+    float min_x, max_x, min_y, max_y;
+    k->minmax_u8(fleet_battery, n, &battery_min, &battery_max);
+    k->minmax_f32(fleet_x, n, &min_x, &max_x);
+    k->minmax_f32(fleet_y, n, &min_y, &max_y);
+    double mean_temperature = n ? k->sum_f32(fleet_temperature, n) / (double)n : 0.0;
+    size_t low_signal = k->count_below_u8(fleet_signal, n, API_LOW_SIGNAL_THRESHOLD);
+    
+    TelemetryHistoryStats history;
+    telemetry_history_stats(&history);
+    
     snprintf(buffer, buf_size,
         "{\n"
         "  \"system\": {\n"
@@ -431,23 +877,47 @@ void generate_system_status_json(char *buffer, size_t buf_size,
         "    },\n"
         "    \"missions\": {\n"
         "      \"total\": %d,\n"
+        "      \"reserved\": %d,\n"
         "      \"in_progress\": %d,\n"
-        "      \"completed\": %d\n"
+        "      \"completed\": %d,\n"
+        "      \"revoked\": %d\n"
         "    },\n"
         "    \"telemetry\": {\n"
         "      \"sessions\": %d,\n"
         "      \"active\": %d\n"
+        "    },\n"
+        "    \"fleet\": {\n"
+        "      \"min_battery\": %u,\n"
+        "      \"mean_temperature\": %.1f,\n"
+        "      \"low_signal\": %zu,\n"
+        "      \"bbox\": [%.2f, %.2f, %.2f, %.2f],\n"
+        "      \"kernels\": \"%s\"\n"
+        "    },\n"
+        "    \"history\": {\n"
+        "      \"samples\": %llu,\n"
+        "      \"raw_bytes\": %llu,\n"
+        "      \"stored_bytes\": %llu\n"
         "    }\n"
         "  }\n"
         "}\n",
         time(NULL),
-        num_rovers,
+        linked_rovers,
         active_rovers,
         num_missions,
-        active_missions,
-        (num_missions > 0) ? (num_missions - active_missions) : 0,
+        mission_counts[MISSION_RESERVED],
+        mission_counts[MISSION_ACTIVE],
+        mission_counts[MISSION_COMPLETED],
+        mission_counts[MISSION_REVOKED],
         num_telemetry,
-        active_telemetry);
+        active_telemetry,
+        battery_min,
+        mean_temperature,
+        low_signal,
+        min_x, min_y, max_x, max_y,
+        k->name,
+        (unsigned long long)history.samples,
+        (unsigned long long)history.raw_bytes,
+        (unsigned long long)history.stored_bytes);
 }
 
 // ============ RESPOSTAS HTTP ============
@@ -461,7 +931,8 @@ void send_http_response(int client_fd, int status_code, const char *content_type
     
     const char *status_msg = (status_code == 200) ? "OK" :
                             (status_code == 404) ? "Not Found" :
-                            (status_code == 400) ? "Bad Request" : "Error";
+                            (status_code == 400) ? "Bad Request" :
+                            (status_code == 503) ? "Service Unavailable" : "Error";
     
     len += snprintf(response + len, API_BUFFER_SIZE - len,
         "HTTP/1.1 %d %s\r\n"
@@ -479,12 +950,35 @@ void send_http_response(int client_fd, int status_code, const char *content_type
     send(client_fd, response, strlen(response), 0);
 }
 
+void send_http_file(int client_fd, int file_fd, uint64_t size, const char *content_type,
+                    const char *filename) {
+    if (client_fd < 0 || file_fd < 0) return;
+
+    char header[512];
+    int len = snprintf(header, sizeof(header),
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: %s\r\n"
+        "Content-Length: %llu\r\n"
+        "Content-Disposition: attachment; filename=\"%s\"\r\n"
+        "Access-Control-Allow-Origin: *\r\n"
+        "Connection: close\r\n"
+        "\r\n",
+        content_type, (unsigned long long)size, filename);
+    if (send(client_fd, header, (size_t)len, MSG_NOSIGNAL) != len) return;
+
+    // Corpo direto do ficheiro para o socket
+    off_t offset = 0;
+    while ((uint64_t)offset < size) {
+        ssize_t n = sendfile(client_fd, file_fd, &offset, (size_t)(size - (uint64_t)offset));
+        if (n <= 0) break;
+    }
+}
+
 // ============ PROCESSAMENTO DE REQUISIÇÕES ============
 
 void process_http_request(int client_fd, const char *request,
-                         RoverSession *rovers, int num_rovers,
-                         MissionRecord *missions, int num_missions,
-                         TelemetrySession *telemetry, int num_telemetry) {
+                         const RoverView *rovers, int num_rovers,
+                         MissionRecord *missions, int num_missions) {
     if (client_fd < 0 || !request) return;
     
     char resource_id[256];
@@ -499,19 +993,54 @@ void process_http_request(int client_fd, const char *request,
             send_http_response(client_fd, 200, "application/json", body);
             break;
             
-        case ENDPOINT_ROVER_STATUS: {
-            if (!rovers) {
-                snprintf(body, sizeof(body), "{\"error\": \"No rovers available\"}");
-                send_http_response(client_fd, 404, "application/json", body);
+        case ENDPOINT_ROVERS_BBOX: {
+            char param[128];
+            float x1, y1, x2, y2;
+            if (!get_query_param(request, "bbox", param, sizeof(param)) ||
+                sscanf(param, "%f,%f,%f,%f", &x1, &y1, &x2, &y2) != 4 ||
+                !isfinite(x1) || !isfinite(y1) || !isfinite(x2) || !isfinite(y2)) {
+                snprintf(body, sizeof(body), "{\"error\": \"Expected bbox=x1,y1,x2,y2\"}");
+                send_http_response(client_fd, 400, "application/json", body);
                 break;
             }
-            RoverSession *rover = NULL;
-            for (int i = 0; i < num_rovers; i++) {
-                if (strcmp(rovers[i].rover_id, resource_id) == 0) {
-                    rover = &rovers[i];
-                    break;
-                }
+            SpatialResult results[SPATIAL_MAX_RESULTS];
+            int truncated = 0;
+            size_t count = spatial_index_query_bbox(x1, y1, x2, y2, results,
+                                                    SPATIAL_MAX_RESULTS, &truncated);
+            generate_spatial_json(body, sizeof(body), "bbox", results, count, truncated);
+            send_http_response(client_fd, 200, "application/json", body);
+            break;
+        }
+        
+        case ENDPOINT_ROVERS_NEAREST: {
+            char px[32], py[32], pk[16];
+            float x = NAN, y = NAN;
+            if (get_query_param(request, "x", px, sizeof(px)) &&
+                get_query_param(request, "y", py, sizeof(py))) {
+                x = strtof(px, NULL);
+                y = strtof(py, NULL);
+            }
+            if (!isfinite(x) || !isfinite(y)) {
+                snprintf(body, sizeof(body), "{\"error\": \"Expected x= and y=\"}");
+                send_http_response(client_fd, 400, "application/json", body);
+                break;
+            }
+            size_t k = 1;
+            if (get_query_param(request, "k", pk, sizeof(pk))) {
+                k = (size_t)strtoul(pk, NULL, 10);
             }
+            if (k == 0 || k > SPATIAL_MAX_K) k = (k == 0) ? 1 : SPATIAL_MAX_K;
+            
+            SpatialResult results[SPATIAL_MAX_K];
+            size_t count = spatial_index_nearest(x, y, k, results);
+            generate_spatial_json(body, sizeof(body), "nearest", results, count, 0);
+            send_http_response(client_fd, 200, "application/json", body);
+            break;
+        }
+        
+        case ENDPOINT_ROVER_STATUS: {
+            telemetry_watch_touch(resource_id);
+            const RoverView *rover = rover_view_find(rovers, (size_t)num_rovers, resource_id);
             if (rover) {
                 generate_rover_status_json(body, sizeof(body), rover);
                 send_http_response(client_fd, 200, "application/json", body);
@@ -551,36 +1080,145 @@ void process_http_request(int client_fd, const char *request,
         }
         
         case ENDPOINT_TELEMETRY_LAST:
-            generate_telemetry_latest_json(body, sizeof(body), telemetry, num_telemetry);
+            generate_telemetry_latest_json(body, sizeof(body), rovers, num_rovers);
             send_http_response(client_fd, 200, "application/json", body);
             break;
             
         case ENDPOINT_TELEMETRY_ROVER: {
-            if (!telemetry) {
-                snprintf(body, sizeof(body), "{\"error\": \"No telemetry available\"}");
+            telemetry_watch_touch(resource_id);
+            const RoverView *rover = rover_view_find(rovers, (size_t)num_rovers, resource_id);
+            if (rover && rover->has_telemetry) {
+                generate_telemetry_rover_json(body, sizeof(body), &rover->telemetry);
+                send_http_response(client_fd, 200, "application/json", body);
+            } else {
+                snprintf(body, sizeof(body), "{\"error\": \"Telemetry not found\"}");
                 send_http_response(client_fd, 404, "application/json", body);
+            }
+            break;
+        }
+        
+        case ENDPOINT_TELEMETRY_HISTORY: {
+            telemetry_watch_touch(resource_id);
+            char param[32];
+            uint32_t from = 0, to = UINT32_MAX, step = 0;
+            int has_from = 0;
+            
+            if (get_query_param(request, "from", param, sizeof(param))) {
+                from = (uint32_t)strtoul(param, NULL, 10);
+                has_from = 1;
+            }
+            if (get_query_param(request, "to", param, sizeof(param)))
+                to = (uint32_t)strtoul(param, NULL, 10);
+            if (get_query_param(request, "step", param, sizeof(param)))
+                step = (uint32_t)strtoul(param, NULL, 10);
+            
+            if (from > to) {
+                snprintf(body, sizeof(body), "{\"error\": \"Invalid range (from > to)\"}");
+                send_http_response(client_fd, 400, "application/json", body);
                 break;
             }
-            TelemetrySession *telem = NULL;
-            for (int i = 0; i < num_telemetry; i++) {
-                if (strcmp(telemetry[i].rover_id, resource_id) == 0) {
-                    telem = &telemetry[i];
+            
+            // Passos largos: responder com o nível agregado mais grosso que
+            // não excede o passo pedido, sem percorrer amostras de 1 Hz
+            uint32_t resolution = telemetry_rollup_resolution(step);
+            if (resolution > 0) {
+                RollupBucket buckets[ROLLUP_QUERY_MAX_POINTS];
+                int truncated = 0;
+                int count = telemetry_rollup_query(resource_id, resolution, from, to, step,
+                                                   buckets, ROLLUP_QUERY_MAX_POINTS,
+                                                   &truncated);
+                if (count >= 0) {
+                    generate_telemetry_rollup_json(body, sizeof(body), resource_id,
+                                                   resolution, buckets, (size_t)count,
+                                                   from, to, step, truncated);
+                    send_http_response(client_fd, 200, "application/json", body);
                     break;
                 }
             }
-            if (telem) {
-                generate_telemetry_rover_json(body, sizeof(body), telem);
-                send_http_response(client_fd, 200, "application/json", body);
+            
+            uint32_t oldest = 0;
+            int in_memory = telemetry_history_oldest(resource_id, &oldest);
+            // Sem 'from': o que está em memória (as amostras recentes)
+            if (in_memory && !has_from)
+                from = oldest;
+            if (!in_memory && !telemetry_store_is_open()) {
+                snprintf(body, sizeof(body), "{\"error\": \"History not found\"}");
+                send_http_response(client_fd, 404, "application/json", body);
+                break;
+            }
+            
+            TelemetrySample samples[HISTORY_QUERY_MAX_POINTS];
+            int truncated = 0;
+            size_t count;
+            const char *source;
+            
+            if (in_memory && from >= oldest) {
+                // Intervalo coberto pelo buffer em memória
+                count = telemetry_history_query(resource_id, from, to, step,
+                                                samples, HISTORY_QUERY_MAX_POINTS,
+                                                &truncated);
+                source = "memory";
             } else {
-                snprintf(body, sizeof(body), "{\"error\": \"Telemetry not found\"}");
+                // Intervalo mais antigo: ler diretamente dos segmentos mapeados
+                HistoryDiskQuery q;
+                memset(&q, 0, sizeof(q));
+                q.out = samples;
+                q.max_out = HISTORY_QUERY_MAX_POINTS;
+                q.step = step;
+                telemetry_store_query(resource_id, from, to, history_disk_visit, &q);
+                history_disk_finish(&q);
+                count = q.count;
+                truncated = q.truncated;
+                source = "disk";
+            }
+            
+            if (count == 0 && !in_memory) {
+                snprintf(body, sizeof(body), "{\"error\": \"History not found\"}");
+                send_http_response(client_fd, 404, "application/json", body);
+                break;
+            }
+            
+            generate_telemetry_history_json(body, sizeof(body), resource_id, source,
+                                            samples, count, from, to, step, truncated);
+            send_http_response(client_fd, 200, "application/json", body);
+            break;
+        }
+        
+        case ENDPOINT_EVENTS: {
+            char param[32];
+            uint64_t since = 0;
+            if (get_query_param(request, "since", param, sizeof(param)))
+                since = strtoull(param, NULL, 10);
+            generate_events_json(body, sizeof(body), since);
+            send_http_response(client_fd, 200, "application/json", body);
+            break;
+        }
+        
+        case ENDPOINT_RESULTS_LIST: {
+            ResultInfo results[RESULT_LIST_MAX];
+            int truncated = 0;
+            size_t count = result_list(results, RESULT_LIST_MAX, &truncated);
+            generate_results_list_json(body, sizeof(body), results, count, truncated);
+            send_http_response(client_fd, 200, "application/json", body);
+            break;
+        }
+        
+        case ENDPOINT_RESULT_DOWNLOAD: {
+            uint64_t size = 0;
+            int fd = result_open(resource_id, &size);
+            if (fd < 0) {
+                snprintf(body, sizeof(body), "{\"error\": \"Result not found\"}");
                 send_http_response(client_fd, 404, "application/json", body);
+                break;
             }
+            send_http_file(client_fd, fd, size, result_mime_type(resource_id), resource_id);
+            close(fd);
             break;
         }
         
         case ENDPOINT_SYSTEM_STATUS:
             generate_system_status_json(body, sizeof(body), rovers, num_rovers,
-                                      missions, num_missions, telemetry, num_telemetry);
+                                      missions, num_missions);
             send_http_response(client_fd, 200, "application/json", body);
             break;
             
@@ -590,11 +1228,17 @@ void process_http_request(int client_fd, const char *request,
                 "  \"available_endpoints\": [\n"
                 "    \"GET /api/system/status\",\n"
                 "    \"GET /api/rovers\",\n"
+                "    \"GET /api/rovers?bbox=x1,y1,x2,y2\",\n"
+                "    \"GET /api/rovers/nearest?x=&y=&k=\",\n"
                 "    \"GET /api/rovers/{id}\",\n"
                 "    \"GET /api/missions\",\n"
                 "    \"GET /api/missions/{id}\",\n"
                 "    \"GET /api/telemetry/latest\",\n"
-                "    \"GET /api/telemetry/{rover_id}\"\n"
+                "    \"GET /api/telemetry/{rover_id}\",\n"
+                "    \"GET /api/telemetry/{rover_id}/history?from=&to=&step=\",\n"
+                "    \"GET /api/events?since=N\",\n"
+                "    \"GET /api/results\",\n"
+                "    \"GET /api/results/{name}\"\n"
                 "  ]\n"
                 "}\n");
             send_http_response(client_fd, 404, "application/json", body);
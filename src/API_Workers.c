@@ -0,0 +1,253 @@
+// ============ API_Workers.c ============
+// Pool de threads HTTP com fila lock-free e snapshots imutáveis
+#include "API_Workers.h"
+#include "API_Observation.h"
+#include "MissionLink.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/time.h>
+
+// ============ FILA LOCK-FREE (MPMC LIMITADA) ============
+// Cada célula guarda um número de sequência que indica se está livre para
+// o produtor (seq == pos) ou pronta para o consumidor (seq == pos + 1).
+typedef struct {
+    size_t seq;
+    int fd;
+} APIQueueCell;
+
+#define API_QUEUE_MASK (API_QUEUE_CAPACITY - 1)
+
+static APIQueueCell queue_cells[API_QUEUE_CAPACITY];
+static size_t enqueue_pos = 0;
+static size_t dequeue_pos = 0;
+static sem_t queue_items;           // Apenas para adormecer workers ociosos
+
+static int queue_push(int fd) {
+    size_t pos = __atomic_load_n(&enqueue_pos, __ATOMIC_RELAXED);
+
+    for (;;) {
+        APIQueueCell *cell = &queue_cells[pos & API_QUEUE_MASK];
+        size_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        long diff = (long)seq - (long)pos;
+
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&enqueue_pos, &pos, pos + 1, 0,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                cell->fd = fd;
+                __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+                return 0;
+            }
+        } else if (diff < 0) {
+            return -1;  // Fila cheia
+        } else {
+            pos = __atomic_load_n(&enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static int queue_pop(int *fd) {
+    size_t pos = __atomic_load_n(&dequeue_pos, __ATOMIC_RELAXED);
+
+    for (;;) {
+        APIQueueCell *cell = &queue_cells[pos & API_QUEUE_MASK];
+        size_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        long diff = (long)seq - (long)(pos + 1);
+
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&dequeue_pos, &pos, pos + 1, 0,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                *fd = cell->fd;
+                __atomic_store_n(&cell->seq, pos + API_QUEUE_CAPACITY, __ATOMIC_RELEASE);
+                return 0;
+            }
+        } else if (diff < 0) {
+            return -1;  // Fila vazia
+        } else {
+            pos = __atomic_load_n(&dequeue_pos, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+// ============ SNAPSHOTS ============
+// O publicador só reescreve buffers que não são o atual e não têm leitores.
+// O leitor incrementa refs e confirma que o buffer continua a ser o atual;
+// caso contrário desiste e tenta de novo (o buffer pode estar a ser reescrito).
+static APISnapshot snapshot_buffers[API_SNAPSHOT_BUFFERS];
+static APISnapshot *current_snapshot = NULL;
+static uint64_t snapshot_version = 0;
+
+void api_publish_snapshot(MissionRecord *missions, int num_missions) {
+    APISnapshot *current = __atomic_load_n(&current_snapshot, __ATOMIC_SEQ_CST);
+    APISnapshot *snap = NULL;
+
+    for (int i = 0; i < API_SNAPSHOT_BUFFERS; i++) {
+        if (&snapshot_buffers[i] != current &&
+            __atomic_load_n(&snapshot_buffers[i].refs, __ATOMIC_SEQ_CST) == 0) {
+            snap = &snapshot_buffers[i];
+            break;
+        }
+    }
+
+    // Todos os buffers ocupados: os workers continuam com o snapshot anterior
+    if (!snap) return;
+
+    if (num_missions > MAX_MISSIONS) num_missions = MAX_MISSIONS;
+
+    // Buffer sem leitores: pode crescer à vontade
+    size_t known = rover_registry_count();
+    if (known > snap->rovers_capacity) {
+        RoverView *grown = realloc(snap->rovers, known * sizeof(RoverView));
+        if (grown) {
+            snap->rovers = grown;
+            snap->rovers_capacity = known;
+        }
+    }
+
+    snap->num_rovers = snap->rovers ?
+                       (int)rover_registry_views(snap->rovers, snap->rovers_capacity) : 0;
+    snap->num_missions = missions ? num_missions : 0;
+    if (snap->num_missions > 0)
+        memcpy(snap->missions, missions, sizeof(MissionRecord) * snap->num_missions);
+
+    snap->published_at = time(NULL);
+    snap->version = ++snapshot_version;
+
+    __atomic_store_n(&current_snapshot, snap, __ATOMIC_SEQ_CST);
+}
+
+APISnapshot* api_acquire_snapshot(void) {
+    for (;;) {
+        APISnapshot *snap = __atomic_load_n(&current_snapshot, __ATOMIC_SEQ_CST);
+        if (!snap) return NULL;
+
+        __atomic_add_fetch(&snap->refs, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&current_snapshot, __ATOMIC_SEQ_CST) == snap) {
+            return snap;
+        }
+        __atomic_sub_fetch(&snap->refs, 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+void api_release_snapshot(APISnapshot *snap) {
+    if (!snap) return;
+    __atomic_sub_fetch(&snap->refs, 1, __ATOMIC_SEQ_CST);
+}
+
+// ============ WORKERS ============
+
+static pthread_t worker_threads[API_WORKER_THREADS];
+static int workers_started = 0;
+static int workers_running = 0;
+
+static void handle_http_client(int client_fd) {
+    struct timeval tv = {API_RECV_TIMEOUT_MS / 1000, (API_RECV_TIMEOUT_MS % 1000) * 1000};
+    setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    char request_buf[2048];
+    memset(request_buf, 0, sizeof(request_buf));
+
+    int n = recv(client_fd, request_buf, sizeof(request_buf) - 1, 0);
+    if (n <= 0) {
+        close(client_fd);
+        return;
+    }
+    request_buf[n] = '\0';
+
+    print_timestamp();
+    printf("🌐 HTTP Request recebido (%d bytes)\n", n);
+
+    APISnapshot *snap = api_acquire_snapshot();
+    if (snap) {
+        process_http_request(client_fd, request_buf,
+                             snap->rovers, snap->num_rovers,
+                             snap->missions, snap->num_missions);
+        api_release_snapshot(snap);
+    } else {
+        send_http_response(client_fd, 503, "application/json",
+                           "{\"error\": \"State not yet available\"}");
+    }
+
+    close(client_fd);
+}
+
+static void* api_worker_main(void *arg) {
+    (void)arg;
+
+    while (__atomic_load_n(&workers_running, __ATOMIC_ACQUIRE)) {
+        sem_wait(&queue_items);
+
+        int client_fd;
+        while (queue_pop(&client_fd) == 0) {
+            handle_http_client(client_fd);
+        }
+    }
+    return NULL;
+}
+
+int api_workers_start(void) {
+    for (size_t i = 0; i < API_QUEUE_CAPACITY; i++) {
+        queue_cells[i].seq = i;
+        queue_cells[i].fd = -1;
+    }
+    enqueue_pos = 0;
+    dequeue_pos = 0;
+
+    if (sem_init(&queue_items, 0, 0) < 0) {
+        perror("sem_init API");
+        return -1;
+    }
+
+    __atomic_store_n(&workers_running, 1, __ATOMIC_RELEASE);
+
+    for (int i = 0; i < API_WORKER_THREADS; i++) {
+        if (pthread_create(&worker_threads[i], NULL, api_worker_main, NULL) != 0) {
+            perror("pthread_create API");
+            api_workers_stop();
+            return -1;
+        }
+        workers_started++;
+    }
+
+    print_timestamp();
+    printf("🧵 Pool HTTP iniciado: %d workers, fila de %d conexões\n\n",
+           API_WORKER_THREADS, API_QUEUE_CAPACITY);
+    return 0;
+}
+
+void api_workers_stop(void) {
+    __atomic_store_n(&workers_running, 0, __ATOMIC_RELEASE);
+
+    for (int i = 0; i < workers_started; i++) {
+        sem_post(&queue_items);
+    }
+    for (int i = 0; i < workers_started; i++) {
+        pthread_join(worker_threads[i], NULL);
+    }
+    workers_started = 0;
+
+    int client_fd;
+    while (queue_pop(&client_fd) == 0) {
+        close(client_fd);
+    }
+    sem_destroy(&queue_items);
+
+    // Sem workers, nenhum snapshot tem leitores
+    __atomic_store_n(&current_snapshot, NULL, __ATOMIC_SEQ_CST);
+    for (int i = 0; i < API_SNAPSHOT_BUFFERS; i++) {
+        free(snapshot_buffers[i].rovers);
+        snapshot_buffers[i].rovers = NULL;
+        snapshot_buffers[i].rovers_capacity = 0;
+    }
+}
+
+int api_workers_submit(int client_fd) {
+    if (queue_push(client_fd) < 0) {
+        return -1;
+    }
+    sem_post(&queue_items);
+    return 0;
+}
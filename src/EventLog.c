@@ -0,0 +1,71 @@
+// ============ EventLog.c ============
+// Implementação do stream de eventos
+#include "EventLog.h"
+#include "MissionLink.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <pthread.h>
+
+#define EVENT_LOG_MASK (EVENT_LOG_CAPACITY - 1)
+
+static Event events[EVENT_LOG_CAPACITY];
+static uint64_t last_id = 0;
+static pthread_mutex_t event_lock = PTHREAD_MUTEX_INITIALIZER;
+
+const char* event_level_name(uint8_t level) {
+    switch (level) {
+        case EVENT_WARNING:  return "warning";
+        case EVENT_CRITICAL: return "critical";
+        default:             return "info";
+    }
+}
+
+uint64_t event_log_emit(EventLevel level, const char *rover_id, const char *type,
+                        const char *fmt, ...) {
+    Event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.timestamp = time(NULL);
+    ev.level = (uint8_t)level;
+    if (rover_id) strncpy(ev.rover_id, rover_id, sizeof(ev.rover_id) - 1);
+    if (type) strncpy(ev.type, type, sizeof(ev.type) - 1);
+
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(ev.message, sizeof(ev.message), fmt, ap);
+    va_end(ap);
+
+    pthread_mutex_lock(&event_lock);
+    ev.id = ++last_id;
+    events[(ev.id - 1) & EVENT_LOG_MASK] = ev;
+    pthread_mutex_unlock(&event_lock);
+
+    const char *icon = (level == EVENT_CRITICAL) ? "🚨" : (level == EVENT_WARNING) ? "⚠ " : "ℹ ";
+    print_timestamp();
+    printf("%s [EVENT #%llu] %s %s: %s\n\n", icon, (unsigned long long)ev.id,
+           ev.rover_id, ev.type, ev.message);
+    return ev.id;
+}
+
+size_t event_log_read(uint64_t since, Event *out, size_t max_out,
+                      uint64_t *next, int *dropped) {
+    size_t n = 0;
+    if (dropped) *dropped = 0;
+
+    pthread_mutex_lock(&event_lock);
+
+    uint64_t oldest = (last_id > EVENT_LOG_CAPACITY) ? last_id - EVENT_LOG_CAPACITY + 1 : 1;
+    uint64_t id = since + 1;
+    if (id < oldest) {
+        if (dropped && last_id > 0) *dropped = 1;
+        id = oldest;
+    }
+
+    for (; id <= last_id && n < max_out; id++) {
+        out[n++] = events[(id - 1) & EVENT_LOG_MASK];
+    }
+    if (next) *next = id - 1;
+
+    pthread_mutex_unlock(&event_lock);
+    return n;
+}
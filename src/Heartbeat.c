@@ -1,7 +1,9 @@
 // ============ Heartbeat.c (COMPLETO) ============
 // Sistema de heartbeat com detecção adequada de rovers inativos
 #include "Heartbeat.h"
+#include "RoverRegistry.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <arpa/inet.h>
@@ -9,111 +11,178 @@
 
 // ============ SERVIDOR (NAVE-MÃE) ============
 
-// Verificar e enviar PING para rovers
-void check_and_send_heartbeats(int sockfd, RoverSession *sessions, int num_rovers) {
-    time_t now = time(NULL);
+static TimerWheel *hb_wheel = NULL;
+static int hb_sockfd = -1;
+static HeartbeatInactiveFn hb_on_inactive = NULL;
+
+static void on_ping_timer(Timer *timer, void *arg);
+static void on_pong_timer(Timer *timer, void *arg);
+static void on_expiry_timer(Timer *timer, void *arg);
+
+void heartbeat_init(TimerWheel *wheel, int sockfd, HeartbeatInactiveFn on_inactive) {
+    hb_wheel = wheel;
+    hb_sockfd = sockfd;
+    hb_on_inactive = on_inactive;
+}
+
+static void arm_in(Timer *timer, uint64_t delay_ms) {
+    if (hb_wheel) timer_arm(hb_wheel, timer, arq_now_ms() + delay_ms);
+}
+
+static void disarm(Timer *timer) {
+    if (hb_wheel) timer_cancel(hb_wheel, timer);
+}
+
+// Enviar PING (retry: repetição depois de um timeout, sem amostra de RTT)
+static void send_ping(RoverEntity *rover, int retry) {
+    RoverSession *link = &rover->link;
+    HeartbeatState *hb = &rover->heartbeat;
     
-    for (int i = 0; i < num_rovers; i++) {
-        if (!sessions[i].active) continue;
-        
-        // ===== VERIFICAR TIMEOUT DE PONG =====
-        // Se estávamos à espera de PONG e passou muito tempo
-        if (sessions[i].waiting_for_pong) {
-            time_t time_since_ping = now - sessions[i].last_ping_sent;
-            
-            if (time_since_ping > HEARTBEAT_TIMEOUT) {
-                sessions[i].consecutive_missed_pongs++;
-                
-                print_timestamp();
-                printf("⏱️  TIMEOUT de PONG de %s (tentativa %d/%d)\n",
-                       sessions[i].rover_id,
-                       sessions[i].consecutive_missed_pongs,
-                       HEARTBEAT_MAX_RETRIES);
-                
-                // Se excedeu retentativas, marcar como inativo
-                if (sessions[i].consecutive_missed_pongs > HEARTBEAT_MAX_RETRIES) {
-                    sessions[i].active = 0;
-                    print_timestamp();
-                    printf("💀 Rover %s marcado como INATIVO (sem resposta)\n\n",
-                           sessions[i].rover_id);
-                } else {
-                    // Tentar enviar novo PING
-                    sessions[i].waiting_for_pong = 0;
-                }
-            } else {
-                // Ainda aguardando, não fazer nada
-                continue;
-            }
-        }
+    print_timestamp();
+    printf("💓 Enviando PING para %s (verificação de saúde)...\n",
+           rover->rover_id);
+    
+    // Preparar pacote PING
+    Packet ping;
+    memset(&ping, 0, sizeof(ping));
+    ping.type = PKT_PING;
+    ping.seq = link->last_seq + 1;
+    ping.conn_id = rover->conn_id;
+    snprintf(ping.rover_id, sizeof(ping.rover_id), "%s", rover->rover_id);
+    
+    // Enviar PING
+    ssize_t sent = ml_wire_send(hb_sockfd, &ping, &link->addr);
+    
+    if (sent > 0) {
+        // Marcar que estamos à espera de PONG
+        hb->waiting_for_pong = 1;
+        hb->last_ping_sent = time(NULL);
+        hb->ping_seq = ping.seq;
+        hb->ping_sent_us = retry ? 0 : arq_now_us();
+        arm_in(&hb->pong_timer, HEARTBEAT_TIMEOUT * 1000);
         
-        // ===== ENVIAR NOVO PING =====
-        // Se não estamos à espera de PONG, verificar se é hora de enviar
-        if (!sessions[i].waiting_for_pong) {
-            time_t time_since_last_update = now - sessions[i].last_update;
-            
-            // Enviar PING a cada HEARTBEAT_INTERVAL segundos
-            if (time_since_last_update >= HEARTBEAT_INTERVAL) {
-                print_timestamp();
-                printf("💓 Enviando PING para %s (verificação de saúde)...\n",
-                       sessions[i].rover_id);
-                
-                // Preparar pacote PING
-                Packet ping;
-                memset(&ping, 0, sizeof(ping));
-                ping.type = PKT_PING;
-                ping.seq = sessions[i].last_seq + 1;
-                strncpy(ping.rover_id, sessions[i].rover_id, sizeof(ping.rover_id) - 1);
-                
-                // Enviar PING
-                ssize_t sent = sendto(sockfd, &ping, sizeof(ping), 0,
-                                     (struct sockaddr *)&sessions[i].addr,
-                                     sizeof(sessions[i].addr));
-                
-                if (sent > 0) {
-                    // Marcar que estamos à espera de PONG
-                    sessions[i].waiting_for_pong = 1;
-                    sessions[i].last_ping_sent = now;
-                    
-                    print_timestamp();
-                    printf("   ✓ PING enviado\n");
-                } else {
-                    print_timestamp();
-                    printf("   ✗ Erro ao enviar PING\n");
-                }
-            }
-        }
+        print_timestamp();
+        printf("   ✓ PING enviado\n");
+    } else {
+        print_timestamp();
+        printf("   ✗ Erro ao enviar PING\n");
+    }
+}
+
+// PING a cada HEARTBEAT_INTERVAL, também para rovers ativos (mantém a
+// medição de RTT atualizada)
+static void on_ping_timer(Timer *timer, void *arg) {
+    RoverEntity *rover = arg;
+    (void)timer;
+    if (!rover->link.active) return;   // Inativo: retoma quando voltar a falar
+    
+    arm_in(&rover->heartbeat.ping_timer, HEARTBEAT_INTERVAL * 1000);
+    
+    // À espera de PONG: o timeout trata das repetições
+    if (!rover->heartbeat.waiting_for_pong) {
+        send_ping(rover, 0);
+    }
+}
+
+static void on_pong_timer(Timer *timer, void *arg) {
+    RoverEntity *rover = arg;
+    HeartbeatState *hb = &rover->heartbeat;
+    (void)timer;
+    
+    hb->consecutive_missed_pongs++;
+    
+    print_timestamp();
+    printf("⏱️  TIMEOUT de PONG de %s (tentativa %d/%d)\n",
+           rover->rover_id,
+           hb->consecutive_missed_pongs,
+           HEARTBEAT_MAX_RETRIES);
+    
+    // Se excedeu retentativas, marcar como inativo; senão, novo PING já
+    if (hb->consecutive_missed_pongs > HEARTBEAT_MAX_RETRIES) {
+        mark_rover_inactive(rover);
+    } else {
+        hb->waiting_for_pong = 0;
+        send_ping(rover, 1);
+    }
+}
+
+static void on_expiry_timer(Timer *timer, void *arg) {
+    RoverEntity *rover = arg;
+    (void)timer;
+    rover->heartbeat.expired = 1;
+    
+    print_timestamp();
+    printf("⌛ %s sem atividade há %d s\n\n", rover->rover_id, ROVER_EXPIRY_TIMEOUT);
+}
+
+// Agendar os eventos de um rover novo (primeiro PING espalhado por um
+// segundo, para uma frota que liga ao mesmo tempo não receber PINGs em rajada)
+void heartbeat_start(RoverEntity *rover) {
+    HeartbeatState *hb = &rover->heartbeat;
+    timer_init(&hb->ping_timer, on_ping_timer, rover);
+    timer_init(&hb->pong_timer, on_pong_timer, rover);
+    timer_init(&hb->expiry_timer, on_expiry_timer, rover);
+    
+    arm_in(&hb->ping_timer, HEARTBEAT_INTERVAL * 1000 + (uint64_t)(rand() % 1000));
+    arm_in(&hb->expiry_timer, ROVER_EXPIRY_TIMEOUT * 1000);
+}
+
+// Registar atividade do rover
+void heartbeat_seen(RoverEntity *rover) {
+    HeartbeatState *hb = &rover->heartbeat;
+    hb->last_pong_received = time(NULL);
+    hb->consecutive_missed_pongs = 0;
+    hb->is_healthy = 1;
+    hb->expired = 0;
+    rover->link.active = 1;
+    
+    if (!hb->expiry_timer.fn) return;  // Ainda sem heartbeat_start
+    arm_in(&hb->expiry_timer, ROVER_EXPIRY_TIMEOUT * 1000);
+    if (!timer_armed(&hb->ping_timer)) {
+        arm_in(&hb->ping_timer, HEARTBEAT_INTERVAL * 1000);
     }
 }
 
 // Processar PONG recebido
-void process_pong(RoverSession *rover, HeartbeatState *heartbeat) {
-    heartbeat->last_pong_received = time(NULL);
-    heartbeat->consecutive_missed_pongs = 0;
-    heartbeat->is_healthy = 1;
-    rover->active = 1;
-    rover->waiting_for_pong = 0;  // Deixou de esperar
-    rover->last_update = time(NULL);
+void process_pong(RoverEntity *rover, const PacketView *pong) {
+    HeartbeatState *hb = &rover->heartbeat;
+    
+    // Karn: só PINGs não repetidos dão amostras de RTT
+    if (hb->waiting_for_pong && hb->ping_sent_us && ml_view_seq(pong) == hb->ping_seq) {
+        arq_rtt_sample(&hb->rtt, (double)(arq_now_us() - hb->ping_sent_us) / 1000.0);
+    }
+    hb->ping_sent_us = 0;
+    disarm(&hb->pong_timer);
+    
+    rover->link.last_update = time(NULL);
+    heartbeat_seen(rover);
+    rover->heartbeat.waiting_for_pong = 0;  // Deixou de esperar
     
     print_timestamp();
-    printf("💓 PONG recebido de %s - Rover SAUDÁVEL ✓\n\n",
-           rover->rover_id);
+    printf("💓 PONG recebido de %s - Rover SAUDÁVEL ✓ (RTT %.2f ms, SRTT %.2f ms)\n\n",
+           rover->rover_id, hb->rtt.last_rtt_ms, hb->rtt.srtt_ms);
 }
 
-// Marcar rover como inativo
-void mark_rover_inactive(RoverSession *rover, HeartbeatState *heartbeat) {
-    heartbeat->is_healthy = 0;
-    rover->active = 0;
+// Marcar rover como inativo (deixa de receber PINGs até voltar a falar)
+void mark_rover_inactive(RoverEntity *rover) {
+    rover->heartbeat.is_healthy = 0;
+    rover->heartbeat.waiting_for_pong = 0;
+    rover->link.active = 0;
+    disarm(&rover->heartbeat.ping_timer);
+    disarm(&rover->heartbeat.pong_timer);
     
     print_timestamp();
     printf("💀 Rover %s INATIVO - Nenhuma resposta após %d PINGs\n",
            rover->rover_id, HEARTBEAT_MAX_RETRIES);
     print_timestamp();
     printf("   Última atividade: %lds atrás\n\n",
-           time(NULL) - heartbeat->last_pong_received);
+           time(NULL) - rover->link.last_update);
+
+    if (hb_on_inactive) hb_on_inactive(rover);
 }
 
 // Imprimir status de heartbeat
-void print_heartbeat_status(RoverSession *sessions, int num_rovers) {
+void print_heartbeat_status(void) {
     print_timestamp();
     printf("\n╔═══════════════════════════════════════════════════════╗\n");
     printf("║              💓 STATUS DE HEARTBEAT                      ║\n");
@@ -121,22 +190,24 @@ void print_heartbeat_status(RoverSession *sessions, int num_rovers) {
     printf("║ Rover      │ Status       │ Última Resposta │ À Espera ║\n");
     printf("╠═══════════════════════════════════════════════════════╣\n");
     
-    if (num_rovers == 0) {
+    int shown = 0;
+    for (size_t i = 0; i < rover_registry_count(); i++) {
+        const RoverEntity *rover = rover_registry_at(i);
+        if (!rover->has_link || !rover->link.active) continue;
+        
+        time_t time_since_update = time(NULL) - rover->link.last_update;
+        const char *status = rover->link.active ? "✓ SAUDÁVEL" : "✗ INATIVO";
+        const char *waiting = rover->heartbeat.waiting_for_pong ? "SIM" : "NÃO";
+        
+        printf("║ %-10s │ %-12s │ %3lds atrás      │ %s    ║\n",
+               rover->rover_id,
+               status,
+               time_since_update,
+               waiting);
+        shown++;
+    }
+    if (shown == 0) {
         printf("║ Nenhum rover conectado                                 ║\n");
-    } else {
-        for (int i = 0; i < num_rovers; i++) {
-            if (!sessions[i].active) continue;
-            
-            time_t time_since_update = time(NULL) - sessions[i].last_update;
-            const char *status = sessions[i].active ? "✓ SAUDÁVEL" : "✗ INATIVO";
-            const char *waiting = sessions[i].waiting_for_pong ? "SIM" : "NÃO";
-            
-            printf("║ %-10s │ %-12s │ %3lds atrás      │ %s    ║\n",
-                   sessions[i].rover_id,
-                   status,
-                   time_since_update,
-                   waiting);
-        }
     }
     printf("╚═══════════════════════════════════════════════════════╝\n\n");
 }
@@ -144,9 +215,9 @@ void print_heartbeat_status(RoverSession *sessions, int num_rovers) {
 // ============ CLIENTE (ROVER) ============
 
 // Processar PING e enviar PONG
-void process_ping_and_respond(int sockfd, Packet *ping_pkt,
+void process_ping_and_respond(int sockfd, const PacketView *ping_pkt,
                              struct sockaddr_in *server_addr,
-                             const char *rover_id) {
+                             const char *rover_id, uint32_t conn_id) {
     print_timestamp();
     printf("💓 PING recebido da Nave-Mãe - Respondendo com PONG...\n");
     
@@ -154,14 +225,13 @@ void process_ping_and_respond(int sockfd, Packet *ping_pkt,
     Packet pong;
     memset(&pong, 0, sizeof(pong));
     pong.type = PKT_PONG;
-    pong.seq = ping_pkt->seq;  // Manter a mesma sequência
+    pong.seq = ml_view_seq(ping_pkt);  // Manter a mesma sequência
+    pong.conn_id = conn_id;
     
     strncpy(pong.rover_id, rover_id, sizeof(pong.rover_id) - 1);
     
     // Enviar PONG
-    ssize_t sent = sendto(sockfd, &pong, sizeof(pong), 0,
-                         (struct sockaddr *)server_addr,
-                         sizeof(*server_addr));
+    ssize_t sent = ml_wire_send(sockfd, &pong, server_addr);
     
     if (sent > 0) {
         print_timestamp();
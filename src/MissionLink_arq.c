@@ -0,0 +1,294 @@
+// ============ MissionLink_arq.c ============
+// Janela deslizante (selective repeat) do protocolo MissionLink
+#include "MissionLinkARQ.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#define ARQ_MASK (ARQ_WINDOW - 1)
+
+uint64_t arq_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+uint64_t arq_now_ms(void) {
+    return arq_now_us() / 1000;
+}
+
+// a está na janela [base, base + size)? (aritmética modular de 32 bits)
+static int seq_in_range(uint32_t a, uint32_t base, uint32_t size) {
+    return (uint32_t)(a - base) < size;
+}
+
+// ============ RTT (RFC 6298) ============
+
+void arq_rtt_init(ArqRtt *rtt) {
+    memset(rtt, 0, sizeof(*rtt));
+    rtt->rto_ms = ARQ_RTO_INITIAL_MS;
+}
+
+void arq_rtt_sample(ArqRtt *rtt, double rtt_ms) {
+    if (rtt->samples == 0) {
+        rtt->srtt_ms = rtt_ms;
+        rtt->rttvar_ms = rtt_ms / 2;
+    } else {
+        double err = rtt->srtt_ms - rtt_ms;
+        rtt->rttvar_ms = 0.75 * rtt->rttvar_ms + 0.25 * (err < 0 ? -err : err);
+        rtt->srtt_ms = 0.875 * rtt->srtt_ms + 0.125 * rtt_ms;
+    }
+    rtt->last_rtt_ms = rtt_ms;
+    rtt->samples++;
+
+    // RTO = SRTT + max(G, 4·RTTVAR), com G = 1 ms (granularidade do relógio)
+    double var = 4 * rtt->rttvar_ms;
+    double rto = rtt->srtt_ms + (var > 1.0 ? var : 1.0);
+    if (rto < ARQ_RTO_MIN_MS) rto = ARQ_RTO_MIN_MS;
+    if (rto > ARQ_RTO_MAX_MS) rto = ARQ_RTO_MAX_MS;
+    rtt->rto_ms = (uint32_t)rto;
+}
+
+uint32_t arq_rtt_backoff(const ArqRtt *rtt, int retries) {
+    uint32_t rto = rtt->rto_ms;
+    for (int i = 0; i < retries && rto < ARQ_RTO_MAX_MS; i++) rto *= 2;
+    if (rto > ARQ_RTO_MAX_MS) rto = ARQ_RTO_MAX_MS;
+
+    // Jitter até +25% nas retransmissões: rovers que perderam o mesmo
+    // pacote não voltam a tentar todos ao mesmo tempo
+    if (retries > 0) rto += (uint32_t)rand() % (rto / 4 + 1);
+    return rto;
+}
+
+// ============ EMISSOR ============
+
+void arq_sender_init(ArqSender *tx, int sockfd, const struct sockaddr_in *peer,
+                     uint32_t first_seq) {
+    memset(tx, 0, sizeof(*tx));
+    tx->sockfd = sockfd;
+    tx->peer = *peer;
+    tx->base = first_seq;
+    tx->next_seq = first_seq;
+    tx->syn_pending = 1;
+    arq_rtt_init(&tx->rtt);
+}
+
+int arq_sender_window_open(const ArqSender *tx) {
+    return (uint32_t)(tx->next_seq - tx->base) < ARQ_WINDOW;
+}
+
+uint32_t arq_sender_in_flight(const ArqSender *tx) {
+    uint32_t n = 0;
+    for (int i = 0; i < ARQ_WINDOW; i++) {
+        if (tx->slots[i].in_use) n++;
+    }
+    return n;
+}
+
+static void arq_transmit(ArqSender *tx, ArqSlot *slot, uint64_t now_ms) {
+    sendto(tx->sockfd, slot->wire, sizeof(slot->wire), 0,
+           (struct sockaddr *)&tx->peer, sizeof(tx->peer));
+    slot->sent_at_us = arq_now_us();
+    slot->deadline_ms = now_ms + arq_rtt_backoff(&tx->rtt, slot->retries);
+}
+
+int arq_send(ArqSender *tx, Packet *pkt) {
+    if (!arq_sender_window_open(tx)) return -1;
+
+    // As flags de confirmação (piggyback) ficam como o chamador as pôs
+    pkt->seq = tx->next_seq++;
+    pkt->flags &= ~ML_FLAG_SYN;
+    if (tx->syn_pending) {
+        pkt->flags |= ML_FLAG_SYN;
+        tx->syn_pending = 0;
+    }
+
+    ArqSlot *slot = &tx->slots[pkt->seq & ARQ_MASK];
+    slot->pkt = *pkt;
+    ml_wire_encode(pkt, slot->wire);
+    slot->retries = 0;
+    slot->in_use = 1;
+    arq_transmit(tx, slot, arq_now_ms());
+    tx->sent++;
+    return 0;
+}
+
+// Avançar a base sobre os pacotes já confirmados
+static void arq_advance_base(ArqSender *tx) {
+    while (tx->base != tx->next_seq && !tx->slots[tx->base & ARQ_MASK].in_use) {
+        tx->base++;
+    }
+}
+
+static ArqSlot* arq_mark_acked(ArqSender *tx, uint32_t seq) {
+    if (!seq_in_range(seq, tx->base, tx->next_seq - tx->base)) return NULL;
+    ArqSlot *slot = &tx->slots[seq & ARQ_MASK];
+    if (!slot->in_use || slot->pkt.seq != seq) return NULL;
+    slot->in_use = 0;
+    tx->acked++;
+    return slot;
+}
+
+int arq_sender_on_ack(ArqSender *tx, const PacketView *ack) {
+    if (!ack || !(ml_view_flags(ack) & ML_FLAG_ACK)) return 0;
+    uint32_t ack_seq = ml_view_ack_seq(ack);
+    uint32_t ack_bitmap = ml_view_ack_bitmap(ack);
+
+    // Cumulativo: tudo antes de ack_seq
+    int n = 0;
+    ArqSlot *newest = NULL;
+    for (uint32_t seq = tx->base; seq != tx->next_seq && (int32_t)(seq - ack_seq) < 0; seq++) {
+        ArqSlot *slot = arq_mark_acked(tx, seq);
+        if (slot) {
+            newest = slot;
+            n++;
+        }
+    }
+
+    // Seletivo: recebidos depois do buraco em ack_seq
+    for (int i = 0; i < ARQ_SACK_BITS; i++) {
+        if (ack_bitmap & (1u << i)) {
+            if (arq_mark_acked(tx, ack_seq + 1 + (uint32_t)i)) n++;
+        }
+    }
+    arq_advance_base(tx);
+
+    // Amostra de RTT no pacote mais recente que o ACK cumulativo confirmou.
+    // Karn: nunca num pacote retransmitido (não se sabe a que envio responde)
+    if (newest && newest->retries == 0) {
+        arq_rtt_sample(&tx->rtt, (double)(arq_now_us() - newest->sent_at_us) / 1000.0);
+    }
+
+    if (n > 0) {
+        print_timestamp();
+        printf("[ARQ] ✓ %s até seq=%u (%d confirmado%s, %u em voo | SRTT %.2f ms, RTO %u ms)\n",
+               ml_view_type(ack) == PKT_ACK ? "ACK" : "ACK em piggyback", ack_seq - 1,
+               n, n == 1 ? "" : "s", arq_sender_in_flight(tx),
+               tx->rtt.srtt_ms, tx->rtt.rto_ms);
+    }
+    return n;
+}
+
+int arq_sender_poll(ArqSender *tx, uint64_t now_ms) {
+    int retransmitted = 0;
+
+    for (uint32_t seq = tx->base; seq != tx->next_seq; seq++) {
+        ArqSlot *slot = &tx->slots[seq & ARQ_MASK];
+        if (!slot->in_use || now_ms < slot->deadline_ms) continue;
+
+        if (slot->retries >= ARQ_MAX_RETRIES) {
+            // O recetor ficaria à espera desta sequência para sempre:
+            // abandonar os pacotes em voo e abrir um stream novo (SYN)
+            print_timestamp();
+            printf("[ARQ] ✗ %s seq=%u sem ACK após %d retransmissões - stream reiniciado (%u pacote(s) perdido(s))\n",
+                   get_packet_type_name(slot->pkt.type), seq, ARQ_MAX_RETRIES,
+                   arq_sender_in_flight(tx));
+            memset(tx->slots, 0, sizeof(tx->slots));
+            tx->base = tx->next_seq;
+            tx->syn_pending = 1;
+            tx->resets++;
+            return -1;
+        }
+
+        slot->retries++;
+        arq_transmit(tx, slot, now_ms);
+        tx->retransmitted++;
+        retransmitted++;
+
+        print_timestamp();
+        printf("[ARQ] ⚠ Retransmitir %s seq=%u (%d/%d, próximo timeout %llu ms)\n",
+               get_packet_type_name(slot->pkt.type), seq, slot->retries, ARQ_MAX_RETRIES,
+               (unsigned long long)(slot->deadline_ms - now_ms));
+    }
+    return retransmitted;
+}
+
+int arq_sender_next_timeout(const ArqSender *tx, uint64_t now_ms) {
+    int best = -1;
+    for (uint32_t seq = tx->base; seq != tx->next_seq; seq++) {
+        const ArqSlot *slot = &tx->slots[seq & ARQ_MASK];
+        if (!slot->in_use) continue;
+        int wait = (slot->deadline_ms > now_ms) ? (int)(slot->deadline_ms - now_ms) : 0;
+        if (best < 0 || wait < best) best = wait;
+    }
+    return best;
+}
+
+// ============ RECETOR ============
+
+// Recebida? Antes de 'expected' tudo foi entregue; na janela, ver o bitmap
+static int arq_received(const ArqReceiver *rx, uint32_t seq) {
+    uint32_t off = seq - rx->expected;
+    if ((int32_t)off < 0) return 1;
+    return off < ARQ_WINDOW && (rx->received >> off) & 1u;
+}
+
+void arq_receiver_piggyback(const ArqReceiver *rx, Packet *pkt) {
+    // Depois da entrega, o bit 0 (expected) está sempre vazio
+    pkt->flags |= ML_FLAG_ACK;
+    pkt->ack_seq = rx->expected;
+    pkt->ack_bitmap = rx->received >> 1;
+}
+
+void arq_receiver_ack(const ArqReceiver *rx, uint32_t seq, Packet *ack) {
+    memset(ack, 0, sizeof(*ack));
+    ack->type = PKT_ACK;
+    ack->seq = seq;
+    arq_receiver_piggyback(rx, ack);
+}
+
+// Um SYN de outro stream nunca é duplicado, mesmo que a sequência coincida
+static int arq_new_stream(const ArqReceiver *rx, const PacketView *pkt) {
+    return (ml_view_flags(pkt) & ML_FLAG_SYN) &&
+           (!rx->synced || ml_view_nonce(pkt) != rx->stream_nonce);
+}
+
+int arq_receiver_duplicate(ArqReceiver *rx, const PacketView *pkt, Packet *ack) {
+    uint32_t seq = ml_view_seq(pkt);
+    if (!rx->synced || arq_new_stream(rx, pkt) || !arq_received(rx, seq)) return 0;
+    rx->stats.duplicates++;
+    arq_receiver_ack(rx, seq, ack);
+    return 1;
+}
+
+int arq_receiver_accept(ArqReceiver *rx, const PacketView *pkt,
+                        Packet **out, int max_out, Packet *ack) {
+    uint32_t seq = ml_view_seq(pkt);
+    ack->type = 0;
+
+    // Stream novo: recomeçar a contagem na sequência do SYN
+    if (arq_new_stream(rx, pkt)) {
+        rx->synced = 1;
+        rx->expected = seq;
+        rx->stream_nonce = ml_view_nonce(pkt);
+        rx->received = 0;
+    }
+
+    // Sem SYN não se sabe onde o stream começa: o emissor retransmite
+    if (!rx->synced) return 0;
+
+    if (arq_receiver_duplicate(rx, pkt, ack)) return 0;
+
+    uint32_t off = seq - rx->expected;
+    if (off >= ARQ_WINDOW) {
+        return 0;                    // Fora da janela: sem espaço para guardar
+    }
+
+    // Única cópia: do buffer de receção para a janela
+    ml_view_decode(pkt, &rx->slots[seq & ARQ_MASK]);
+    rx->received |= 1u << off;
+    if (off > 0) rx->stats.out_of_order++;
+
+    // Entregar por ordem tudo o que ficou contíguo
+    int n = 0;
+    while (n < max_out && (rx->received & 1u)) {
+        out[n++] = &rx->slots[rx->expected & ARQ_MASK];
+        rx->received >>= 1;
+        rx->expected++;
+    }
+    rx->stats.delivered += (uint64_t)n;
+
+    arq_receiver_ack(rx, seq, ack);
+    return n;
+}
@@ -0,0 +1,412 @@
+// ============ MissionLink_frag.c ============
+// Fragmentação e reconstrução de mensagens grandes do MissionLink
+#include "MissionLinkFrag.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <endian.h>
+#include <arpa/inet.h>
+
+// ============ BITMAPS ============
+
+static int bit_get(const uint8_t *map, uint32_t i) {
+    return (map[i >> 3] >> (i & 7)) & 1u;
+}
+
+static void bit_set(uint8_t *map, uint32_t i) {
+    map[i >> 3] |= (uint8_t)(1u << (i & 7));
+}
+
+static void bit_clear(uint8_t *map, uint32_t i) {
+    map[i >> 3] &= (uint8_t)~(1u << (i & 7));
+}
+
+// ============ ORDEM DE BYTES ============
+// Os cabeçalhos ficam na ordem do host em memória e em little-endian na rede
+
+static void frag_header_to_wire(FragHeader *hdr) {
+    hdr->conn_id = htole32(hdr->conn_id);
+    hdr->msg_id = htole32(hdr->msg_id);
+    hdr->total_len = htole32(hdr->total_len);
+    hdr->frag_index = htole16(hdr->frag_index);
+    hdr->frag_count = htole16(hdr->frag_count);
+    hdr->frag_len = htole16(hdr->frag_len);
+}
+
+static void frag_header_from_wire(FragHeader *hdr) {
+    hdr->conn_id = le32toh(hdr->conn_id);
+    hdr->msg_id = le32toh(hdr->msg_id);
+    hdr->total_len = le32toh(hdr->total_len);
+    hdr->frag_index = le16toh(hdr->frag_index);
+    hdr->frag_count = le16toh(hdr->frag_count);
+    hdr->frag_len = le16toh(hdr->frag_len);
+}
+
+static uint16_t frag_count_for(uint32_t len) {
+    return (uint16_t)((len + FRAG_SIZE - 1) / FRAG_SIZE);
+}
+
+// Bytes do fragmento index (todos FRAG_SIZE menos, talvez, o último)
+static uint16_t frag_len_at(uint32_t total_len, uint16_t index) {
+    uint32_t rest = total_len - (uint32_t)index * FRAG_SIZE;
+    return (uint16_t)(rest > FRAG_SIZE ? FRAG_SIZE : rest);
+}
+
+// ============ EMISSOR ============
+
+void frag_sender_init(FragSender *tx, int sockfd, const struct sockaddr_in *peer,
+                      const char *rover_id) {
+    memset(tx, 0, sizeof(*tx));
+    tx->sockfd = sockfd;
+    tx->peer = *peer;
+    strncpy(tx->rover_id, rover_id, sizeof(tx->rover_id) - 1);
+    arq_rtt_init(&tx->rtt);
+
+    // IDs diferentes entre arranques: o recetor lembra-se das concluídas
+    tx->next_msg_id = (uint32_t)rand() ^ (uint32_t)arq_now_us();
+}
+
+int64_t frag_send(FragSender *tx, const void *data, uint32_t len,
+                  uint8_t content_type, const char *mission_id) {
+    if (tx->active || len == 0 || len > FRAG_MAX_MESSAGE) return -1;
+
+    tx->data = malloc(len);
+    if (!tx->data) return -1;
+    memcpy(tx->data, data, len);
+
+    memset(&tx->hdr, 0, sizeof(tx->hdr));
+    tx->hdr.type = PKT_FRAGMENT;
+    tx->hdr.content_type = content_type;
+    tx->hdr.conn_id = tx->conn_id;
+    memcpy(tx->hdr.rover_id, tx->rover_id, sizeof(tx->hdr.rover_id));
+    if (mission_id) strncpy(tx->hdr.mission_id, mission_id, sizeof(tx->hdr.mission_id) - 1);
+    tx->hdr.msg_id = tx->next_msg_id++;
+    tx->hdr.total_len = len;
+    tx->hdr.frag_count = frag_count_for(len);
+
+    tx->next_frag = 0;
+    memset(tx->resend, 0, sizeof(tx->resend));
+    tx->resend_pending = 0;
+    tx->probes = 0;
+    tx->deadline_ms = 0;
+    tx->started_us = arq_now_us();
+    tx->active = 1;
+
+    print_timestamp();
+    printf("[FRAG] 📦 Mensagem %u: %u bytes em %u fragmentos\n",
+           tx->hdr.msg_id, len, tx->hdr.frag_count);
+    return tx->hdr.msg_id;
+}
+
+static void frag_transmit(FragSender *tx, uint16_t index) {
+    FragPacket frag;
+    frag.hdr = tx->hdr;
+    frag.hdr.frag_index = index;
+    frag.hdr.frag_len = frag_len_at(tx->hdr.total_len, index);
+    memcpy(frag.data, tx->data + (size_t)index * FRAG_SIZE, frag.hdr.frag_len);
+
+    size_t len = sizeof(FragHeader) + frag.hdr.frag_len;
+    frag_header_to_wire(&frag.hdr);
+    sendto(tx->sockfd, &frag, len, 0,
+           (struct sockaddr *)&tx->peer, sizeof(tx->peer));
+    tx->fragments_sent++;
+}
+
+static void frag_sender_finish(FragSender *tx) {
+    free(tx->data);
+    tx->data = NULL;
+    tx->active = 0;
+}
+
+int frag_sender_poll(FragSender *tx, uint64_t now_ms) {
+    if (!tx->active) return 0;
+
+    // Pedidos primeiro (o recetor está à espera deles), depois os novos
+    int budget = FRAG_BURST;
+    for (uint16_t i = 0; tx->resend_pending > 0 && i < tx->next_frag && budget > 0; i++) {
+        if (!bit_get(tx->resend, i)) continue;
+        bit_clear(tx->resend, i);
+        tx->resend_pending--;
+        frag_transmit(tx, i);
+        tx->fragments_resent++;
+        budget--;
+    }
+    while (tx->next_frag < tx->hdr.frag_count && budget > 0) {
+        frag_transmit(tx, tx->next_frag++);
+        budget--;
+    }
+
+    if (budget < FRAG_BURST) {
+        tx->deadline_ms = now_ms + arq_rtt_backoff(&tx->rtt, tx->probes);
+        return 0;
+    }
+    if (now_ms < tx->deadline_ms) return 0;
+
+    // Tudo enviado e nem NACK nem DONE: sondar com o último fragmento
+    // (o recetor responde com o que lhe falta, ou com DONE se já terminou)
+    if (tx->probes >= FRAG_MAX_PROBES) {
+        print_timestamp();
+        printf("[FRAG] ✗ Mensagem %u sem resposta após %d sondas - abandonada\n",
+               tx->hdr.msg_id, FRAG_MAX_PROBES);
+        tx->messages_failed++;
+        frag_sender_finish(tx);
+        return -1;
+    }
+    tx->probes++;
+    frag_transmit(tx, (uint16_t)(tx->hdr.frag_count - 1));
+    tx->deadline_ms = now_ms + arq_rtt_backoff(&tx->rtt, tx->probes);
+    return 0;
+}
+
+int frag_sender_on_control(FragSender *tx, const FragControl *ctl) {
+    if (!tx->active || le32toh(ctl->msg_id) != tx->hdr.msg_id) return 0;
+
+    if (ctl->type == PKT_FRAG_DONE) {
+        double elapsed_ms = (double)(arq_now_us() - tx->started_us) / 1000.0;
+        print_timestamp();
+        printf("[FRAG] ✓ Mensagem %u entregue: %u bytes em %.1f ms (%.1f KB/s, %llu fragmento(s) repetido(s))\n",
+               tx->hdr.msg_id, tx->hdr.total_len, elapsed_ms,
+               elapsed_ms > 0 ? tx->hdr.total_len / elapsed_ms : 0.0,
+               (unsigned long long)tx->fragments_resent);
+        tx->messages_sent++;
+        frag_sender_finish(tx);
+        return 1;
+    }
+
+    if (ctl->type == PKT_FRAG_NACK) {
+        int requested = 0;
+        for (uint32_t i = 0; i < FRAG_NACK_WINDOW; i++) {
+            uint32_t index = (uint32_t)le16toh(ctl->base) + i;
+            if (index >= tx->next_frag) break;          // Ainda não enviado
+            if (bit_get(ctl->missing, i) && !bit_get(tx->resend, index)) {
+                bit_set(tx->resend, index);
+                tx->resend_pending++;
+                requested++;
+            }
+        }
+        tx->probes = 0;                                 // O recetor está vivo
+        print_timestamp();
+        printf("[FRAG] ⚠ NACK da mensagem %u: %d fragmento(s) a repetir\n",
+               tx->hdr.msg_id, requested);
+    }
+    return 0;
+}
+
+int frag_sender_next_timeout(const FragSender *tx, uint64_t now_ms) {
+    if (!tx->active) return -1;
+    if (tx->next_frag < tx->hdr.frag_count || tx->resend_pending > 0) return 0;
+    return tx->deadline_ms > now_ms ? (int)(tx->deadline_ms - now_ms) : 0;
+}
+
+// ============ RECETOR ============
+
+static void on_nack_timer(Timer *timer, void *arg);
+static void on_expiry_timer(Timer *timer, void *arg);
+
+void frag_reassembler_init(FragReassembler *rx, int sockfd, TimerWheel *wheel,
+                           FragDeliverFn deliver) {
+    memset(rx, 0, sizeof(*rx));
+    rx->sockfd = sockfd;
+    rx->wheel = wheel;
+    rx->deliver = deliver;
+}
+
+static void send_control(FragReassembler *rx, const struct sockaddr_in *to,
+                         FragControl *ctl) {
+    ctl->msg_id = htole32(ctl->msg_id);
+    ctl->base = htole16(ctl->base);
+    sendto(rx->sockfd, ctl, sizeof(*ctl), 0, (const struct sockaddr *)to, sizeof(*to));
+}
+
+static void send_done(FragReassembler *rx, const struct sockaddr_in *to,
+                      const char rover_id[32], uint32_t msg_id) {
+    FragControl ctl;
+    memset(&ctl, 0, sizeof(ctl));
+    ctl.type = PKT_FRAG_DONE;
+    memcpy(ctl.rover_id, rover_id, sizeof(ctl.rover_id));
+    ctl.msg_id = msg_id;
+    send_control(rx, to, &ctl);
+}
+
+static void message_free(FragReassembler *rx, FragMessage *msg) {
+    timer_cancel(rx->wheel, &msg->nack_timer);
+    timer_cancel(rx->wheel, &msg->expiry_timer);
+    free(msg->data);
+    msg->data = NULL;
+    rx->memory_used -= msg->hdr.total_len;
+    msg->in_use = 0;
+}
+
+static int was_completed(const FragReassembler *rx, const FragHeader *hdr) {
+    for (int i = 0; i < FRAG_COMPLETED_MEMORY; i++) {
+        if (rx->completed[i].msg_id == hdr->msg_id &&
+            strncmp(rx->completed[i].rover_id, hdr->rover_id, sizeof(hdr->rover_id)) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static FragMessage* message_find(FragReassembler *rx, const FragHeader *hdr) {
+    for (int i = 0; i < FRAG_MAX_MESSAGES; i++) {
+        FragMessage *msg = &rx->slots[i];
+        if (msg->in_use && msg->hdr.msg_id == hdr->msg_id &&
+            strncmp(msg->hdr.rover_id, hdr->rover_id, sizeof(hdr->rover_id)) == 0) {
+            return msg;
+        }
+    }
+    return NULL;
+}
+
+// Nova mensagem, dentro dos limites de memória
+static FragMessage* message_open(FragReassembler *rx, const FragHeader *hdr) {
+    FragMessage *msg = NULL;
+    for (int i = 0; i < FRAG_MAX_MESSAGES && !msg; i++) {
+        if (!rx->slots[i].in_use) msg = &rx->slots[i];
+    }
+    if (!msg || rx->memory_used + hdr->total_len > FRAG_MEMORY_LIMIT) return NULL;
+
+    uint8_t *data = malloc(hdr->total_len);
+    if (!data) return NULL;
+
+    memset(msg, 0, sizeof(*msg));
+    msg->in_use = 1;
+    msg->owner = rx;
+    msg->hdr = *hdr;
+    msg->data = data;
+    timer_init(&msg->nack_timer, on_nack_timer, msg);
+    timer_init(&msg->expiry_timer, on_expiry_timer, msg);
+    rx->memory_used += hdr->total_len;
+
+    print_timestamp();
+    printf("[FRAG] 📦 %.32s: mensagem %u a chegar (%u bytes, %u fragmentos)\n",
+           hdr->rover_id, hdr->msg_id, hdr->total_len, hdr->frag_count);
+    return msg;
+}
+
+static void on_nack_timer(Timer *timer, void *arg) {
+    FragMessage *msg = arg;
+    FragReassembler *rx = msg->owner;
+    (void)timer;
+
+    // Primeiro em falta e os FRAG_NACK_WINDOW seguintes
+    uint16_t base = 0;
+    while (base < msg->hdr.frag_count && bit_get(msg->received, base)) base++;
+
+    FragControl ctl;
+    memset(&ctl, 0, sizeof(ctl));
+    ctl.type = PKT_FRAG_NACK;
+    memcpy(ctl.rover_id, msg->hdr.rover_id, sizeof(ctl.rover_id));
+    ctl.msg_id = msg->hdr.msg_id;
+    ctl.base = base;
+
+    int missing = 0;
+    for (uint32_t i = 0; i < FRAG_NACK_WINDOW && base + i < msg->hdr.frag_count; i++) {
+        if (!bit_get(msg->received, base + i)) {
+            bit_set(ctl.missing, i);
+            missing++;
+        }
+    }
+    send_control(rx, &msg->from, &ctl);
+    rx->nacks_sent++;
+
+    print_timestamp();
+    printf("[FRAG] ⚠ %.32s: mensagem %u com %u/%u fragmentos - pedidos %d a partir de %u\n",
+           msg->hdr.rover_id, msg->hdr.msg_id, msg->received_count, msg->hdr.frag_count,
+           missing, base);
+
+    // Se o NACK se perder, repetir com intervalo crescente
+    uint64_t delay = (uint64_t)FRAG_NACK_DELAY_MS << (msg->nacks < 8 ? msg->nacks : 8);
+    if (delay > FRAG_NACK_MAX_DELAY_MS) delay = FRAG_NACK_MAX_DELAY_MS;
+    msg->nacks++;
+    timer_arm(rx->wheel, &msg->nack_timer, arq_now_ms() + delay);
+}
+
+static void on_expiry_timer(Timer *timer, void *arg) {
+    FragMessage *msg = arg;
+    FragReassembler *rx = msg->owner;
+    (void)timer;
+
+    print_timestamp();
+    printf("[FRAG] ✗ %.32s: mensagem %u expirou com %u/%u fragmentos\n",
+           msg->hdr.rover_id, msg->hdr.msg_id, msg->received_count, msg->hdr.frag_count);
+    rx->messages_expired++;
+    message_free(rx, msg);
+}
+
+uint32_t frag_conn_id(const FragPacket *frag, size_t len) {
+    if (len < sizeof(FragHeader)) return 0;
+    return le32toh(frag->hdr.conn_id);
+}
+
+void frag_reassembler_on_fragment(FragReassembler *rx, const FragPacket *frag, size_t len,
+                                  const struct sockaddr_in *from) {
+    if (len < sizeof(FragHeader)) return;
+    FragHeader host = frag->hdr;
+    frag_header_from_wire(&host);
+    const FragHeader *hdr = &host;
+
+    // Cabeçalho coerente: tamanho, contagem e comprimento deste fragmento
+    if (hdr->total_len == 0 || hdr->total_len > FRAG_MAX_MESSAGE ||
+        hdr->frag_count != frag_count_for(hdr->total_len) ||
+        hdr->frag_index >= hdr->frag_count ||
+        hdr->frag_len != frag_len_at(hdr->total_len, hdr->frag_index) ||
+        len < sizeof(FragHeader) + hdr->frag_len) {
+        return;
+    }
+    rx->fragments_received++;
+
+    // Já entregue (o DONE perdeu-se): repetir só o DONE
+    if (was_completed(rx, hdr)) {
+        rx->fragments_duplicate++;
+        send_done(rx, from, hdr->rover_id, hdr->msg_id);
+        return;
+    }
+
+    FragMessage *msg = message_find(rx, hdr);
+    if (!msg) {
+        msg = message_open(rx, hdr);
+        if (!msg) {
+            // Sem memória: o emissor volta a sondar mais tarde
+            rx->messages_rejected++;
+            return;
+        }
+    } else if (msg->hdr.total_len != hdr->total_len) {
+        return;
+    }
+    msg->from = *from;
+
+    if (bit_get(msg->received, hdr->frag_index)) {
+        rx->fragments_duplicate++;
+    } else {
+        memcpy(msg->data + (size_t)hdr->frag_index * FRAG_SIZE, frag->data, hdr->frag_len);
+        bit_set(msg->received, hdr->frag_index);
+        msg->received_count++;
+        msg->nacks = 0;
+    }
+
+    if (msg->received_count == msg->hdr.frag_count) {
+        send_done(rx, from, hdr->rover_id, hdr->msg_id);
+
+        memcpy(rx->completed[rx->completed_next].rover_id, hdr->rover_id,
+               sizeof(rx->completed[0].rover_id));
+        rx->completed[rx->completed_next].msg_id = hdr->msg_id;
+        rx->completed_next = (rx->completed_next + 1) % FRAG_COMPLETED_MEMORY;
+        rx->messages_completed++;
+
+        if (rx->deliver) rx->deliver(&msg->hdr, msg->data);
+        message_free(rx, msg);
+        return;
+    }
+
+    // Pedir os que faltam quando o fluxo parar
+    uint64_t now_ms = arq_now_ms();
+    timer_arm(rx->wheel, &msg->nack_timer, now_ms + FRAG_NACK_DELAY_MS);
+    timer_arm(rx->wheel, &msg->expiry_timer, now_ms + FRAG_MESSAGE_TIMEOUT_MS);
+}
+
+void frag_reassembler_destroy(FragReassembler *rx) {
+    for (int i = 0; i < FRAG_MAX_MESSAGES; i++) {
+        if (rx->slots[i].in_use) message_free(rx, &rx->slots[i]);
+    }
+}
@@ -1,6 +1,7 @@
 // ============ MissionLink_socket.c ============
 // Funções de comunicação UDP do protocolo MissionLink
 #include "MissionLink.h"
+#include "MissionLinkARQ.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -40,38 +41,54 @@ int receive_udp(int sockfd, char *buffer, size_t buf_size,
     return received;
 }
 
-// Enviar ACK
+// Enviar ACK (cumulativo até seq, sem janela)
 void send_ack_packet(int sockfd, struct sockaddr_in *addr, uint32_t seq) {
     Packet ack_pkt;
     memset(&ack_pkt, 0, sizeof(ack_pkt));
     ack_pkt.type = PKT_ACK;
     ack_pkt.seq = seq;
+    ack_pkt.flags = ML_FLAG_ACK;
+    ack_pkt.ack_seq = seq + 1;
     
-    sendto(sockfd, &ack_pkt, sizeof(ack_pkt), 0, 
-           (struct sockaddr *)addr, sizeof(*addr));
+    ml_wire_send(sockfd, &ack_pkt, addr);
 }
 
 // Enviar pacote com ACK confirmado (retransmissão automática)
-ssize_t send_udp_with_ack(int sockfd, struct sockaddr_in *server_addr, 
-                          char *data, size_t size) {
-    Packet ack_pkt;
+// Um pacote de cada vez; o timeout segue o RTT medido nos envios anteriores
+ssize_t send_udp_with_ack(int sockfd, struct sockaddr_in *server_addr,
+                          const Packet *pkt) {
+    static ArqRtt rtt;
+    if (rtt.rto_ms == 0) arq_rtt_init(&rtt);
+
+    uint8_t data[ML_WIRE_PACKET_SIZE];
+    size_t size = ml_wire_encode(pkt, data);
+
+    uint8_t ack_buf[ML_WIRE_PACKET_SIZE];
+    PacketView ack;
     ssize_t sent = sendto(sockfd, data, size, 0, 
                          (struct sockaddr *)server_addr, sizeof(*server_addr));
     if (sent < 0) return -1;
-
-    struct timeval tv = {ACK_TIMEOUT, 0};
-    setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    uint64_t sent_at_us = arq_now_us();
     
     int retries = 0;
     socklen_t addr_len = sizeof(*server_addr);
     
     while (retries < ACK_RETRIES) {
-        int r = recvfrom(sockfd, &ack_pkt, sizeof(ack_pkt), 0, 
+        uint32_t timeout_ms = arq_rtt_backoff(&rtt, retries);
+        struct timeval tv = {timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+        setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+        int r = recvfrom(sockfd, ack_buf, sizeof(ack_buf), 0, 
                         (struct sockaddr *)server_addr, &addr_len);
         
-        if (r == sizeof(Packet) && ack_pkt.type == PKT_ACK && ack_pkt.seq == ((Packet*)data)->seq) {
+        if (r > 0 && ml_view_init(&ack, ack_buf, (size_t)r) == ML_WIRE_OK &&
+            ml_view_type(&ack) == PKT_ACK && ml_view_seq(&ack) == pkt->seq) {
+            // Karn: sem amostra se houve retransmissão
+            if (retries == 0) {
+                arq_rtt_sample(&rtt, (double)(arq_now_us() - sent_at_us) / 1000.0);
+            }
             print_timestamp();
-            printf("[UDP] ✓ ACK recebido (seq=%u)\n", ack_pkt.seq);
+            printf("[UDP] ✓ ACK recebido (seq=%u, SRTT %.2f ms)\n", pkt->seq, rtt.srtt_ms);
             return sent;
         }
         
@@ -79,7 +96,6 @@ ssize_t send_udp_with_ack(int sockfd, struct sockaddr_in *server_addr,
         if (retries < ACK_RETRIES) {
             print_timestamp();
             printf("[UDP] ⚠ ACK não recebido, retentando... (%d/%d)\n", retries, ACK_RETRIES);
-            usleep(200000);
             sendto(sockfd, data, size, 0, (struct sockaddr *)server_addr, 
                    sizeof(*server_addr));
         }
@@ -88,4 +104,4 @@ ssize_t send_udp_with_ack(int sockfd, struct sockaddr_in *server_addr,
     print_timestamp();
     printf("[UDP] ✗ Falha ao enviar com ACK após %d tentativas\n", ACK_RETRIES);
     return -1;
-}
\ No newline at end of file
+}
@@ -7,8 +7,9 @@
 // Imprimir timestamp HH:MM:SS
 void print_timestamp(void) {
     time_t now = time(NULL);
-    struct tm *t = localtime(&now);
-    printf("[%02d:%02d:%02d] ", t->tm_hour, t->tm_min, t->tm_sec);
+    struct tm t;
+    localtime_r(&now, &t);
+    printf("[%02d:%02d:%02d] ", t.tm_hour, t.tm_min, t.tm_sec);
 }
 
 // Converter tipo de pacote para string
@@ -19,6 +20,8 @@ const char* get_packet_type_name(uint8_t type) {
         case PKT_PROGRESS:        return "PROGRESS";
         case PKT_COMPLETE:        return "COMPLETE";
         case PKT_ACK:             return "ACK";
+        case PKT_MISSION_REVOKE:  return "MISSION_REVOKE";
+        case PKT_MISSION_DEFER:   return "MISSION_DEFER";
         default:                  return "UNKNOWN";
     }
 }
@@ -42,4 +45,7 @@ void print_packet_info(Packet *pkt) {
         printf("[PKT]   Duração:        %u segundos\n", pkt->mission_duration);
         printf("[PKT]   Intervalo:      %u segundos\n", pkt->update_interval);
     }
+    if (pkt->type == PKT_MISSION_REQUEST || pkt->type == PKT_MISSION_ASSIGN) {
+        printf("[PKT]   Fila:           %u\n", pkt->queue_depth);
+    }
 }
\ No newline at end of file
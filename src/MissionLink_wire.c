@@ -0,0 +1,176 @@
+// ============ MissionLink_wire.c ============
+// Codificação explícita (little-endian, versão, CRC32C) dos pacotes MissionLink
+#include "MissionLinkWire.h"
+#include <pthread.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define ML_HAVE_SSE42 1
+#endif
+
+// ============ CRC32C ============
+// Polinómio de Castagnoli (refletido); o mesmo que a instrução crc32 do SSE4.2
+
+#define CRC32C_POLY 0x82F63B78u
+
+static uint32_t crc32c_lut[256];
+
+static uint32_t crc32c_table(uint32_t crc, const void *data, size_t len) {
+    const uint8_t *p = data;
+    crc = ~crc;
+    while (len--) crc = crc32c_lut[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+#ifdef ML_HAVE_SSE42
+// Palavras de 8 bytes; o resto byte a byte
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_sse42(uint32_t crc, const void *data, size_t len) {
+    const uint8_t *p = data;
+    uint64_t c = (uint32_t)~crc;
+    while (len >= 8) {
+        uint64_t w;
+        memcpy(&w, p, sizeof(w));
+        c = _mm_crc32_u64(c, w);
+        p += 8;
+        len -= 8;
+    }
+    uint32_t c32 = (uint32_t)c;
+    while (len--) c32 = _mm_crc32_u8(c32, *p++);
+    return ~c32;
+}
+#endif
+
+static pthread_once_t crc32c_once = PTHREAD_ONCE_INIT;
+static uint32_t (*crc32c_best)(uint32_t, const void *, size_t);
+static const char *crc32c_name;
+
+static void crc32c_select(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) c = (c & 1) ? (c >> 1) ^ CRC32C_POLY : c >> 1;
+        crc32c_lut[i] = c;
+    }
+    crc32c_best = crc32c_table;
+    crc32c_name = "table";
+
+#ifdef ML_HAVE_SSE42
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) {
+        crc32c_best = crc32c_sse42;
+        crc32c_name = "sse4.2";
+    }
+#endif
+}
+
+uint32_t crc32c(uint32_t crc, const void *data, size_t len) {
+    pthread_once(&crc32c_once, crc32c_select);
+    return crc32c_best(crc, data, len);
+}
+
+const char *crc32c_impl(void) {
+    pthread_once(&crc32c_once, crc32c_select);
+    return crc32c_name;
+}
+
+// CRC do datagrama: cabeçalho sem o próprio campo e todo o corpo
+static uint32_t wire_crc(const uint8_t *buf, size_t len) {
+    uint32_t crc = crc32c(0, buf, 4);
+    return crc32c(crc, buf + ML_WIRE_HEADER_SIZE, len - ML_WIRE_HEADER_SIZE);
+}
+
+// ============ CODIFICAÇÃO ============
+
+size_t ml_wire_encode(const Packet *pkt, uint8_t *buf) {
+    buf[0] = pkt->type;
+    buf[1] = ML_WIRE_VERSION;
+    ml_put_le16(buf + 2, ML_WIRE_PACKET_SIZE);
+
+    ml_put_le32(buf + ML_OFF_SEQ, pkt->seq);
+    buf[ML_OFF_BATTERY] = pkt->battery;
+    buf[ML_OFF_PROGRESS] = pkt->progress;
+    ml_put_le32(buf + ML_OFF_NONCE, pkt->nonce);
+    buf[ML_OFF_FLAGS] = pkt->flags;
+    ml_put_le32(buf + ML_OFF_ACK_SEQ, pkt->ack_seq);
+    ml_put_le32(buf + ML_OFF_ACK_BITMAP, pkt->ack_bitmap);
+    ml_put_le32(buf + ML_OFF_CONN_ID, pkt->conn_id);
+    ml_put_le64(buf + ML_OFF_RESUME_TOKEN, pkt->resume_token);
+
+    memcpy(buf + ML_OFF_ROVER_ID, pkt->rover_id, sizeof(pkt->rover_id));
+    memcpy(buf + ML_OFF_MISSION_ID, pkt->mission_id, sizeof(pkt->mission_id));
+    memcpy(buf + ML_OFF_TASK_TYPE, pkt->task_type, sizeof(pkt->task_type));
+
+    ml_put_lef32(buf + ML_OFF_MISSION_X1, pkt->mission_x1);
+    ml_put_lef32(buf + ML_OFF_MISSION_Y1, pkt->mission_y1);
+    ml_put_lef32(buf + ML_OFF_MISSION_X2, pkt->mission_x2);
+    ml_put_lef32(buf + ML_OFF_MISSION_Y2, pkt->mission_y2);
+    ml_put_le32(buf + ML_OFF_DURATION, pkt->mission_duration);
+    ml_put_le32(buf + ML_OFF_UPDATE_INTERVAL, pkt->update_interval);
+    buf[ML_OFF_QUEUE_DEPTH] = pkt->queue_depth;
+
+    ml_put_le32(buf + 4, wire_crc(buf, ML_WIRE_PACKET_SIZE));
+    return ML_WIRE_PACKET_SIZE;
+}
+
+ssize_t ml_wire_send(int sockfd, const Packet *pkt, const struct sockaddr_in *addr) {
+    uint8_t buf[ML_WIRE_PACKET_SIZE];
+    size_t len = ml_wire_encode(pkt, buf);
+    return sendto(sockfd, buf, len, 0, (const struct sockaddr *)addr, sizeof(*addr));
+}
+
+// ============ VISTA ============
+
+MLWireStatus ml_view_init(PacketView *view, const void *buf, size_t len) {
+    const uint8_t *p = buf;
+    if (len < ML_WIRE_HEADER_SIZE) return ML_WIRE_TRUNCATED;
+
+    uint16_t length = ml_get_le16(p + 2);
+    if (length > len) return ML_WIRE_TRUNCATED;
+    if (p[1] == 0 || length < ML_WIRE_MIN_SIZE) return ML_WIRE_BAD_VERSION;
+    if (ml_get_le32(p + 4) != wire_crc(p, length)) return ML_WIRE_BAD_CRC;
+
+    view->buf = p;
+    view->len = length;
+    view->version = p[1];
+    return ML_WIRE_OK;
+}
+
+void ml_view_decode(const PacketView *view, Packet *pkt) {
+    const uint8_t *buf = view->buf;
+
+    pkt->type = buf[0];
+    pkt->seq = ml_get_le32(buf + ML_OFF_SEQ);
+    pkt->battery = buf[ML_OFF_BATTERY];
+    pkt->progress = buf[ML_OFF_PROGRESS];
+    pkt->nonce = ml_get_le32(buf + ML_OFF_NONCE);
+    pkt->flags = buf[ML_OFF_FLAGS];
+    pkt->ack_seq = ml_get_le32(buf + ML_OFF_ACK_SEQ);
+    pkt->ack_bitmap = ml_get_le32(buf + ML_OFF_ACK_BITMAP);
+    pkt->conn_id = ml_get_le32(buf + ML_OFF_CONN_ID);
+    pkt->resume_token = ml_get_le64(buf + ML_OFF_RESUME_TOKEN);
+
+    memcpy(pkt->rover_id, buf + ML_OFF_ROVER_ID, sizeof(pkt->rover_id));
+    memcpy(pkt->mission_id, buf + ML_OFF_MISSION_ID, sizeof(pkt->mission_id));
+    memcpy(pkt->task_type, buf + ML_OFF_TASK_TYPE, sizeof(pkt->task_type));
+    pkt->rover_id[sizeof(pkt->rover_id) - 1] = '\0';
+    pkt->mission_id[sizeof(pkt->mission_id) - 1] = '\0';
+    pkt->task_type[sizeof(pkt->task_type) - 1] = '\0';
+
+    pkt->mission_x1 = ml_get_lef32(buf + ML_OFF_MISSION_X1);
+    pkt->mission_y1 = ml_get_lef32(buf + ML_OFF_MISSION_Y1);
+    pkt->mission_x2 = ml_get_lef32(buf + ML_OFF_MISSION_X2);
+    pkt->mission_y2 = ml_get_lef32(buf + ML_OFF_MISSION_Y2);
+    pkt->mission_duration = ml_get_le32(buf + ML_OFF_DURATION);
+    pkt->update_interval = ml_get_le32(buf + ML_OFF_UPDATE_INTERVAL);
+    pkt->queue_depth = ml_view_queue_depth(view);
+}
+
+const char *ml_wire_status_name(MLWireStatus status) {
+    switch (status) {
+        case ML_WIRE_OK:          return "OK";
+        case ML_WIRE_TRUNCATED:   return "truncado";
+        case ML_WIRE_BAD_VERSION: return "versão inválida";
+        case ML_WIRE_BAD_CRC:     return "CRC inválido";
+        default:                  return "?";
+    }
+}
@@ -1,50 +1,366 @@
 // ============ Nave-Mae.c (COM API DE OBSERVAÇÃO) ============
 // Servidor MissionLink + TelemetryStream + API REST
 #include "MissionLink.h"
+#include "MissionLinkARQ.h"
+#include "MissionLinkWire.h"
+#include "MissionLinkFrag.h"
+#include "ResultTransfer.h"
 #include "Server_management.h"
 #include "Heartbeat.h"
 #include "TelemetryStream.h"
 #include "API_Observation.h"
+#include "API_Workers.h"
+#include "TelemetryHistory.h"
+#include "TelemetryStore.h"
+#include "TelemetryRate.h"
+#include "RoverRegistry.h"
+#include "EventLog.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <unistd.h>
 #include <sys/select.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <endian.h>
 
-extern RoverSession sessions[MAX_ROVERS];
-extern int num_sessions;
 extern MissionRecord missions[MAX_MISSIONS];
 extern int num_missions;
 
-int find_rover_index(const char *rover_id)
+// ============ TEMPORIZADORES MISSIONLINK ============
+// ACKs atrasados, retransmissões dos pacotes da Nave-Mãe e eventos de
+// heartbeat correm numa roda de temporizadores avançada pelo ciclo
+// select(): nada bloqueia à espera de um ACK e nada percorre a frota.
+// O ACK é cumulativo, por isso esperar até ARQ_ACK_DELAY_MS deixa um
+// único datagrama confirmar vários pacotes, ou seguir de graça na
+// próxima ASSIGN.
+static TimerWheel server_timers;
+
+// Snapshot para os workers HTTP a cadência fixa, não a cada wakeup do
+// select() (copiar as vistas de todos os rovers e as missões custa)
+static Timer snapshot_timer;
+
+static void on_snapshot_timer(Timer *timer, void *arg)
+{
+    (void)arg;
+    api_publish_snapshot(missions, num_missions);
+    timer_arm(&server_timers, timer, arq_now_ms() + API_SNAPSHOT_INTERVAL_MS);
+}
+
+static void send_link_ack(RoverEntity *rover)
+{
+    Packet ack;
+    arq_receiver_ack(&rover->link_rx, rover->ack_trigger, &ack);
+    ack.conn_id = rover->conn_id;
+    ml_wire_send(rover->link_tx.sockfd, &ack, &rover->link_tx.peer);
+    rover->ack_pending = 0;
+    timer_cancel(&server_timers, &rover->ack_timer);
+
+    print_timestamp();
+    printf("✓ ACK enviado a %s (até seq=%u)\n\n", rover->rover_id, ack.ack_seq - 1);
+}
+
+static void on_ack_timer(Timer *timer, void *arg)
+{
+    RoverEntity *rover = arg;
+    (void)timer;
+    if (rover->ack_pending > 0)
+        send_link_ack(rover);
+}
+
+// Rearmar pelo pacote em voo mais urgente (desarmar se não há nenhum)
+static void link_tx_rearm(RoverEntity *rover, uint64_t now_ms)
+{
+    int wait = arq_sender_next_timeout(&rover->link_tx, now_ms);
+    if (wait < 0)
+        timer_cancel(&server_timers, &rover->link_tx_timer);
+    else
+        timer_arm(&server_timers, &rover->link_tx_timer, now_ms + (uint64_t)wait);
+}
+
+// Enviar um pacote fiável ao rover, já com o ACK de tudo o que chegou
+static int link_send(RoverEntity *rover, Packet *pkt)
 {
-    for (int i = 0; i < num_sessions; i++)
+    arq_receiver_piggyback(&rover->link_rx, pkt);
+    if (arq_send(&rover->link_tx, pkt) < 0)
+        return -1;
+
+    rover->ack_pending = 0;
+    timer_cancel(&server_timers, &rover->ack_timer);
+    link_tx_rearm(rover, arq_now_ms());
+    return 0;
+}
+
+// Registar uma missão retirada; com notify o rover é avisado com
+// MISSION_REVOKE (fiável)
+static void announce_revoked(RoverEntity *rover, const MissionRecord *mission, int notify,
+                             const char *reason)
+{
+    print_timestamp();
+    printf("🚫 Missão %s retirada a %s (%s)\n", mission->mission_id, rover->rover_id, reason);
+    event_log_emit(EVENT_WARNING, rover->rover_id, "mission_revoked", "%s: %s",
+                   mission->mission_id, reason);
+
+    if (!notify || !rover->has_link_tx || !arq_sender_window_open(&rover->link_tx))
+        return;
+
+    Packet revoke;
+    memset(&revoke, 0, sizeof(revoke));
+    revoke.type = PKT_MISSION_REVOKE;
+    revoke.conn_id = rover->conn_id;
+    snprintf(revoke.rover_id, sizeof(revoke.rover_id), "%s", rover->rover_id);
+    snprintf(revoke.mission_id, sizeof(revoke.mission_id), "%s", mission->mission_id);
+    link_send(rover, &revoke);
+}
+
+// Retirar as missões em fila de um rover (e a ativa, com include_active);
+// com notify o rover é avisado com MISSION_REVOKE (um rover reiniciado já
+// não as tem)
+static void revoke_missions(RoverEntity *rover, int include_active, int notify,
+                           const char *reason)
+{
+    MissionRecord *revoked[MISSION_QUEUE_MAX + 1];
+    int n = revoke_rover_missions(rover->rover_id, include_active, revoked,
+                                  MISSION_QUEUE_MAX + 1);
+
+    for (int i = 0; i < n; i++)
+        announce_revoked(rover, revoked[i], notify, reason);
+
+    if (n > 0)
     {
-        if (strcmp(sessions[i].rover_id, rover_id) == 0)
-        {
-            return i;
-        }
+        rover->link.mission_id[0] = '\0';
+        printf("\n");
+        print_mission_status();
     }
-    return -1;
 }
 
-void handle_mission_request(int sockfd, Packet *buffer, struct sockaddr_in *client_addr,
-                            socklen_t addr_len, HeartbeatState *heartbeat_states)
+// Heartbeat: rover inativo não vai começar as missões que tem em fila
+static void on_rover_inactive(RoverEntity *rover)
+{
+    revoke_missions(rover, 0, 1, "rover inativo");
+}
+
+// Pedido recusado por agora: MISSION_DEFER (não fiável, confirma o
+// REQUEST) para o rover voltar a pedir mais tarde. Fica em cache como a
+// resposta ao REQUEST, para os duplicados a reenviarem
+static void defer_mission_request(RoverEntity *rover, const Packet *request)
+{
+    Packet defer;
+    memset(&defer, 0, sizeof(defer));
+    defer.type = PKT_MISSION_DEFER;
+    defer.seq = request->seq;
+    defer.conn_id = rover->conn_id;
+    snprintf(defer.rover_id, sizeof(defer.rover_id), "%s", rover->rover_id);
+
+    arq_receiver_piggyback(&rover->link_rx, &defer);
+    ml_wire_send(rover->link_tx.sockfd, &defer, &rover->link_tx.peer);
+    rover->ack_pending = 0;
+    timer_cancel(&server_timers, &rover->ack_timer);
+
+    rover->last_assign = defer;
+    rover->last_assign_request = request->seq;
+    rover->has_last_assign = 1;
+
+    print_timestamp();
+    printf("⏸  MISSION_DEFER enviado a %s (REQUEST seq=%u)\n\n", rover->rover_id, request->seq);
+}
+
+// Stream da Nave-Mãe reiniciado: as ASSIGN abandonadas deixam de segurar
+// as missões (o rover é avisado no stream novo, caso alguma lhe tenha
+// chegado) e um REQUEST que só elas respondiam passa a ser adiado
+static void link_tx_reset(RoverEntity *rover, char (*dropped)[32], int n_dropped)
+{
+    int answered = 0;
+    for (int i = 0; i < n_dropped; i++)
+    {
+        MissionRecord *mission = revoke_reserved_mission(dropped[i]);
+        if (mission)
+            announce_revoked(rover, mission, 1, "ASSIGN sem confirmação");
+        if (rover->has_last_assign && rover->last_assign.type == PKT_MISSION_ASSIGN &&
+            strcmp(rover->last_assign.mission_id, dropped[i]) == 0)
+            answered = 1;
+    }
+    if (n_dropped > 0)
+    {
+        printf("\n");
+        print_mission_status();
+    }
+
+    if (answered)
+    {
+        Packet request;
+        memset(&request, 0, sizeof(request));
+        request.seq = rover->last_assign_request;
+        defer_mission_request(rover, &request);
+    }
+}
+
+static void on_link_tx_timer(Timer *timer, void *arg)
+{
+    RoverEntity *rover = arg;
+    uint64_t now_ms = arq_now_ms();
+    (void)timer;
+
+    // ASSIGNs em voo: perdem-se se o emissor desistir e reiniciar o stream
+    char dropped[ARQ_WINDOW][32];
+    int n_dropped = 0;
+    for (int i = 0; i < ARQ_WINDOW; i++)
+    {
+        const ArqSlot *slot = &rover->link_tx.slots[i];
+        if (slot->in_use && slot->pkt.type == PKT_MISSION_ASSIGN)
+            memcpy(dropped[n_dropped++], slot->pkt.mission_id, sizeof(dropped[0]));
+    }
+
+    if (arq_sender_poll(&rover->link_tx, now_ms) < 0)
+    {
+        print_timestamp();
+        printf("✗ %s não confirmou os pacotes da Nave-Mãe - stream reiniciado\n\n",
+               rover->rover_id);
+        link_tx_reset(rover, dropped, n_dropped);
+    }
+    link_tx_rearm(rover, now_ms);
+}
+
+// Preparar o emissor e os temporizadores do rover; um SYN com outro nonce
+// é um rover reiniciado: o que estava em voo era para a instância anterior
+// Devolve 1 nesse caso, 0 caso contrário
+static int link_attach(int sockfd, RoverEntity *rover, const PacketView *pkt)
+{
+    int restarted = 0;
+
+    if (!rover->has_link_tx)
+    {
+        timer_init(&rover->ack_timer, on_ack_timer, rover);
+        timer_init(&rover->link_tx_timer, on_link_tx_timer, rover);
+        arq_sender_init(&rover->link_tx, sockfd, &rover->link.addr, 1);
+        rover->has_link_tx = 1;
+
+        // O RTT medido pelo heartbeat serve de partida ao timeout das ASSIGN
+        if (rover->heartbeat.rtt.samples > 0)
+            rover->link_tx.rtt = rover->heartbeat.rtt;
+    }
+    else if ((ml_view_flags(pkt) & ML_FLAG_SYN) && rover->link_rx.synced &&
+             ml_view_nonce(pkt) != rover->link_rx.stream_nonce)
+    {
+        timer_cancel(&server_timers, &rover->link_tx_timer);
+        arq_sender_init(&rover->link_tx, sockfd, &rover->link.addr, rover->link_tx.next_seq);
+        restarted = 1;
+    }
+    rover->link_tx.peer = rover->link.addr;
+    return restarted;
+}
+
+// ============ IDENTIDADE DA CONEXÃO ============
+// O rover é identificado pelo ID de conexão do pacote, não pelo endereço
+// nem pelo rover_id; os SYN (stream novo: handshake feito ou rover
+// reiniciado) têm ainda de trazer o token de retoma. Caso contrário a
+// Nave-Mãe não conhece a conexão (p.ex. reiniciou): pedir novo handshake.
+
+static void send_handshake_reply(int sockfd, uint8_t status, uint32_t conn_id, uint64_t token,
+                                 struct sockaddr_in *client_addr, socklen_t addr_len)
+{
+    MLHandshakeReply reply;
+    memset(&reply, 0, sizeof(reply));
+    reply.type = ML_HANDSHAKE;
+    reply.status = status;
+    reply.conn_id = htole32(conn_id);
+    reply.resume_token = htole64(token);
+    sendto(sockfd, &reply, sizeof(reply), 0, (struct sockaddr *)client_addr, addr_len);
+}
+
+// Handshake: emitir um ID de conexão e um token de retoma novos (o par
+// anterior deixa de valer; nunca é devolvido a quem só sabe o rover_id).
+// Uma conexão ainda ativa só é substituída por quem traz o token dela
+void handle_handshake(int sockfd, const MLHandshake *hello, struct sockaddr_in *client_addr,
+                      socklen_t addr_len)
+{
+    char rover_id[sizeof(hello->rover_id) + 1];
+    snprintf(rover_id, sizeof(rover_id), "%.*s", (int)sizeof(hello->rover_id), hello->rover_id);
+
+    RoverEntity *rover = rover_registry_find(rover_id);
+    if (rover && rover->has_link && !rover->heartbeat.expired &&
+        le64toh(hello->resume_token) != rover->resume_token)
+    {
+        print_timestamp();
+        printf("⚠  Handshake de %s recusado: conexão %08x ativa e token errado\n\n",
+               rover->rover_id, rover->conn_id);
+        send_handshake_reply(sockfd, ML_HS_BUSY, 0, 0, client_addr, addr_len);
+        return;
+    }
+
+    if (!rover)
+        rover = rover_registry_get(rover_id);
+    if (!rover)
+        return;
+    rover_registry_issue_conn(rover);
+    send_handshake_reply(sockfd, ML_HS_OK, rover->conn_id, rover->resume_token,
+                         client_addr, addr_len);
+
+    print_timestamp();
+    printf("🤝 Handshake de %s: conexão %08x\n\n", rover->rover_id, rover->conn_id);
+}
+
+// Entidade da conexão do pacote, ou NULL (e ML_HS_RETRY ao rover)
+static RoverEntity *resolve_connection(int sockfd, const PacketView *buffer,
+                                       struct sockaddr_in *client_addr, socklen_t addr_len)
+{
+    uint32_t conn_id = ml_view_conn_id(buffer);
+    RoverEntity *rover = rover_registry_by_conn(conn_id);
+    if (rover &&
+        strncmp(rover->rover_id, ml_view_rover_id(buffer), sizeof(rover->rover_id)) == 0 &&
+        (!(ml_view_flags(buffer) & ML_FLAG_SYN) ||
+         ml_view_resume_token(buffer) == rover->resume_token))
+        return rover;
+
+    print_timestamp();
+    printf("⚠  Conexão %08x desconhecida (%.32s) - handshake pedido\n",
+           conn_id, ml_view_rover_id(buffer));
+    send_handshake_reply(sockfd, ML_HS_RETRY, conn_id, 0, client_addr, addr_len);
+    return NULL;
+}
+
+// ACK do rover aos pacotes da Nave-Mãe
+void handle_link_ack(int sockfd, const PacketView *buffer, struct sockaddr_in *client_addr,
+                     socklen_t addr_len)
+{
+    RoverEntity *rover = resolve_connection(sockfd, buffer, client_addr, addr_len);
+    if (!rover || !rover->has_link_tx)
+        return;
+
+    arq_sender_on_ack(&rover->link_tx, buffer);
+    link_tx_rearm(rover, arq_now_ms());
+}
+
+void handle_mission_request(RoverEntity *rover, Packet *buffer)
 {
     print_timestamp();
     printf("🔨 MISSION_REQUEST recebido\n");
     print_packet_info(buffer);
 
-    send_ack_packet(sockfd, client_addr, buffer->seq);
-    print_timestamp();
-    printf("✓ ACK enviado\n\n");
+    rover->link.last_seq = buffer->seq;
 
-    RoverSession *rover = register_or_update_rover(buffer->rover_id, client_addr);
-    if (!rover)
+    // Janela cheia: o rover ainda não confirmou ASSIGNs anteriores
+    if (!arq_sender_window_open(&rover->link_tx))
     {
         print_timestamp();
-        printf("✗ Não foi possível registar rover\n\n");
+        printf("⚠  %s com %d ASSIGN por confirmar - pedido adiado\n",
+               rover->rover_id, ARQ_WINDOW);
+        defer_mission_request(rover, buffer);
+        return;
+    }
+
+    // Fila concedida: a pedida, até MISSION_QUEUE_MAX. O rover pode ter a
+    // missão em curso e mais grant reservadas para ele
+    uint8_t grant = buffer->queue_depth < MISSION_QUEUE_MAX ? buffer->queue_depth
+                                                             : MISSION_QUEUE_MAX;
+    rover->queue_depth = grant;
+    if (count_open_missions(rover->rover_id) >= grant + 1)
+    {
+        print_timestamp();
+        printf("⚠  %s já tem %d missões em aberto - pedido adiado\n",
+               rover->rover_id, grant + 1);
+        defer_mission_request(rover, buffer);
         return;
     }
 
@@ -55,10 +371,10 @@ void handle_mission_request(int sockfd, Packet *buffer, struct sockaddr_in *clie
     Packet assign;
     memset(&assign, 0, sizeof(assign));
     assign.type = PKT_MISSION_ASSIGN;
-    assign.seq = buffer->seq + 1;
     assign.battery = 100;
     assign.progress = 0;
     assign.nonce = rand() % 100000;
+    assign.conn_id = rover->conn_id;
 
     strncpy(assign.rover_id, buffer->rover_id, sizeof(assign.rover_id) - 1);
     strncpy(assign.mission_id, mission->mission_id, sizeof(assign.mission_id) - 1);
@@ -70,120 +386,240 @@ void handle_mission_request(int sockfd, Packet *buffer, struct sockaddr_in *clie
     assign.mission_y2 = mission->y2;
     assign.mission_duration = mission->duration;
     assign.update_interval = mission->update_interval;
+    assign.queue_depth = grant;
 
-    ssize_t sent = sendto(sockfd, &assign, sizeof(assign), 0,
-                          (struct sockaddr *)client_addr, addr_len);
+    // Fiável: fica na janela do rover, retransmitida pela roda de
+    // temporizadores até ao ACK; também confirma o REQUEST (piggyback)
+    link_send(rover, &assign);
 
-    if (sent > 0)
-    {
-        print_timestamp();
-        printf("🔤 MISSION_ASSIGN enviada\n");
-        print_packet_info(&assign);
-        printf("\n");
+    print_timestamp();
+    printf("🔤 MISSION_ASSIGN enviada (%u por confirmar)\n",
+           arq_sender_in_flight(&rover->link_tx));
+    print_packet_info(&assign);
+    printf("\n");
 
-        rover->last_seq = assign.seq;
-        strncpy(rover->mission_id, mission->mission_id, sizeof(rover->mission_id) - 1);
-        strncpy(rover->task_type, mission->task_type, sizeof(rover->task_type) - 1);
+    rover->last_assign = assign;
+    rover->last_assign_request = buffer->seq;
+    rover->has_last_assign = 1;
 
-        print_mission_status();
-        print_rover_status();
-    }
+    print_mission_status();
+    print_rover_status();
 }
 
-void handle_progress(int sockfd, Packet *buffer, struct sockaddr_in *client_addr,
-                     socklen_t addr_len, HeartbeatState *heartbeat_states)
+void handle_progress(RoverEntity *rover, Packet *buffer)
 {
     print_timestamp();
     printf("🔨 PROGRESS recebido\n");
     print_packet_info(buffer);
 
-    send_ack_packet(sockfd, client_addr, buffer->seq);
-    print_timestamp();
-    printf("✓ ACK enviado\n\n");
-
-    RoverSession *rover = register_or_update_rover(buffer->rover_id, client_addr);
-    if (!rover)
-        return;
+    rover->link.last_seq = buffer->seq;
+    rover->link.progress = buffer->progress;
+    rover->link.last_update = time(NULL);
+    rover_registry_set_battery(rover, buffer->battery);
+    heartbeat_seen(rover);
 
-    if (buffer->seq > rover->last_seq)
+    // A missão começa no primeiro PROGRESS (até lá está reservada na fila)
+    MissionRecord *mission = add_or_update_mission(buffer->mission_id, buffer->progress,
+                                                   buffer->battery);
+    if (!mission)
     {
-        rover->last_seq = buffer->seq;
-        rover->battery = buffer->battery;
-        rover->progress = buffer->progress;
-        rover->last_update = time(NULL);
-
-        int idx = find_rover_index(buffer->rover_id);
-        if (idx >= 0)
-        {
-            heartbeat_states[idx].last_pong_received = time(NULL);
-            heartbeat_states[idx].consecutive_missed_pongs = 0;
-            heartbeat_states[idx].is_healthy = 1;
-        }
-
-        add_or_update_mission(buffer->mission_id, buffer->progress, buffer->battery);
-        print_mission_status();
-        print_rover_status();
+        print_timestamp();
+        printf("⚠  Missão %s retirada ou desconhecida - PROGRESS ignorado\n\n",
+               buffer->mission_id);
+        return;
     }
+    snprintf(rover->link.mission_id, sizeof(rover->link.mission_id), "%s", mission->mission_id);
+    snprintf(rover->link.task_type, sizeof(rover->link.task_type), "%s", mission->task_type);
+
+    print_mission_status();
+    print_rover_status();
 }
 
-void handle_complete(int sockfd, Packet *buffer, struct sockaddr_in *client_addr,
-                     socklen_t addr_len, HeartbeatState *heartbeat_states)
+void handle_complete(RoverEntity *rover, Packet *buffer)
 {
     print_timestamp();
     printf("🔨 COMPLETE recebido\n");
     print_packet_info(buffer);
 
-    send_ack_packet(sockfd, client_addr, buffer->seq);
-    print_timestamp();
-    printf("✓ ACK enviado\n\n");
+    rover->link.last_seq = buffer->seq;
+    rover->link.progress = 100;
+    rover->link.last_update = time(NULL);
+    rover_registry_set_battery(rover, buffer->battery);
+    heartbeat_seen(rover);
 
-    RoverSession *rover = register_or_update_rover(buffer->rover_id, client_addr);
-    if (!rover)
+    if (mark_mission_complete(buffer->mission_id) < 0)
+    {
+        print_timestamp();
+        printf("⚠  Missão %s retirada ou desconhecida - COMPLETE ignorado\n\n",
+               buffer->mission_id);
         return;
+    }
+    add_or_update_mission(buffer->mission_id, 100, buffer->battery);
+
+    print_timestamp();
+    printf("✅ MISSÃO CONCLUÍDA: %s\n\n", buffer->mission_id);
 
-    if (buffer->seq > rover->last_seq)
+    print_mission_status();
+    print_rover_status();
+}
+
+// Retransmissão de um pacote já recebido (o ACK perdeu-se): repetir já o
+// ACK, ou, para um MISSION_REQUEST, a resposta em cache (ASSIGN ou DEFER,
+// que o confirma), sem tocar no estado das missões
+static void replay_duplicate(int sockfd, RoverEntity *rover, const PacketView *buffer,
+                             const Packet *ack, struct sockaddr_in *client_addr)
+{
+    if (ml_view_type(buffer) == PKT_MISSION_REQUEST && rover->has_last_assign &&
+        rover->last_assign_request == ml_view_seq(buffer))
     {
-        rover->last_seq = buffer->seq;
-        rover->battery = buffer->battery;
-        rover->progress = 100;
-        rover->last_update = time(NULL);
+        ml_wire_send(sockfd, &rover->last_assign, client_addr);
+        if (rover->last_assign.ack_seq == rover->link_rx.expected)
+            return;                   // A ASSIGN em cache já confirma tudo
+    }
 
-        int idx = find_rover_index(buffer->rover_id);
-        if (idx >= 0)
-        {
-            heartbeat_states[idx].last_pong_received = time(NULL);
-            heartbeat_states[idx].consecutive_missed_pongs = 0;
-            heartbeat_states[idx].is_healthy = 1;
-        }
+    ml_wire_send(sockfd, ack, client_addr);
+    rover->ack_pending = 0;
+    timer_cancel(&server_timers, &rover->ack_timer);
+}
+
+// Pacotes de dados do rover (REQUEST, PROGRESS, COMPLETE): passam pela
+// janela de receção e só são processados por ordem, uma única vez
+void handle_mission_link_data(int sockfd, const PacketView *buffer,
+                              struct sockaddr_in *client_addr, socklen_t addr_len)
+{
+    RoverEntity *known = resolve_connection(sockfd, buffer, client_addr, addr_len);
+    if (!known)
+        return;
 
-        mark_mission_complete(buffer->mission_id);
-        add_or_update_mission(buffer->mission_id, 100, buffer->battery);
+    // Duplicados reconhecidos logo pelo bitmap da janela: uma procura
+    // direta pelo ID de conexão e um sendto, sem logs, sem estado de missão
+    Packet ack;
+    if (known->has_link && arq_receiver_duplicate(&known->link_rx, buffer, &ack))
+    {
+        ack.conn_id = known->conn_id;
+        replay_duplicate(sockfd, known, buffer, &ack, client_addr);
+        return;
+    }
 
+    RoverEntity *rover = register_or_update_rover(known->rover_id, client_addr);
+    if (!rover)
+    {
         print_timestamp();
-        printf("✅ MISSÃO CONCLUÍDA: %s\n\n", buffer->mission_id);
+        printf("✗ Não foi possível registar rover\n\n");
+        return;
+    }
 
-        print_mission_status();
-        print_rover_status();
+    // Rover reiniciado: a fila e a missão em curso perderam-se com ele
+    if (link_attach(sockfd, rover, buffer))
+        revoke_missions(rover, 1, 0, "rover reiniciado");
+
+    Packet *delivered[ARQ_WINDOW];
+    int n = arq_receiver_accept(&rover->link_rx, buffer, delivered, ARQ_WINDOW, &ack);
+    if (ack.type != PKT_ACK)
+        return;                       // Fora da janela ou sem SYN: sem ACK
+
+    rover->ack_trigger = ml_view_seq(buffer);
+    rover->ack_pending += n;
+
+    for (int i = 0; i < n; i++)
+    {
+        switch (delivered[i]->type)
+        {
+        case PKT_MISSION_REQUEST:
+            handle_mission_request(rover, delivered[i]);
+            break;
+        case PKT_PROGRESS:
+            handle_progress(rover, delivered[i]);
+            break;
+        case PKT_COMPLETE:
+            handle_complete(rover, delivered[i]);
+            break;
+        default:
+            break;
+        }
     }
+
+    // Fora de ordem: o emissor precisa já do bitmap para não retransmitir
+    // o que chegou. Caso contrário, ACK a cada ARQ_ACK_EVERY pacotes ou
+    // quando o atraso vence (a menos que uma ASSIGN o tenha levado)
+    if (n == 0 || rover->ack_pending >= ARQ_ACK_EVERY)
+        send_link_ack(rover);
+    else if (rover->ack_pending > 0 && !timer_armed(&rover->ack_timer))
+        timer_arm(&server_timers, &rover->ack_timer, arq_now_ms() + ARQ_ACK_DELAY_MS);
 }
 
-void handle_pong(Packet *buffer, struct sockaddr_in *client_addr,
-                 HeartbeatState *heartbeat_states)
+void handle_pong(int sockfd, const PacketView *buffer, struct sockaddr_in *client_addr,
+                 socklen_t addr_len)
 {
     print_timestamp();
-    printf("🔔 PONG recebido de %s\n", buffer->rover_id);
+    printf("🔔 PONG recebido de %.32s\n", ml_view_rover_id(buffer));
+
+    RoverEntity *known = resolve_connection(sockfd, buffer, client_addr, addr_len);
+    if (!known)
+        return;
 
-    RoverSession *rover = register_or_update_rover(buffer->rover_id, client_addr);
+    RoverEntity *rover = register_or_update_rover(known->rover_id, client_addr);
     if (rover)
     {
-        int idx = find_rover_index(buffer->rover_id);
-        if (idx >= 0)
-        {
-            process_pong(rover, &heartbeat_states[idx]);
-        }
+        process_pong(rover, buffer);
     }
 }
 
+// ============ RESULTADOS DE MISSÃO ============
+// Imagens e análises chegam pelo canal TCP de resultados (ResultTransfer)
+// ou, as pequenas, em fragmentos pela porta MissionLink; cada mensagem
+// fragmentada completa é guardada uma vez em RESULTS_DIR.
+static FragReassembler frag_rx;
+
+// Oferta do canal de resultados: só com a conexão MissionLink do rover
+static int authorize_result_offer(const ResultOffer *offer)
+{
+    RoverEntity *rover = rover_registry_by_conn(offer->conn_id);
+    return rover && rover->resume_token == offer->resume_token &&
+           strncmp(rover->rover_id, offer->rover_id, sizeof(rover->rover_id)) == 0;
+}
+
+static void deliver_mission_result(const FragHeader *hdr, const uint8_t *data)
+{
+    // O rover_id é o da conexão (verificado à entrada); ambos acabam no
+    // nome do ficheiro, logo nada de '/' nem "..": mesma regra do canal TCP
+    RoverEntity *rover = rover_registry_by_conn(hdr->conn_id);
+    if (!rover)
+        return;
+    char rover_id[33], mission_id[33];
+    snprintf(rover_id, sizeof(rover_id), "%.32s", rover->rover_id);
+    snprintf(mission_id, sizeof(mission_id), "%.32s", hdr->mission_id);
+    if (!result_valid_name(rover_id, sizeof(rover_id)) ||
+        (mission_id[0] && !result_valid_name(mission_id, sizeof(mission_id))))
+    {
+        print_timestamp();
+        printf("⚠  Resultado de %s com nome inválido - descartado\n", rover_id);
+        return;
+    }
+
+    char path[160];
+    snprintf(path, sizeof(path), "%s/%s_%s_%u.%s", RESULTS_DIR, rover_id,
+             mission_id[0] ? mission_id : "none", hdr->msg_id,
+             result_extension(hdr->content_type));
+
+    FILE *f = fopen(path, "wb");
+    if (!f || fwrite(data, 1, hdr->total_len, f) != hdr->total_len)
+    {
+        print_timestamp();
+        printf("❌ Erro ao guardar resultado de %s em %s\n", rover_id, path);
+        if (f)
+            fclose(f);
+        return;
+    }
+    fclose(f);
+
+    print_timestamp();
+    printf("📦 Resultado da missão %s recebido de %s: %u bytes → %s\n",
+           mission_id, rover_id, hdr->total_len, path);
+    event_log_emit(EVENT_INFO, rover_id, "mission_result", "%s: %u bytes em %s",
+                   mission_id, hdr->total_len, path);
+}
+
 int main(void)
 {
     srand(time(NULL));
@@ -203,6 +639,14 @@ int main(void)
         return 1;
     }
 
+    // ===== SOCKET UDP (Telemetria rápida, opcional) =====
+    int telemetry_udp_fd = create_telemetry_udp_server(TELEMETRY_UDP_PORT);
+    if (telemetry_udp_fd < 0)
+    {
+        print_timestamp();
+        printf("⚠  Canal UDP de telemetria indisponível - apenas TCP\n\n");
+    }
+
     // ===== SOCKET HTTP (API de Observação) =====
     int api_fd = create_http_server(API_PORT);
     if (api_fd < 0)
@@ -216,25 +660,62 @@ int main(void)
 
     init_server_tables();
 
-    Packet buffer;
-    HeartbeatState heartbeat_states[MAX_ROVERS];
-    memset(heartbeat_states, 0, sizeof(heartbeat_states));
+    // ===== HISTÓRICO DE TELEMETRIA (capacidade configurável) =====
+    const char *history_env = getenv("TELEMETRY_HISTORY_CAPACITY");
+    telemetry_history_init(history_env ? (size_t)strtoul(history_env, NULL, 10)
+                                       : TELEMETRY_HISTORY_DEFAULT_CAPACITY);
 
-    TelemetrySession telemetry_sessions[MAX_TELEMETRY_CONNECTIONS];
-    int telemetry_count = 0;
-    memset(telemetry_sessions, 0, sizeof(telemetry_sessions));
+    // ===== ARMAZENAMENTO PERSISTENTE DE TELEMETRIA =====
+    // Sem replay: o índice e a contagem vêm dos cabeçalhos dos segmentos
+    if (telemetry_store_open(TELEMETRY_STORE_DIR) < 0)
+    {
+        print_timestamp();
+        printf("⚠  Armazenamento de telemetria indisponível - apenas histórico em memória\n\n");
+    }
+
+    // ===== POOL HTTP (renderização fora do ciclo MissionLink) =====
+    if (api_workers_start() < 0)
+    {
+        print_timestamp();
+        printf("❌ Erro ao iniciar workers HTTP\n");
+        close(sockfd);
+        close(telemetry_fd);
+        close(api_fd);
+        return 1;
+    }
+
+    MissionLinkDatagram buffer;
+    TelemetryPool telemetry_pool;
+    telemetry_pool_init(&telemetry_pool);
+
+    timer_wheel_init(&server_timers, arq_now_ms());
+    heartbeat_init(&server_timers, sockfd, on_rover_inactive);
+    timer_init(&snapshot_timer, on_snapshot_timer, NULL);
+    timer_arm(&server_timers, &snapshot_timer, arq_now_ms());
 
-    // ===== HTTP CLIENTS =====
-    int api_clients[MAX_HTTP_CLIENTS];
-    int api_client_count = 0;
-    memset(api_clients, 0, sizeof(api_clients));
+    if (mkdir(RESULTS_DIR, 0755) < 0 && errno != EEXIST)
+        perror("mkdir resultados de missão");
+    frag_reassembler_init(&frag_rx, sockfd, &server_timers, deliver_mission_result);
+
+    // ===== SOCKET TCP (Resultados de missão, opcional) =====
+    ResultServer result_server;
+    if (result_server_init(&result_server, RESULT_PORT, authorize_result_offer) < 0)
+    {
+        print_timestamp();
+        printf("⚠  Canal de resultados indisponível - apenas fragmentos MissionLink\n\n");
+    }
 
-    time_t last_heartbeat_check = time(NULL);
+    time_t last_status_report = time(NULL);
+    time_t last_store_maintenance = time(NULL);
+    time_t last_telemetry_reap = time(NULL);
 
     print_timestamp();
     printf("🚀 Servidor Nave-Mãe iniciado\n");
-    printf("   MissionLink (UDP): porta %d\n", PORT);
+    printf("   MissionLink (UDP): porta %d (formato v%d, CRC32C %s)\n", PORT,
+           ML_WIRE_VERSION, crc32c_impl());
     printf("   TelemetryStream (TCP): porta %d\n", TELEMETRY_PORT);
+    printf("   Telemetria rápida (UDP): porta %d\n", TELEMETRY_UDP_PORT);
+    printf("   Resultados (TCP): porta %d\n", RESULT_PORT);
     printf("   API Observação (HTTP): porta %d\n", API_PORT);
     printf("🚀 Aguardando conexões de rovers...\n");
     printf("🔔 Sistema de Heartbeat ativado (intervalo: %d segundos)\n\n", HEARTBEAT_INTERVAL);
@@ -243,8 +724,20 @@ int main(void)
     {
         socklen_t addr_len = sizeof(client_addr);
 
+        // ===== TEMPORIZADORES (ACKs atrasados, retransmissões, heartbeat) =====
+        // Inclui a publicação do snapshot para os workers HTTP: os workers
+        // nunca tocam nas tabelas vivas, por isso o ciclo nunca espera por eles
+        uint64_t link_now_ms = arq_now_ms();
+        timer_wheel_advance(&server_timers, link_now_ms);
+        int timer_wait = timer_wheel_next_timeout(&server_timers, link_now_ms);
+
         // ===== SELECT: Monitorizar todos os sockets =====
         struct timeval tv = {1, 0};
+        if (timer_wait >= 0 && timer_wait < 1000)
+        {
+            tv.tv_sec = 0;
+            tv.tv_usec = timer_wait * 1000;
+        }
         fd_set readfds;
         FD_ZERO(&readfds);
         FD_SET(sockfd, &readfds);       // UDP
@@ -254,28 +747,25 @@ int main(void)
         int max_fd = sockfd > telemetry_fd ? sockfd : telemetry_fd;
         max_fd = max_fd > api_fd ? max_fd : api_fd;
 
-        // Adicionar sockets ativos de telemetria
-        for (int i = 0; i < telemetry_count; i++)
+        if (telemetry_udp_fd >= 0)
         {
-            if (telemetry_sessions[i].sockfd > 0)
-            {
-                FD_SET(telemetry_sessions[i].sockfd, &readfds);
-                if (telemetry_sessions[i].sockfd > max_fd)
-                {
-                    max_fd = telemetry_sessions[i].sockfd;
-                }
-            }
+            FD_SET(telemetry_udp_fd, &readfds); // UDP Telemetria
+            if (telemetry_udp_fd > max_fd) max_fd = telemetry_udp_fd;
         }
 
-        // Adicionar sockets ativos de HTTP
-        for (int i = 0; i < api_client_count; i++)
+        // Canal de resultados e transferências em curso
+        result_server_fill_fdset(&result_server, &readfds, &max_fd);
+
+        // Adicionar sockets ativos de telemetria
+        for (size_t i = 0; i < telemetry_pool.used; i++)
         {
-            if (api_clients[i] > 0)
+            TelemetrySession *ts = telemetry_pool_at(&telemetry_pool, i);
+            if (ts->active && ts->sockfd > 0)
             {
-                FD_SET(api_clients[i], &readfds);
-                if (api_clients[i] > max_fd)
+                FD_SET(ts->sockfd, &readfds);
+                if (ts->sockfd > max_fd)
                 {
-                    max_fd = api_clients[i];
+                    max_fd = ts->sockfd;
                 }
             }
         }
@@ -283,61 +773,45 @@ int main(void)
         int rv = select(max_fd + 1, &readfds, NULL, NULL, &tv);
 
         time_t now = time(NULL);
-        if (now - last_heartbeat_check >= HEARTBEAT_INTERVAL)
+        // Relatório periódico (os PINGs seguem os temporizadores de cada rover)
+        if (now - last_status_report >= HEARTBEAT_INTERVAL)
         {
-            print_timestamp();
-            printf("🔔 Verificando saúde dos rovers...\n");
-            check_and_send_heartbeats(sockfd, sessions, num_sessions);
-            print_heartbeat_status(sessions, num_sessions);
-            print_telemetry_status(telemetry_sessions, telemetry_count);
-            last_heartbeat_check = now;
+            print_heartbeat_status();
+            print_telemetry_status(&telemetry_pool);
+            last_status_report = now;
         }
 
-        if (rv <= 0)
-            continue;
+        if (now - last_store_maintenance >= STORE_MAINTENANCE_INTERVAL)
+        {
+            telemetry_store_maintain(now);
+            last_store_maintenance = now;
+        }
 
-        // ===== ACEITAR CONEXÃO HTTP =====
-        if (FD_ISSET(api_fd, &readfds) && api_client_count < MAX_HTTP_CLIENTS)
+        // Fechar sessões de telemetria sem atividade
+        if (now - last_telemetry_reap >= TELEMETRY_REAP_INTERVAL)
         {
-            int client_fd = accept_http_connection(api_fd);
-            if (client_fd > 0)
-            {
-                api_clients[api_client_count++] = client_fd;
-                print_timestamp();
-                printf("🌐 Nova requisição HTTP\n");
-            }
+            telemetry_pool_reap(&telemetry_pool, now);
+            result_server_reap(&result_server, now);
+            last_telemetry_reap = now;
         }
 
-        // ============ TRECHO A SUBSTITUIR EM Nave-Mae.c ============
-        // Substitua o loop HTTP por este:
+        // Ajustar a taxa de telemetria de cada rover à carga atual
+        telemetry_rate_control(&telemetry_pool, now);
 
-        // ===== ACEITAR NOVA CONEXÃO HTTP =====
+        if (rv <= 0)
+            continue;
+
+        // ===== ACEITAR CONEXÃO HTTP =====
+        // O pedido é lido e renderizado por um worker; aqui só se aceita.
         if (FD_ISSET(api_fd, &readfds))
         {
             int client_fd = accept_http_connection(api_fd);
-            if (client_fd > 0)
+            if (client_fd > 0 && api_workers_submit(client_fd) < 0)
             {
-                // Processar requisição HTTP imediatamente
-                char request_buf[2048];
-                memset(request_buf, 0, sizeof(request_buf));
-
-                int n = recv(client_fd, request_buf, sizeof(request_buf) - 1, 0);
-
-                if (n > 0)
-                {
-                    request_buf[n] = '\0';
-
-                    // DEBUG: Ver requisição
-                    print_timestamp();
-                    printf("🌐 HTTP Request recebido (%d bytes)\n", n);
-
-                    // IMPORTANTE: Passar os dados ATUAIS (não cópias de cache)
-                    process_http_request(client_fd, request_buf,
-                                         sessions, num_sessions, // Referências ao array real
-                                         missions, num_missions, // Referências ao array real
-                                         telemetry_sessions, telemetry_count);
-                }
-
+                print_timestamp();
+                printf("⚠  Fila HTTP cheia - pedido rejeitado\n");
+                send_http_response(client_fd, 503, "application/json",
+                                   "{\"error\": \"Server busy\"}");
                 close(client_fd);
             }
         }
@@ -345,18 +819,28 @@ int main(void)
         // ===== ACEITAR CONEXÃO TCP (TelemetryStream) =====
         if (FD_ISSET(telemetry_fd, &readfds))
         {
-            accept_telemetry_connection(telemetry_fd, telemetry_sessions, &telemetry_count);
+            accept_telemetry_connection(telemetry_fd, &telemetry_pool);
         }
 
         // ===== RECEBER DADOS DE TELEMETRIA =====
-        for (int i = 0; i < telemetry_count; i++)
+        for (size_t i = 0; i < telemetry_pool.used; i++)
         {
-            if (telemetry_sessions[i].sockfd > 0 && FD_ISSET(telemetry_sessions[i].sockfd, &readfds))
+            TelemetrySession *ts = telemetry_pool_at(&telemetry_pool, i);
+            if (ts->active && ts->sockfd > 0 && FD_ISSET(ts->sockfd, &readfds))
             {
-                receive_telemetry_data(&telemetry_sessions[i]);
+                receive_telemetry_data(&telemetry_pool, ts);
             }
         }
 
+        // ===== RECEBER DATAGRAMAS DE TELEMETRIA (UDP) =====
+        if (telemetry_udp_fd >= 0 && FD_ISSET(telemetry_udp_fd, &readfds))
+        {
+            receive_telemetry_datagram(telemetry_udp_fd, &telemetry_pool);
+        }
+
+        // ===== RECEBER RESULTADOS DE MISSÃO (TCP, splice para o disco) =====
+        result_server_handle(&result_server, &readfds);
+
         // ===== RECEBER PACOTES UDP (MissionLink) =====
         if (FD_ISSET(sockfd, &readfds))
         {
@@ -365,28 +849,47 @@ int main(void)
             if (r <= 0)
                 continue;
 
-            if (buffer.type == 0xFF)
+            if (buffer.type == ML_HANDSHAKE)
+            {
+                if (r >= (int)sizeof(MLHandshake))
+                    handle_handshake(sockfd, &buffer.hello, &client_addr, addr_len);
+                continue;
+            }
+
+            // Fragmentos: só de uma conexão conhecida e em nome do seu rover
+            if (buffer.type == PKT_FRAGMENT)
+            {
+                RoverEntity *sender = rover_registry_by_conn(frag_conn_id(&buffer.frag, (size_t)r));
+                if (sender && strncmp(sender->rover_id, buffer.frag.hdr.rover_id,
+                                      sizeof(buffer.frag.hdr.rover_id)) == 0)
+                    frag_reassembler_on_fragment(&frag_rx, &buffer.frag, (size_t)r, &client_addr);
+                continue;
+            }
+
+            // Packet: validar versão, comprimento e CRC; os handlers leem
+            // os campos no próprio buffer
+            PacketView view;
+            MLWireStatus status = ml_view_init(&view, &buffer, (size_t)r);
+            if (status != ML_WIRE_OK)
             {
-                char ack = '1';
-                sendto(sockfd, &ack, 1, 0, (struct sockaddr *)&client_addr, addr_len);
                 print_timestamp();
-                printf("🤝 Handshake recebido\n\n");
+                printf("⚠  Pacote MissionLink rejeitado (%s, %d bytes)\n",
+                       ml_wire_status_name(status), r);
                 continue;
             }
 
-            switch (buffer.type)
+            switch (ml_view_type(&view))
             {
             case PKT_PONG:
-                handle_pong(&buffer, &client_addr, heartbeat_states);
+                handle_pong(sockfd, &view, &client_addr, addr_len);
                 break;
-            case PKT_MISSION_REQUEST:
-                handle_mission_request(sockfd, &buffer, &client_addr, addr_len, heartbeat_states);
+            case PKT_ACK:
+                handle_link_ack(sockfd, &view, &client_addr, addr_len);
                 break;
+            case PKT_MISSION_REQUEST:
             case PKT_PROGRESS:
-                handle_progress(sockfd, &buffer, &client_addr, addr_len, heartbeat_states);
-                break;
             case PKT_COMPLETE:
-                handle_complete(sockfd, &buffer, &client_addr, addr_len, heartbeat_states);
+                handle_mission_link_data(sockfd, &view, &client_addr, addr_len);
                 break;
             default:
                 break;
@@ -394,8 +897,15 @@ int main(void)
         }
     }
 
+    api_workers_stop();
+    frag_reassembler_destroy(&frag_rx);
+    result_server_close(&result_server);
+    telemetry_pool_destroy(&telemetry_pool);
+    rover_registry_clear();
+    telemetry_store_close();
     close(sockfd);
     close(telemetry_fd);
+    if (telemetry_udp_fd >= 0) close(telemetry_udp_fd);
     close(api_fd);
     return 0;
 }
\ No newline at end of file
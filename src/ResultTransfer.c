@@ -0,0 +1,647 @@
+// ============ ResultTransfer.c ============
+// Canal TCP de resultados de missão: sendfile() no rover, splice() na Nave-Mãe
+#define _GNU_SOURCE                      // splice()
+#include "ResultTransfer.h"
+#include "MissionLink.h"
+#include "MissionLinkARQ.h"
+#include "MissionLinkFrag.h"
+#include "EventLog.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/sendfile.h>
+
+#define PART_SUFFIX ".part"
+
+// ============ NOMES ============
+
+// Só [A-Za-z0-9._-], sem começar por '.': nada de diretórios nem ficheiros ocultos
+int result_valid_name(const char *name, size_t max) {
+    size_t len = strnlen(name, max);
+    if (len == 0 || len == max || name[0] == '.') return 0;
+    for (size_t i = 0; i < len; i++) {
+        char c = name[i];
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+              (c >= '0' && c <= '9') || c == '.' || c == '_' || c == '-')) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int is_partial(const char *name) {
+    size_t len = strlen(name), suffix = strlen(PART_SUFFIX);
+    return len > suffix && strcmp(name + len - suffix, PART_SUFFIX) == 0;
+}
+
+static void set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags >= 0) fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+// ============ SERVIDOR ============
+
+int result_server_init(ResultServer *srv, int port, ResultAuthorizeFn authorize) {
+    memset(srv, 0, sizeof(*srv));
+    srv->splice_ok = 1;
+    srv->authorize = authorize;
+    for (int i = 0; i < RESULT_MAX_SESSIONS; i++) {
+        srv->sessions[i].sockfd = -1;
+        srv->sessions[i].file_fd = -1;
+        srv->sessions[i].pipe_fd[0] = srv->sessions[i].pipe_fd[1] = -1;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket resultados");
+        srv->listen_fd = -1;
+        return -1;
+    }
+
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(port);
+
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("bind resultados");
+        close(fd);
+        srv->listen_fd = -1;
+        return -1;
+    }
+
+    if (listen(fd, RESULT_MAX_SESSIONS) < 0) {
+        perror("listen resultados");
+        close(fd);
+        srv->listen_fd = -1;
+        return -1;
+    }
+
+    srv->listen_fd = fd;
+    print_timestamp();
+    printf("📦 Canal de resultados ligado na porta %d (destino: %s/)\n\n", port, RESULTS_DIR);
+    return fd;
+}
+
+static void session_close(ResultSession *s) {
+    if (s->sockfd >= 0) close(s->sockfd);
+    if (s->file_fd >= 0) close(s->file_fd);
+    if (s->pipe_fd[0] >= 0) close(s->pipe_fd[0]);
+    if (s->pipe_fd[1] >= 0) close(s->pipe_fd[1]);
+    memset(s, 0, sizeof(*s));
+    s->sockfd = s->file_fd = -1;
+    s->pipe_fd[0] = s->pipe_fd[1] = -1;
+}
+
+static void send_reply(ResultSession *s, uint8_t status, uint64_t offset) {
+    ResultReply reply;
+    memset(&reply, 0, sizeof(reply));
+    reply.magic = RESULT_REPLY_MAGIC;
+    reply.status = status;
+    reply.offset = offset;
+    send(s->sockfd, &reply, sizeof(reply), MSG_NOSIGNAL);
+}
+
+static void accept_result_connection(ResultServer *srv) {
+    int fd = accept(srv->listen_fd, NULL, NULL);
+    if (fd < 0) return;
+
+    for (int i = 0; i < RESULT_MAX_SESSIONS; i++) {
+        ResultSession *s = &srv->sessions[i];
+        if (s->state != RS_FREE) continue;
+        set_nonblocking(fd);
+        s->state = RS_OFFER;
+        s->sockfd = fd;
+        s->last_activity = time(NULL);
+        return;
+    }
+
+    print_timestamp();
+    printf("⚠  Canal de resultados cheio (%d transferências) - conexão recusada\n",
+           RESULT_MAX_SESSIONS);
+    close(fd);
+}
+
+// Artefacto completo: .part → nome final, confirmar ao rover
+static void session_finish(ResultServer *srv, ResultSession *s) {
+    char part[sizeof(s->path) + sizeof(PART_SUFFIX)];
+    snprintf(part, sizeof(part), "%s%s", s->path, PART_SUFFIX);
+
+    close(s->file_fd);
+    s->file_fd = -1;
+    if (rename(part, s->path) < 0) {
+        perror("rename resultado");
+        session_close(s);
+        return;
+    }
+    send_reply(s, RESULT_STATUS_COMPLETE, s->offset);
+    srv->completed++;
+
+    print_timestamp();
+    printf("📦 Resultado da missão %s recebido de %s: %llu bytes → %s",
+           s->offer.mission_id, s->offer.rover_id,
+           (unsigned long long)s->offer.total_len, s->path);
+    if (s->resumed_from > 0) {
+        printf(" (retomado em %llu)", (unsigned long long)s->resumed_from);
+    }
+    printf("\n");
+    event_log_emit(EVENT_INFO, s->offer.rover_id, "mission_result", "%s: %llu bytes em %s",
+                   s->offer.mission_id, (unsigned long long)s->offer.total_len, s->path);
+    session_close(s);
+}
+
+// Oferta completa: validar, abrir o .part e responder com o offset
+static void session_accept_offer(ResultServer *srv, ResultSession *s) {
+    ResultOffer *o = &s->offer;
+    o->rover_id[sizeof(o->rover_id) - 1] = '\0';
+    o->mission_id[sizeof(o->mission_id) - 1] = '\0';
+    o->name[sizeof(o->name) - 1] = '\0';
+
+    if (o->magic != RESULT_OFFER_MAGIC || o->total_len == 0 || o->total_len > RESULT_MAX_SIZE ||
+        !result_valid_name(o->rover_id, sizeof(o->rover_id)) || !result_valid_name(o->name, sizeof(o->name)) ||
+        is_partial(o->name)) {
+        print_timestamp();
+        printf("⚠  Oferta de resultado inválida - rejeitada\n");
+        send_reply(s, RESULT_STATUS_REJECTED, 0);
+        session_close(s);
+        return;
+    }
+
+    // O rover_id só conta com a conexão MissionLink dele (ID e token)
+    if (srv->authorize && !srv->authorize(o)) {
+        print_timestamp();
+        printf("⚠  Oferta de resultado de %s sem conexão válida - rejeitada\n", o->rover_id);
+        send_reply(s, RESULT_STATUS_REJECTED, 0);
+        session_close(s);
+        return;
+    }
+
+    snprintf(s->path, sizeof(s->path), "%s/%s_%s", RESULTS_DIR, o->rover_id, o->name);
+
+    // Já recebido numa conexão anterior (a confirmação perdeu-se)
+    struct stat st;
+    if (stat(s->path, &st) == 0 && (uint64_t)st.st_size == o->total_len) {
+        send_reply(s, RESULT_STATUS_COMPLETE, o->total_len);
+        session_close(s);
+        return;
+    }
+
+    char part[sizeof(s->path) + sizeof(PART_SUFFIX)];
+    snprintf(part, sizeof(part), "%s%s", s->path, PART_SUFFIX);
+    s->file_fd = open(part, O_WRONLY | O_CREAT, 0644);
+    if (s->file_fd < 0 || fstat(s->file_fd, &st) < 0 || pipe(s->pipe_fd) < 0) {
+        perror("abrir resultado");
+        send_reply(s, RESULT_STATUS_REJECTED, 0);
+        session_close(s);
+        return;
+    }
+    set_nonblocking(s->pipe_fd[0]);
+    set_nonblocking(s->pipe_fd[1]);
+
+    // O .part guarda o que chegou antes: retomar daí
+    s->offset = (uint64_t)st.st_size;
+    if (s->offset > o->total_len) {
+        if (ftruncate(s->file_fd, 0) < 0) perror("ftruncate resultado");
+        s->offset = 0;
+    }
+    s->resumed_from = s->offset;
+    if (s->offset > 0) srv->resumed++;
+
+    print_timestamp();
+    if (s->offset > 0) {
+        printf("📦 %s: resultado %s (%llu bytes) - a retomar em %llu\n", o->rover_id, o->name,
+               (unsigned long long)o->total_len, (unsigned long long)s->offset);
+    } else {
+        printf("📦 %s: resultado %s (%llu bytes)\n", o->rover_id, o->name,
+               (unsigned long long)o->total_len);
+    }
+
+    s->state = RS_DATA;
+    send_reply(s, RESULT_STATUS_RESUME, s->offset);
+    if (s->offset == o->total_len) session_finish(srv, s);
+}
+
+// Socket → pipe → ficheiro; os dados nunca passam pelo processo.
+// Devolve 1 se o artefacto ficou completo, 0 se é preciso esperar, -1 em erro
+static int receive_splice(ResultServer *srv, ResultSession *s) {
+    for (int round = 0; round < 16; round++) {
+        if (s->pipe_bytes == 0) {
+            uint64_t remaining = s->offer.total_len - s->offset;
+            size_t want = remaining < RESULT_SPLICE_CHUNK ? (size_t)remaining : RESULT_SPLICE_CHUNK;
+            ssize_t n = splice(s->sockfd, NULL, s->pipe_fd[1], NULL, want,
+                               SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+            if (n == 0) return -1;
+            if (n < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+                if (errno == EINVAL) {
+                    srv->splice_ok = 0;
+                    print_timestamp();
+                    printf("⚠  splice() indisponível - resultados via read/write\n");
+                    return 0;
+                }
+                return -1;
+            }
+            s->pipe_bytes = (size_t)n;
+        }
+
+        while (s->pipe_bytes > 0) {
+            loff_t off = (loff_t)s->offset;
+            ssize_t m = splice(s->pipe_fd[0], NULL, s->file_fd, &off, s->pipe_bytes, SPLICE_F_MOVE);
+            if (m <= 0) return -1;
+            s->pipe_bytes -= (size_t)m;
+            s->offset += (uint64_t)m;
+            srv->bytes_received += (uint64_t)m;
+        }
+
+        if (s->offset == s->offer.total_len) return 1;
+    }
+    return 0;
+}
+
+// Alternativa sem splice(): cópia por um buffer
+static int receive_copy(ResultServer *srv, ResultSession *s) {
+    static uint8_t buf[RESULT_SPLICE_CHUNK];
+    uint64_t remaining = s->offer.total_len - s->offset;
+    size_t want = remaining < sizeof(buf) ? (size_t)remaining : sizeof(buf);
+
+    ssize_t n = recv(s->sockfd, buf, want, MSG_DONTWAIT);
+    if (n == 0) return -1;
+    if (n < 0) return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    if (pwrite(s->file_fd, buf, (size_t)n, (off_t)s->offset) != n) return -1;
+
+    s->offset += (uint64_t)n;
+    srv->bytes_received += (uint64_t)n;
+    return s->offset == s->offer.total_len ? 1 : 0;
+}
+
+static void session_readable(ResultServer *srv, ResultSession *s) {
+    s->last_activity = time(NULL);
+
+    if (s->state == RS_OFFER) {
+        ssize_t n = recv(s->sockfd, (uint8_t *)&s->offer + s->offer_got,
+                         sizeof(s->offer) - s->offer_got, MSG_DONTWAIT);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+            session_close(s);
+            return;
+        }
+        if (n > 0) s->offer_got += (size_t)n;
+        if (s->offer_got == sizeof(s->offer)) session_accept_offer(srv, s);
+        return;
+    }
+
+    int rc = srv->splice_ok ? receive_splice(srv, s) : receive_copy(srv, s);
+    if (rc > 0) {
+        session_finish(srv, s);
+    } else if (rc < 0) {
+        print_timestamp();
+        printf("⚠  %s: transferência de %s interrompida em %llu/%llu bytes (retomável)\n",
+               s->offer.rover_id, s->offer.name, (unsigned long long)s->offset,
+               (unsigned long long)s->offer.total_len);
+        session_close(s);
+    }
+}
+
+void result_server_fill_fdset(const ResultServer *srv, fd_set *readfds, int *max_fd) {
+    if (srv->listen_fd < 0) return;
+    FD_SET(srv->listen_fd, readfds);
+    if (srv->listen_fd > *max_fd) *max_fd = srv->listen_fd;
+
+    for (int i = 0; i < RESULT_MAX_SESSIONS; i++) {
+        const ResultSession *s = &srv->sessions[i];
+        if (s->state == RS_FREE) continue;
+        FD_SET(s->sockfd, readfds);
+        if (s->sockfd > *max_fd) *max_fd = s->sockfd;
+    }
+}
+
+void result_server_handle(ResultServer *srv, const fd_set *readfds) {
+    if (srv->listen_fd < 0) return;
+
+    for (int i = 0; i < RESULT_MAX_SESSIONS; i++) {
+        ResultSession *s = &srv->sessions[i];
+        if (s->state != RS_FREE && FD_ISSET(s->sockfd, readfds)) {
+            session_readable(srv, s);
+        }
+    }
+    if (FD_ISSET(srv->listen_fd, readfds)) {
+        accept_result_connection(srv);
+    }
+}
+
+void result_server_reap(ResultServer *srv, time_t now) {
+    for (int i = 0; i < RESULT_MAX_SESSIONS; i++) {
+        ResultSession *s = &srv->sessions[i];
+        if (s->state == RS_FREE || now - s->last_activity < RESULT_IDLE_TIMEOUT) continue;
+        print_timestamp();
+        printf("⚠  Transferência de resultado sem atividade há %d s - fechada\n",
+               RESULT_IDLE_TIMEOUT);
+        session_close(s);
+    }
+}
+
+void result_server_close(ResultServer *srv) {
+    for (int i = 0; i < RESULT_MAX_SESSIONS; i++) {
+        if (srv->sessions[i].state != RS_FREE) session_close(&srv->sessions[i]);
+    }
+    if (srv->listen_fd >= 0) close(srv->listen_fd);
+    srv->listen_fd = -1;
+}
+
+// ============ ROVER ============
+
+void result_uploader_init(ResultUploader *up, const char *host, int port) {
+    memset(up, 0, sizeof(*up));
+    up->host = host;
+    up->port = port;
+    up->sockfd = -1;
+    up->file_fd = -1;
+
+    // sendfile() não aceita MSG_NOSIGNAL: uma conexão fechada pelo
+    // servidor tem de dar EPIPE, não terminar o rover
+    signal(SIGPIPE, SIG_IGN);
+}
+
+void result_uploader_set_conn(ResultUploader *up, uint32_t conn_id, uint64_t resume_token) {
+    up->conn_id = conn_id;
+    up->resume_token = resume_token;
+}
+
+int result_upload_start(ResultUploader *up, const char *path, const char *rover_id,
+                        const char *mission_id, const char *name, uint8_t content_type) {
+    if (up->state != RU_IDLE) return -1;
+
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0 || st.st_size == 0) {
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+
+    memset(&up->offer, 0, sizeof(up->offer));
+    up->offer.magic = RESULT_OFFER_MAGIC;
+    strncpy(up->offer.rover_id, rover_id, sizeof(up->offer.rover_id) - 1);
+    if (mission_id) strncpy(up->offer.mission_id, mission_id, sizeof(up->offer.mission_id) - 1);
+    strncpy(up->offer.name, name, sizeof(up->offer.name) - 1);
+    up->offer.total_len = (uint64_t)st.st_size;
+    up->offer.content_type = content_type;
+
+    snprintf(up->path, sizeof(up->path), "%s", path);
+    up->file_fd = fd;
+    up->offset = 0;
+    up->attempts = 0;
+    up->retry_at = 0;
+    up->started_ms = arq_now_ms();
+    up->state = RU_WAITING;
+
+    print_timestamp();
+    printf("📦 Resultado %s: %llu bytes a enviar pelo canal de resultados\n",
+           name, (unsigned long long)up->offer.total_len);
+    return 0;
+}
+
+static void upload_finish(ResultUploader *up) {
+    if (up->sockfd >= 0) close(up->sockfd);
+    if (up->file_fd >= 0) close(up->file_fd);
+    up->sockfd = up->file_fd = -1;
+    up->state = RU_IDLE;
+}
+
+// Conexão perdida: tentar de novo mais tarde (o servidor guarda o que chegou)
+static int upload_retry(ResultUploader *up, time_t now) {
+    if (up->sockfd >= 0) close(up->sockfd);
+    up->sockfd = -1;
+
+    if (++up->attempts >= RESULT_MAX_ATTEMPTS) {
+        print_timestamp();
+        printf("✗ Resultado %s abandonado após %d tentativas\n\n",
+               up->offer.name, RESULT_MAX_ATTEMPTS);
+        upload_finish(up);
+        return -1;
+    }
+
+    int wait = RESULT_RETRY_MIN << (up->attempts - 1);
+    if (wait > RESULT_RETRY_MAX) wait = RESULT_RETRY_MAX;
+    up->retry_at = now + wait;
+    up->state = RU_WAITING;
+
+    print_timestamp();
+    printf("⚠  Canal de resultados indisponível - nova tentativa em %d s (%llu/%llu bytes enviados)\n",
+           wait, (unsigned long long)up->offset, (unsigned long long)up->offer.total_len);
+    return 0;
+}
+
+static int upload_address(const ResultUploader *up, struct sockaddr_in *addr) {
+    memset(addr, 0, sizeof(*addr));
+    addr->sin_family = AF_INET;
+    addr->sin_port = htons(up->port);
+    return inet_pton(AF_INET, up->host, &addr->sin_addr) > 0 ? 0 : -1;
+}
+
+// Começar o connect() sem bloquear o ciclo de missão
+static int upload_connect(ResultUploader *up, time_t now) {
+    struct sockaddr_in addr;
+    if (upload_address(up, &addr) < 0) return -1;
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    set_nonblocking(fd);
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 && errno != EINPROGRESS) {
+        close(fd);
+        return -1;
+    }
+    up->sockfd = fd;
+    up->connect_at = now;
+    return 0;
+}
+
+// connect() em curso: 1 ligado, 0 ainda à espera, -1 falhou
+static int upload_connected(ResultUploader *up) {
+    struct sockaddr_in addr;
+    if (upload_address(up, &addr) < 0) return -1;
+    if (connect(up->sockfd, (struct sockaddr*)&addr, sizeof(addr)) == 0 || errno == EISCONN) return 1;
+    return (errno == EINPROGRESS || errno == EALREADY) ? 0 : -1;
+}
+
+// Enviar a oferta com as credenciais atuais (cabe sempre no buffer de um
+// socket novo)
+static int upload_send_offer(ResultUploader *up) {
+    up->offer.conn_id = up->conn_id;
+    up->offer.resume_token = up->resume_token;
+    if (send(up->sockfd, &up->offer, sizeof(up->offer), MSG_NOSIGNAL) != (ssize_t)sizeof(up->offer)) {
+        return -1;
+    }
+    up->reply_got = 0;
+    return 0;
+}
+
+// Ler a ResultReply; 1 quando completa, 0 a aguardar, -1 se a conexão caiu
+static int upload_read_reply(ResultUploader *up) {
+    ssize_t n = recv(up->sockfd, (uint8_t *)&up->reply + up->reply_got,
+                     sizeof(up->reply) - up->reply_got, MSG_DONTWAIT);
+    if (n == 0) return -1;
+    if (n < 0) return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    up->reply_got += (size_t)n;
+    if (up->reply_got < sizeof(up->reply)) return 0;
+    return up->reply.magic == RESULT_REPLY_MAGIC ? 1 : -1;
+}
+
+int result_upload_poll(ResultUploader *up, time_t now) {
+    switch (up->state) {
+    case RU_IDLE:
+        return 0;
+
+    case RU_WAITING:
+        if (now < up->retry_at) return 0;
+        if (upload_connect(up, now) < 0) return upload_retry(up, now);
+        up->state = RU_CONNECTING;
+        return 0;
+
+    case RU_CONNECTING: {
+        int rc = upload_connected(up);
+        if (rc == 0 && now - up->connect_at < RESULT_CONNECT_TIMEOUT) return 0;
+        if (rc <= 0 || upload_send_offer(up) < 0) return upload_retry(up, now);
+        up->state = RU_OFFERED;
+        return 0;
+    }
+
+    case RU_OFFERED:
+    case RU_FINISHING: {
+        int rc = upload_read_reply(up);
+        if (rc == 0) return 0;
+        if (rc < 0) return upload_retry(up, now);
+
+        if (up->reply.status == RESULT_STATUS_COMPLETE) {
+            double elapsed_ms = (double)(arq_now_ms() - up->started_ms);
+            print_timestamp();
+            printf("✓ Resultado %s entregue: %llu bytes em %.0f ms\n\n", up->offer.name,
+                   (unsigned long long)up->offer.total_len, elapsed_ms);
+            upload_finish(up);
+            return 1;
+        }
+        if (up->reply.status != RESULT_STATUS_RESUME || up->state != RU_OFFERED ||
+            up->reply.offset > up->offer.total_len) {
+            print_timestamp();
+            printf("✗ Resultado %s rejeitado pela Nave-Mãe\n\n", up->offer.name);
+            upload_finish(up);
+            return -1;
+        }
+
+        up->offset = (off_t)up->reply.offset;
+        if (up->offset > 0) {
+            print_timestamp();
+            printf("📦 Resultado %s: a retomar em %llu/%llu bytes\n", up->offer.name,
+                   (unsigned long long)up->offset, (unsigned long long)up->offer.total_len);
+        }
+        up->state = RU_SENDING;
+        return 0;
+    }
+
+    case RU_SENDING:
+        // Ficheiro → socket pelo kernel, até o buffer do socket encher
+        while ((uint64_t)up->offset < up->offer.total_len) {
+            size_t left = (size_t)(up->offer.total_len - (uint64_t)up->offset);
+            ssize_t n = sendfile(up->sockfd, up->file_fd, &up->offset, left);
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 0;
+            if (n <= 0) return upload_retry(up, now);
+            up->attempts = 0;                // Progresso: a conexão funciona
+        }
+        up->state = RU_FINISHING;
+        up->reply_got = 0;
+        return 0;
+    }
+    return 0;
+}
+
+int result_upload_fd(const ResultUploader *up, int *want_write) {
+    *want_write = (up->state == RU_SENDING || up->state == RU_CONNECTING);
+    if (up->state == RU_CONNECTING || up->state == RU_OFFERED || up->state == RU_SENDING || up->state == RU_FINISHING) {
+        return up->sockfd;
+    }
+    return -1;
+}
+
+// ============ ARTEFACTOS ============
+
+const char *result_extension(uint8_t content_type) {
+    switch (content_type) {
+    case FRAG_CONTENT_IMAGE:
+        return "pgm";
+    case FRAG_CONTENT_TEXT:
+        return "csv";
+    default:
+        return "bin";
+    }
+}
+
+const char *result_mime_type(const char *name) {
+    const char *dot = strrchr(name, '.');
+    if (dot && strcmp(dot, ".pgm") == 0) return "image/x-portable-graymap";
+    if (dot && strcmp(dot, ".csv") == 0) return "text/csv";
+    return "application/octet-stream";
+}
+
+static int compare_results(const void *a, const void *b) {
+    return strcmp(((const ResultInfo *)a)->name, ((const ResultInfo *)b)->name);
+}
+
+size_t result_list(ResultInfo *out, size_t max_out, int *truncated) {
+    *truncated = 0;
+    DIR *dir = opendir(RESULTS_DIR);
+    if (!dir) return 0;
+
+    size_t count = 0;
+    struct dirent *de;
+    while ((de = readdir(dir)) != NULL) {
+        size_t name_len = strlen(de->d_name);
+        if (de->d_name[0] == '.' || name_len >= sizeof(out[0].name)) continue;
+        if (count == max_out) {
+            *truncated = 1;
+            break;
+        }
+
+        char path[sizeof(RESULTS_DIR) + sizeof(de->d_name) + 1];
+        snprintf(path, sizeof(path), "%s/%s", RESULTS_DIR, de->d_name);
+        struct stat st;
+        if (stat(path, &st) < 0 || !S_ISREG(st.st_mode)) continue;
+
+        ResultInfo *info = &out[count++];
+        memcpy(info->name, de->d_name, name_len + 1);
+        info->partial = is_partial(info->name);
+        if (info->partial) info->name[strlen(info->name) - strlen(PART_SUFFIX)] = '\0';
+        info->size = (uint64_t)st.st_size;
+        info->modified = st.st_mtime;
+    }
+    closedir(dir);
+
+    qsort(out, count, sizeof(*out), compare_results);
+    return count;
+}
+
+int result_open(const char *name, uint64_t *size) {
+    if (!result_valid_name(name, sizeof(((ResultInfo *)0)->name)) || is_partial(name)) return -1;
+
+    char path[sizeof(RESULTS_DIR) + sizeof(((ResultInfo *)0)->name) + 1];
+    snprintf(path, sizeof(path), "%s/%s", RESULTS_DIR, name);
+
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0) return -1;
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return -1;
+    }
+    *size = (uint64_t)st.st_size;
+    return fd;
+}
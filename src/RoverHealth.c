@@ -0,0 +1,250 @@
+// ============ RoverHealth.c ============
+// Implementação da análise de saúde incremental
+#include "RoverHealth.h"
+#include "EventLog.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#define HEALTH_WINDOW_MASK (HEALTH_WINDOW_SAMPLES - 1)
+#define HEALTH_REBASE_AFTER 65536        // Segundos até renormalizar os tempos
+
+// ============ JANELA DESLIZANTE ============
+
+static uint32_t oldest_index(const RoverHealth *h) {
+    return (h->head - h->count) & HEALTH_WINDOW_MASK;
+}
+
+static void series_add(HealthSeries *s, float t, float y) {
+    s->sum_y += y;
+    s->sum_ty += (double)t * y;
+    s->sum_yy += (double)y * y;
+}
+
+static void series_remove(HealthSeries *s, float t, float y) {
+    s->sum_y -= y;
+    s->sum_ty -= (double)t * y;
+    s->sum_yy -= (double)y * y;
+}
+
+static void window_evict_oldest(RoverHealth *h) {
+    uint32_t i = oldest_index(h);
+    float t = h->t[i];
+    h->sum_t -= t;
+    h->sum_tt -= (double)t * t;
+    series_remove(&h->s_battery, t, h->battery[i]);
+    series_remove(&h->s_temperature, t, h->temperature[i]);
+    series_remove(&h->s_signal, t, h->signal[i]);
+    h->count--;
+}
+
+// Recalcular as somas com os tempos relativos a uma nova base (raro)
+static void window_rebase(RoverHealth *h) {
+    uint32_t shift = (uint32_t)h->t[oldest_index(h)];
+    h->base += shift;
+    h->sum_t = h->sum_tt = 0.0;
+    memset(&h->s_battery, 0, sizeof(h->s_battery));
+    memset(&h->s_temperature, 0, sizeof(h->s_temperature));
+    memset(&h->s_signal, 0, sizeof(h->s_signal));
+
+    for (uint32_t k = 0; k < h->count; k++) {
+        uint32_t i = (oldest_index(h) + k) & HEALTH_WINDOW_MASK;
+        h->t[i] -= (float)shift;
+        h->sum_t += h->t[i];
+        h->sum_tt += (double)h->t[i] * h->t[i];
+        series_add(&h->s_battery, h->t[i], h->battery[i]);
+        series_add(&h->s_temperature, h->t[i], h->temperature[i]);
+        series_add(&h->s_signal, h->t[i], h->signal[i]);
+    }
+}
+
+static uint32_t window_span(const RoverHealth *h) {
+    if (h->count < 2) return 0;
+    float newest = h->t[(h->head - 1) & HEALTH_WINDOW_MASK];
+    return (uint32_t)(newest - h->t[oldest_index(h)]);
+}
+
+// Declive por minuto: (nΣty − ΣtΣy) / (nΣt² − (Σt)²)
+static float series_slope(const RoverHealth *h, const HealthSeries *s) {
+    if (h->count < 2) return 0.0f;
+    double n = (double)h->count;
+    double den = n * h->sum_tt - h->sum_t * h->sum_t;
+    if (den <= 1e-9) return 0.0f;
+    return (float)((n * s->sum_ty - h->sum_t * s->sum_y) / den * 60.0);
+}
+
+// Declive / erro padrão: ruído sem tendência fica quase sempre abaixo de 3
+static double series_t_score(const RoverHealth *h, const HealthSeries *s) {
+    if (h->count < 3) return 0.0;
+    double n = (double)h->count;
+    double sxx = h->sum_tt - h->sum_t * h->sum_t / n;
+    double sxy = s->sum_ty - h->sum_t * s->sum_y / n;
+    double syy = s->sum_yy - s->sum_y * s->sum_y / n;
+    if (sxx <= 1e-9) return 0.0;
+
+    double slope = sxy / sxx;
+    double sse = syy - slope * sxy;
+    if (sse <= 1e-9) return (fabs(slope) > 1e-9) ? 1e9 : 0.0;  // Reta perfeita
+    return fabs(slope) / sqrt(sse / (n - 2) / sxx);
+}
+
+// ============ ALERTAS ============
+
+// Um alerta só muda de estado depois de HEALTH_DEBOUNCE_POINTS pontos
+// seguidos a pedi-lo (evita eventos a oscilar perto do limiar)
+static void set_alert(RoverHealth *h, const char *rover_id, uint32_t bit, uint8_t *streak,
+                      int raise, int clear, EventLevel level,
+                      const char *type, const char *message) {
+    char cleared[32];
+    int active = (h->alerts & bit) != 0;
+
+    if ((!active && !raise) || (active && !clear)) {
+        *streak = 0;
+        return;
+    }
+    if (++*streak < HEALTH_DEBOUNCE_POINTS) return;
+    *streak = 0;
+
+    if (!active) {
+        h->alerts |= bit;
+        event_log_emit(level, rover_id, type, "%s", message);
+    } else {
+        h->alerts &= ~bit;
+        snprintf(cleared, sizeof(cleared), "%s_cleared", type);
+        event_log_emit(EVENT_INFO, rover_id, cleared, "%s", message);
+    }
+}
+
+static void evaluate_alerts(RoverHealth *h, const char *rover_id) {
+    char message[128];
+    int ready = h->count >= HEALTH_MIN_POINTS && window_span(h) >= HEALTH_MIN_SPAN;
+    float battery_slope = series_slope(h, &h->s_battery);
+    float temperature_slope = series_slope(h, &h->s_temperature);
+    float signal_slope = series_slope(h, &h->s_signal);
+    int battery_trend = ready && series_t_score(h, &h->s_battery) >= HEALTH_MIN_T_SCORE;
+    int temperature_trend = ready && series_t_score(h, &h->s_temperature) >= HEALTH_MIN_T_SCORE;
+    int signal_trend = ready && series_t_score(h, &h->s_signal) >= HEALTH_MIN_T_SCORE;
+
+    snprintf(message, sizeof(message), "Bateria a variar %.2f %%/min (limiar -%.1f)",
+             battery_slope, HEALTH_BATTERY_DRAIN_ALERT);
+    set_alert(h, rover_id, HEALTH_ALERT_BATTERY_DRAIN, &h->streak[0],
+              battery_trend && battery_slope <= -HEALTH_BATTERY_DRAIN_ALERT,
+              ready && battery_slope > -HEALTH_BATTERY_DRAIN_ALERT / 2,
+              EVENT_WARNING, "battery_drain", message);
+
+    snprintf(message, sizeof(message), "Bateria média %.1f%% (limiar %.0f%%)",
+             h->battery_ewma, HEALTH_BATTERY_LOW_ALERT);
+    set_alert(h, rover_id, HEALTH_ALERT_BATTERY_LOW, &h->streak[1],
+              h->battery_ewma < HEALTH_BATTERY_LOW_ALERT,
+              h->battery_ewma >= HEALTH_BATTERY_LOW_ALERT + 5.0,
+              EVENT_CRITICAL, "battery_low", message);
+
+    snprintf(message, sizeof(message), "Temperatura a subir %.2f °C/min (limiar %.1f)",
+             temperature_slope, HEALTH_TEMPERATURE_RISE_ALERT);
+    set_alert(h, rover_id, HEALTH_ALERT_TEMPERATURE_RISE, &h->streak[2],
+              temperature_trend && temperature_slope >= HEALTH_TEMPERATURE_RISE_ALERT,
+              ready && temperature_slope < HEALTH_TEMPERATURE_RISE_ALERT / 2,
+              EVENT_WARNING, "temperature_rise", message);
+
+    snprintf(message, sizeof(message), "Sinal a variar %.2f %%/min (limiar -%.1f)",
+             signal_slope, HEALTH_SIGNAL_DROP_ALERT);
+    set_alert(h, rover_id, HEALTH_ALERT_SIGNAL_DROP, &h->streak[3],
+              signal_trend && signal_slope <= -HEALTH_SIGNAL_DROP_ALERT,
+              ready && signal_slope > -HEALTH_SIGNAL_DROP_ALERT / 2,
+              EVENT_WARNING, "signal_degrading", message);
+}
+
+// ============ ATUALIZAÇÃO ============
+
+// Fechar o ponto do segundo em construção: entra na janela e avalia alertas
+static void window_push_pending(RoverHealth *h, const char *rover_id) {
+    float k = (float)h->pending_count;
+    uint32_t second = h->pending_second;
+    h->pending_count = 0;
+
+    // Relógio do rover recuou (reinício): recomeçar a janela
+    if (h->count == 0 || second < h->base ||
+        (float)(second - h->base) < h->t[(h->head - 1) & HEALTH_WINDOW_MASK] - 1.0f) {
+        h->count = 0;
+        h->head = 0;
+        h->base = second;
+        h->sum_t = h->sum_tt = 0.0;
+        memset(&h->s_battery, 0, sizeof(h->s_battery));
+        memset(&h->s_temperature, 0, sizeof(h->s_temperature));
+        memset(&h->s_signal, 0, sizeof(h->s_signal));
+    } else if (second - h->base > HEALTH_REBASE_AFTER) {
+        window_rebase(h);
+    }
+
+    float t = (float)(second - h->base) + h->pending_ms / k / 1000.0f;
+    float battery = h->pending_battery / k;
+    float temperature = h->pending_temperature / k;
+    float signal = h->pending_signal / k;
+
+    // Sair da janela: por capacidade ou por idade
+    while (h->count > 0 &&
+           (h->count == HEALTH_WINDOW_SAMPLES ||
+            t - h->t[oldest_index(h)] > HEALTH_WINDOW_SECONDS)) {
+        window_evict_oldest(h);
+    }
+
+    uint32_t i = h->head;
+    h->t[i] = t;
+    h->battery[i] = battery;
+    h->temperature[i] = temperature;
+    h->signal[i] = signal;
+    h->head = (h->head + 1) & HEALTH_WINDOW_MASK;
+    h->count++;
+
+    h->sum_t += t;
+    h->sum_tt += (double)t * t;
+    series_add(&h->s_battery, t, battery);
+    series_add(&h->s_temperature, t, temperature);
+    series_add(&h->s_signal, t, signal);
+
+    evaluate_alerts(h, rover_id);
+}
+
+void rover_health_update(RoverHealth *h, const char *rover_id, const TelemetryMessage *msg) {
+    float battery = msg->battery;
+    float temperature = msg->temperature;
+    float signal = msg->signal_strength;
+
+    if (h->samples == 0) {
+        h->battery_ewma = battery;
+        h->temperature_ewma = temperature;
+        h->signal_ewma = signal;
+    } else {
+        h->battery_ewma += (float)HEALTH_EWMA_ALPHA * (battery - h->battery_ewma);
+        h->temperature_ewma += (float)HEALTH_EWMA_ALPHA * (temperature - h->temperature_ewma);
+        h->signal_ewma += (float)HEALTH_EWMA_ALPHA * (signal - h->signal_ewma);
+    }
+    h->samples++;
+
+    // Amostra de outro segundo: o ponto anterior está completo
+    if (h->pending_count > 0 && msg->timestamp != h->pending_second) {
+        window_push_pending(h, rover_id);
+    }
+    if (h->pending_count == 0) {
+        h->pending_second = msg->timestamp;
+        h->pending_ms = h->pending_battery = h->pending_temperature = h->pending_signal = 0.0f;
+    }
+    h->pending_count++;
+    h->pending_ms += msg->timestamp_ms;
+    h->pending_battery += battery;
+    h->pending_temperature += temperature;
+    h->pending_signal += signal;
+}
+
+void rover_health_summary(const RoverHealth *h, RoverHealthSummary *out) {
+    out->samples = h->samples;
+    out->battery_ewma = h->battery_ewma;
+    out->temperature_ewma = h->temperature_ewma;
+    out->signal_ewma = h->signal_ewma;
+    out->battery_slope = series_slope(h, &h->s_battery);
+    out->temperature_slope = series_slope(h, &h->s_temperature);
+    out->signal_slope = series_slope(h, &h->s_signal);
+    out->window_samples = h->count;
+    out->window_seconds = window_span(h);
+    out->alerts = h->alerts;
+}
@@ -0,0 +1,237 @@
+// ============ RoverRegistry.c ============
+// Implementação do registo único de rovers
+#include "RoverRegistry.h"
+#include "MissionLink.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============ ESTADO ============
+// Usado apenas pelo ciclo principal; a API lê vistas copiadas para snapshots.
+static RoverEntity **slabs = NULL;
+static size_t num_slabs = 0;
+static size_t entity_count = 0;
+static int id_heads[ROVER_REGISTRY_BUCKETS];
+static uint64_t handshakes = 0;
+
+static unsigned rover_id_hash(const char *rover_id) {
+    // FNV-1a
+    uint32_t h = 2166136261u;
+    for (const char *p = rover_id; *p; p++) {
+        h ^= (uint8_t)*p;
+        h *= 16777619u;
+    }
+    return h & (ROVER_REGISTRY_BUCKETS - 1);
+}
+
+RoverEntity* rover_registry_at(size_t i) {
+    return &slabs[i / ROVER_REGISTRY_SLAB][i % ROVER_REGISTRY_SLAB];
+}
+
+size_t rover_registry_count(void) {
+    return entity_count;
+}
+
+// ============ PROCURA / CRIAÇÃO ============
+
+RoverEntity* rover_registry_find(const char *rover_id) {
+    if (!rover_id || rover_id[0] == '\0') return NULL;
+    for (int e = id_heads[rover_id_hash(rover_id)]; e; e = rover_registry_at(e - 1)->id_next) {
+        RoverEntity *rover = rover_registry_at(e - 1);
+        if (strcmp(rover->rover_id, rover_id) == 0) return rover;
+    }
+    return NULL;
+}
+
+static void id_link(RoverEntity *rover) {
+    unsigned b = rover_id_hash(rover->rover_id);
+    rover->id_next = id_heads[b];
+    id_heads[b] = rover->slot;
+}
+
+static void id_unlink(RoverEntity *rover) {
+    int *link = &id_heads[rover_id_hash(rover->rover_id)];
+    while (*link != rover->slot) link = &rover_registry_at(*link - 1)->id_next;
+    *link = rover->id_next;
+}
+
+// Entrada só com handshake mais antiga, se já há ROVER_REGISTRY_PENDING_MAX
+// delas (ou o registo está cheio); NULL caso contrário
+static RoverEntity* pending_to_reuse(void) {
+    RoverEntity *oldest = NULL;
+    size_t pending = 0;
+    for (size_t i = 0; i < entity_count; i++) {
+        RoverEntity *rover = rover_registry_at(i);
+        if (rover->has_link) continue;
+        pending++;
+        if (!oldest || rover->handshake_order < oldest->handshake_order) oldest = rover;
+    }
+    if (pending >= ROVER_REGISTRY_PENDING_MAX || entity_count >= ROVER_REGISTRY_MAX)
+        return oldest;
+    return NULL;
+}
+
+RoverEntity* rover_registry_get(const char *rover_id) {
+    RoverEntity *rover = rover_registry_find(rover_id);
+    if (rover || !rover_id || rover_id[0] == '\0') return rover;
+
+    // Reutilizar: o rover antigo nunca passou do handshake (nem timers
+    // armados nem missões); só a telemetria pode estar ligada
+    rover = pending_to_reuse();
+    if (rover) {
+        int slot = rover->slot;
+        print_timestamp();
+        printf("♻  Entrada de %s (só handshake) reutilizada para %s\n",
+               rover->rover_id, rover_id);
+        id_unlink(rover);
+        if (rover->telemetry) rover->telemetry->entity = NULL;
+        memset(rover, 0, sizeof(*rover));
+        snprintf(rover->rover_id, sizeof(rover->rover_id), "%s", rover_id);
+        rover->slot = slot;
+        id_link(rover);
+        return rover;
+    }
+    if (entity_count >= ROVER_REGISTRY_MAX) return NULL;
+
+    if (entity_count == num_slabs * ROVER_REGISTRY_SLAB) {
+        RoverEntity **grown = realloc(slabs, (num_slabs + 1) * sizeof(*grown));
+        if (!grown) return NULL;
+        slabs = grown;
+        RoverEntity *slab = calloc(ROVER_REGISTRY_SLAB, sizeof(RoverEntity));
+        if (!slab) return NULL;
+        slabs[num_slabs++] = slab;
+    }
+
+    rover = rover_registry_at(entity_count);
+    memset(rover, 0, sizeof(*rover));
+    strncpy(rover->rover_id, rover_id, sizeof(rover->rover_id) - 1);
+    rover->slot = (int)++entity_count;
+    id_link(rover);
+    return rover;
+}
+
+// ============ IDS DE CONEXÃO ============
+// ID = aleatório nos bits altos | posição no registo nos bits baixos: a
+// procura é direta e um ID antigo ou inventado não coincide com o guardado.
+
+static uint64_t random_u64(void) {
+    uint64_t v = 0;
+    FILE *f = fopen("/dev/urandom", "rb");
+    if (!f || fread(&v, sizeof(v), 1, f) != 1) {
+        v = ((uint64_t)rand() << 32) ^ (uint64_t)rand() ^ (uint64_t)time(NULL);
+    }
+    if (f) fclose(f);
+    return v;
+}
+
+RoverEntity* rover_registry_by_conn(uint32_t conn_id) {
+    size_t slot = conn_id & ((1u << ROVER_CONN_SLOT_BITS) - 1);
+    if (conn_id == 0 || slot == 0 || slot > entity_count) return NULL;
+
+    RoverEntity *rover = rover_registry_at(slot - 1);
+    return rover->conn_id == conn_id ? rover : NULL;
+}
+
+void rover_registry_issue_conn(RoverEntity *rover) {
+    if (!rover) return;
+
+    uint32_t old = rover->conn_id, conn_id;
+    do {
+        uint32_t high = (uint32_t)random_u64() >> ROVER_CONN_SLOT_BITS;
+        if (high == 0) high = 1;
+        conn_id = (high << ROVER_CONN_SLOT_BITS) | (uint32_t)rover->slot;
+    } while (conn_id == old);
+    rover->conn_id = conn_id;
+
+    rover->resume_token = random_u64();
+    if (rover->resume_token == 0) rover->resume_token = 1;
+    rover->handshake_order = ++handshakes;
+}
+
+// ============ ESTADO PARTILHADO ============
+
+void rover_registry_set_battery(RoverEntity *rover, uint8_t battery) {
+    if (!rover) return;
+    rover->battery = battery;
+    rover->battery_updated = time(NULL);
+}
+
+// Só liga a entidades já criadas pelo handshake MissionLink: a telemetria
+// não é autenticada e não pode ocupar lugares do registo (que não liberta)
+void rover_registry_attach_telemetry(TelemetrySession *session) {
+    RoverEntity *rover = rover_registry_find(session->rover_id);
+    if (!rover) return;
+    rover->telemetry = session;
+    session->entity = rover;
+}
+
+void rover_registry_detach_telemetry(TelemetrySession *session) {
+    RoverEntity *rover = session->entity;
+    if (rover && rover->telemetry == session) rover->telemetry = NULL;
+    session->entity = NULL;
+}
+
+// ============ VISTAS ============
+
+static int compare_views(const void *a, const void *b) {
+    return strcmp(((const RoverView *)a)->rover_id, ((const RoverView *)b)->rover_id);
+}
+
+size_t rover_registry_views(RoverView *out, size_t max_out) {
+    size_t n = 0;
+    for (size_t i = 0; i < entity_count && n < max_out; i++) {
+        const RoverEntity *rover = rover_registry_at(i);
+        RoverView *v = &out[n++];
+
+        memcpy(v->rover_id, rover->rover_id, sizeof(v->rover_id));
+        v->has_link = rover->has_link;
+        v->link = rover->link;
+        v->link_stats = rover->link_rx.stats;
+        if (rover->has_link_tx) {
+            v->link_rtt = rover->link_tx.rtt;
+            v->link_sent = rover->link_tx.sent;
+            v->link_retransmitted = rover->link_tx.retransmitted;
+            v->link_acked = rover->link_tx.acked;
+            v->link_resets = rover->link_tx.resets;
+        } else {
+            memset(&v->link_rtt, 0, sizeof(v->link_rtt));
+            v->link_sent = v->link_retransmitted = v->link_acked = v->link_resets = 0;
+        }
+        v->heartbeat = rover->heartbeat;
+        v->battery = rover->battery;
+        rover_health_summary(&rover->health, &v->health);
+        v->has_telemetry = rover->telemetry != NULL;
+        if (rover->telemetry) {
+            v->telemetry = *rover->telemetry;
+            v->telemetry.rx_buf = NULL;
+            v->telemetry.entity = NULL;
+        } else {
+            memset(&v->telemetry, 0, sizeof(v->telemetry));
+        }
+    }
+
+    qsort(out, n, sizeof(RoverView), compare_views);
+    return n;
+}
+
+const RoverView* rover_view_find(const RoverView *views, size_t count, const char *rover_id) {
+    if (!views || !rover_id) return NULL;
+
+    RoverView key;
+    memset(key.rover_id, 0, sizeof(key.rover_id));
+    strncpy(key.rover_id, rover_id, sizeof(key.rover_id) - 1);
+    return bsearch(&key, views, count, sizeof(RoverView), compare_views);
+}
+
+void rover_registry_clear(void) {
+    for (size_t i = 0; i < entity_count; i++) {
+        RoverEntity *rover = rover_registry_at(i);
+        if (rover->telemetry) rover->telemetry->entity = NULL;
+    }
+    for (size_t i = 0; i < num_slabs; i++) free(slabs[i]);
+    free(slabs);
+    slabs = NULL;
+    num_slabs = 0;
+    entity_count = 0;
+    memset(id_heads, 0, sizeof(id_heads));
+}
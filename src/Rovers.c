@@ -1,6 +1,10 @@
 // ============ Rovers.c (COM TELEMETRYSTREAM) ============
 // Cliente MissionLink + TelemetryStream
 #include "MissionLink.h"
+#include "MissionLinkARQ.h"
+#include "MissionLinkWire.h"
+#include "MissionLinkFrag.h"
+#include "ResultTransfer.h"
 #include "rover_management.h"
 #include "executar_missoes.h"
 #include "rover_state_persistence.h"
@@ -10,28 +14,37 @@
 #include <stdlib.h>
 #include <string.h>
 #include <arpa/inet.h>
+#include <endian.h>
 #include <unistd.h>
 #include <time.h>
 #include <sys/time.h>
 #include <sys/select.h>
 
+// Ritmo do ciclo de missão (segundos)
+#define MISSION_REQUEST_DELAY 5          // Antes do primeiro pedido
+#define MISSION_ASSIGN_TIMEOUT 5         // REQUEST confirmado sem ASSIGN: não há mais missões
+#define MISSION_DEFER_DELAY 3            // Pedido adiado pela Nave-Mãe: voltar a pedir
+#define MISSION_UPDATE_INTERVAL 2        // Entre PROGRESS
+#define MISSION_QUEUE_DEPTH 2            // Missões em fila pedidas à Nave-Mãe
+
 // Variáveis globais para tracking de posição
 float current_position_x = 0.0;
 float current_position_y = 0.0;
 time_t last_telemetry_send = 0;
 
-// Conectar ao servidor com handshake
-int connect_to_server(int sockfd, struct sockaddr_in *server_addr)
+// Conectar ao servidor com handshake: a Nave-Mãe emite o ID de conexão
+// (identifica o rover em todos os pacotes) e o token de retoma
+int connect_to_server(int sockfd, struct sockaddr_in *server_addr, RoverState *state)
 {
     struct timeval tv = {HANDSHAKE_TIMEOUT, 0};
     setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
 
-    Packet hello;
+    MLHandshake hello;
     memset(&hello, 0, sizeof(hello));
-    hello.type = 0xFF;
+    hello.type = ML_HANDSHAKE;
+    memcpy(hello.rover_id, state->rover_id, sizeof(hello.rover_id));
+    hello.resume_token = htole64(state->resume_token);   // Prova de posse da conexão atual
 
-    char ack;
-    socklen_t addr_len = sizeof(*server_addr);
     int attempts = 0;
 
     print_timestamp();
@@ -39,13 +52,28 @@ int connect_to_server(int sockfd, struct sockaddr_in *server_addr)
 
     while (attempts < HANDSHAKE_RETRIES)
     {
-        sendto(sockfd, &hello, 1, 0, (struct sockaddr *)server_addr, sizeof(*server_addr));
+        sendto(sockfd, &hello, sizeof(hello), 0, (struct sockaddr *)server_addr, sizeof(*server_addr));
 
-        int r = recvfrom(sockfd, &ack, 1, 0, (struct sockaddr *)server_addr, &addr_len);
-        if (r == 1 && ack == '1')
+        // Ignorar o que ainda chegue da sessão anterior (PINGs, ACKs)
+        MissionLinkDatagram dgram;
+        ssize_t r;
+        while ((r = recvfrom(sockfd, &dgram, sizeof(dgram), 0, NULL, NULL)) > 0)
         {
+            if (dgram.type != ML_HANDSHAKE || r != sizeof(MLHandshakeReply))
+                continue;
+            if (dgram.hello_reply.status == ML_HS_BUSY)
+            {
+                print_timestamp();
+                printf("⚠  A Nave-Mãe tem outra conexão ativa para %s\n", state->rover_id);
+                break;
+            }
+            if (dgram.hello_reply.status != ML_HS_OK)
+                continue;
+
+            state->conn_id = le32toh(dgram.hello_reply.conn_id);
+            state->resume_token = le64toh(dgram.hello_reply.resume_token);
             print_timestamp();
-            printf("✓ Handshake aceito! Conexão estabelecida.\n\n");
+            printf("✓ Handshake aceito! Conexão %08x estabelecida.\n\n", state->conn_id);
             return 1;
         }
 
@@ -61,82 +89,211 @@ int connect_to_server(int sockfd, struct sockaddr_in *server_addr)
     return 0;
 }
 
-// Solicitar missão
-void request_mission(int sockfd, struct sockaddr_in *server_addr, RoverState *state)
+// Solicitar missão (a atribuição chega depois, pelo ciclo principal)
+int request_mission(ArqSender *link, RoverState *state)
 {
     Packet request;
     prepare_request_packet(state, &request);
 
+    if (arq_send(link, &request) < 0)
+        return -1;
+    state->seq = link->next_seq;
+
+    print_timestamp();
+    printf("📤 MISSION_REQUEST enviada (seq=%u)\n\n", request.seq);
+    return 0;
+}
+
+// Guardar atribuição de missão recebida
+char *receive_mission_assignment(Packet *assignment, RoverState *state)
+{
     print_timestamp();
-    printf("📤 Enviando MISSION_REQUEST (seq=%u)\n", request.seq);
+    printf("🔨 MISSION_ASSIGN recebida\n");
+    print_packet_info(assignment);
+    printf("\n");
 
-    ssize_t result = send_udp_with_ack(sockfd, server_addr, (char *)&request, sizeof(request));
+    store_mission_assignment(state, assignment);
+    return state->task_type;
+}
 
-    if (result < 0)
+// Missão retirada pela Nave-Mãe: sai da fila, ou é abandonada se é a atual
+void revoke_mission(MissionQueue *queue, RoverState *state, int *in_mission,
+                    const Packet *revoke)
+{
+    print_timestamp();
+    if (mission_queue_remove(queue, revoke->mission_id))
+        printf("🚫 Missão %s retirada da fila\n\n", revoke->mission_id);
+    else if (*in_mission && strcmp(state->mission_id, revoke->mission_id) == 0)
     {
-        print_timestamp();
-        printf("✗ Falha ao enviar MISSION_REQUEST\n\n");
+        printf("🚫 Missão %s retirada - abandonada\n\n", revoke->mission_id);
+        *in_mission = 0;
+        state->progress = 0;
     }
     else
-    {
-        print_timestamp();
-        printf("✓ MISSION_REQUEST enviada com sucesso\n\n");
-    }
+        printf("🚫 Missão %s retirada (já não estava cá)\n\n", revoke->mission_id);
 }
 
-// Receber atribuição de missão
-char *receive_mission_assignment(int sockfd, struct sockaddr_in *server_addr, RoverState *state)
+// Pacote fiável da Nave-Mãe (ASSIGN, REVOKE): confirmar logo e apontar em out[]
+// os que ficam entregáveis por ordem (retransmissões não se repetem)
+int receive_server_packet(int sockfd, struct sockaddr_in *server_addr, ArqReceiver *downlink,
+                          const RoverState *state, const PacketView *pkt, Packet **out)
 {
-    static Packet assignment;
-    memset(&assignment, 0, sizeof(assignment));
-
-    struct timeval tv = {5, 0};
-    setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    Packet ack;
+    int n = arq_receiver_accept(downlink, pkt, out, ARQ_WINDOW, &ack);
 
-    socklen_t addr_len = sizeof(*server_addr);
-    ssize_t r = recvfrom(sockfd, &assignment, sizeof(assignment), 0,
-                         (struct sockaddr *)server_addr, &addr_len);
-
-    if (r == sizeof(Packet) && assignment.type == PKT_MISSION_ASSIGN)
+    if (ack.type == PKT_ACK)
     {
-        print_timestamp();
-        printf("🔨 MISSION_ASSIGN recebida\n");
-        print_packet_info(&assignment);
-        printf("\n");
-
-        store_mission_assignment(state, &assignment);
-        next_sequence(state);
-        return assignment.task_type;
+        snprintf(ack.rover_id, sizeof(ack.rover_id), "%s", state->rover_id);
+        ack.conn_id = state->conn_id;
+        ml_wire_send(sockfd, &ack, server_addr);
     }
+    return n;
+}
+
+// Enviar progresso de missão (fica em voo até ao ACK, sem bloquear)
+int send_mission_progress(ArqSender *link, RoverState *state,
+                          uint8_t progress, uint8_t battery)
+{
+    Packet pkt;
+    prepare_progress_packet(state, &pkt, progress, battery);
+
+    if (arq_send(link, &pkt) < 0)
+        return -1;
+    state->seq = link->next_seq;
 
     print_timestamp();
-    printf("✗ Falha ao receber atribuição de missão\n\n");
-    return "";
+    printf("📤 PROGRESS enviada (seq=%u | progr=%u%% | bat=%u%% | %u em voo)\n\n",
+           pkt.seq, progress, battery, arq_sender_in_flight(link));
+    return 0;
 }
 
 // Enviar conclusão de missão
-void send_mission_complete(int sockfd, struct sockaddr_in *server_addr,
-                           RoverState *state, uint8_t battery)
+int send_mission_complete(ArqSender *link, RoverState *state, uint8_t battery)
 {
     Packet pkt;
     prepare_complete_packet(state, &pkt, battery);
 
+    if (arq_send(link, &pkt) < 0)
+        return -1;
+    state->seq = link->next_seq;
+
     print_timestamp();
-    printf("📤 Enviando COMPLETE (seq=%u | bat=%u%%)\n", pkt.seq, battery);
+    printf("✅ COMPLETE enviada (seq=%u | bat=%u%% | %u em voo)\n\n",
+           pkt.seq, battery, arq_sender_in_flight(link));
+    return 0;
+}
 
-    ssize_t result = send_udp_with_ack(sockfd, server_addr, (char *)&pkt, sizeof(pkt));
+// ============ RESULTADOS DE MISSÃO ============
+// Produto da missão, enviado em fragmentos depois do COMPLETE: imagem PGM
+// para capture_images/scan_area, tabela CSV de medições para as restantes
+#define RESULT_IMAGE_WIDTH 256
+#define RESULT_IMAGE_HEIGHT 192
+#define RESULT_CSV_ROWS 200
 
-    if (result < 0)
+// Devolve o tamanho do resultado em *data (malloc), ou 0 em caso de erro
+static uint32_t build_mission_result(const RoverState *state, uint8_t **data,
+                                     uint8_t *content_type)
+{
+    int image = strcmp(state->task_type, "capture_images") == 0 ||
+                strcmp(state->task_type, "scan_area") == 0;
+
+    if (image)
     {
-        print_timestamp();
-        printf("✗ Falha ao enviar COMPLETE\n\n");
+        char header[32];
+        int hlen = snprintf(header, sizeof(header), "P5\n%d %d\n255\n",
+                            RESULT_IMAGE_WIDTH, RESULT_IMAGE_HEIGHT);
+        uint32_t len = (uint32_t)hlen + RESULT_IMAGE_WIDTH * RESULT_IMAGE_HEIGHT;
+        uint8_t *buf = malloc(len);
+        if (!buf)
+            return 0;
+
+        // Terreno sintético: gradiente com ruído
+        memcpy(buf, header, (size_t)hlen);
+        uint8_t *px = buf + hlen;
+        for (int y = 0; y < RESULT_IMAGE_HEIGHT; y++)
+            for (int x = 0; x < RESULT_IMAGE_WIDTH; x++)
+                *px++ = (uint8_t)((x + y) / 2 + rand() % 32);
+
+        *data = buf;
+        *content_type = FRAG_CONTENT_IMAGE;
+        return len;
     }
-    else
+
+    size_t cap = 64 + RESULT_CSV_ROWS * 64;
+    char *buf = malloc(cap);
+    if (!buf)
+        return 0;
+
+    size_t len = (size_t)snprintf(buf, cap, "sample,x,y,ph,humidity,temperature\n");
+    for (int i = 0; i < RESULT_CSV_ROWS && len < cap; i++)
+    {
+        float fx = state->mission_x1 + (state->mission_x2 - state->mission_x1) * (float)i / RESULT_CSV_ROWS;
+        float fy = state->mission_y1 + (state->mission_y2 - state->mission_y1) * (float)(rand() % 100) / 100.0f;
+        len += (size_t)snprintf(buf + len, cap - len, "%d,%.2f,%.2f,%.2f,%.1f,%.1f\n",
+                                i, fx, fy, 5.5 + (rand() % 300) / 100.0,
+                                10.0 + (rand() % 400) / 10.0, -20.0 + (rand() % 400) / 10.0);
+    }
+    if (len >= cap)
+        len = cap - 1;
+
+    *data = (uint8_t *)buf;
+    *content_type = FRAG_CONTENT_TEXT;
+    return (uint32_t)len;
+}
+
+// Começar a enviar o resultado da missão atual (segue em segundo plano).
+// Normalmente pelo canal de resultados, a partir de um ficheiro; se este
+// estiver ocupado ou o ficheiro não puder ser escrito, em fragmentos MissionLink
+static void send_mission_result(ResultUploader *uploader, FragSender *fragments,
+                                const ArqSender *link, const RoverState *state)
+{
+    uint8_t *data = NULL;
+    uint8_t content_type = FRAG_CONTENT_BINARY;
+    uint32_t len = build_mission_result(state, &data, &content_type);
+    if (len == 0)
+        return;
+
+    // Nome único: a mesma missão pode repetir-se
+    char name[64], path[192];
+    snprintf(name, sizeof(name), "%s_%ld.%s", state->mission_id, (long)time(NULL),
+             result_extension(content_type));
+    snprintf(path, sizeof(path), "rovers/rover_%s_%s", state->rover_id, name);
+
+    FILE *f = fopen(path, "wb");
+    int stored = f && fwrite(data, 1, len, f) == len;
+    if (f)
+        fclose(f);
+
+    if (stored && result_upload_start(uploader, path, state->rover_id, state->mission_id,
+                                      name, content_type) == 0)
+    {
+        free(data);
+        return;
+    }
+    if (stored)
+        remove(path);
+
+    if (fragments->active || len > FRAG_MAX_MESSAGE)
     {
         print_timestamp();
-        printf("✓ COMPLETE enviada com sucesso\n\n");
-        save_rover_state(state->rover_id, state, current_position_x, current_position_y);
+        printf("⚠  Canais de resultados ocupados - resultado de %s descartado\n\n",
+               state->mission_id);
+        free(data);
+        return;
     }
+
+    fragments->rtt = link->rtt;          // Sondas com o RTT já medido
+    fragments->conn_id = state->conn_id;
+    frag_send(fragments, data, len, content_type, state->mission_id);
+    free(data);
+}
+
+// Relógio monótono em milissegundos (amostragem de telemetria)
+static uint64_t monotonic_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
 }
 
 // Simular movimento do rover
@@ -155,7 +312,11 @@ void prepare_telemetry_message(TelemetryMessage *msg, RoverState *state,
 {
     memset(msg, 0, sizeof(*msg));
     
-    msg->timestamp = (uint32_t)time(NULL);
+    // Amostras a 5 Hz: o segundo não chega para as distinguir
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    msg->timestamp = (uint32_t)now.tv_sec;
+    msg->timestamp_ms = (uint16_t)(now.tv_nsec / 1000000);
     strncpy(msg->rover_id, state->rover_id, sizeof(msg->rover_id) - 1);
     msg->position_x = pos_x;
     msg->position_y = pos_y;
@@ -189,9 +350,10 @@ int main(int argc, char **argv)
     srand(time(NULL));
 
     if (argc < 2) {
-        fprintf(stderr, "Uso: %s <rover_id>\n", argv[0]);
+        fprintf(stderr, "Uso: %s <rover_id> [--udp-telemetry]\n", argv[0]);
         return 1;
     }
+    int use_udp_telemetry = (argc > 2 && strcmp(argv[2], "--udp-telemetry") == 0);
 
     // ===== SOCKET UDP (MissionLink) =====
     int sockfd = create_udp_socket();
@@ -209,18 +371,11 @@ int main(int argc, char **argv)
         printf("   Continuando apenas com MissionLink...\n\n");
     }
 
-    // Conectar ao servidor MissionLink
-    if (!connect_to_server(sockfd, &server_addr))
-    {
-        close(sockfd);
-        if (telemetry_fd > 0) close(telemetry_fd);
-        return 1;
-    }
-
     init_state_file(argv[1]);
 
     RoverState state;
     init_rover_state(&state, argv[1]);
+    state.queue_depth = MISSION_QUEUE_DEPTH;
 
     if (load_rover_state(argv[1], &state, &current_position_x, &current_position_y))
     {
@@ -235,147 +390,399 @@ int main(int argc, char **argv)
                current_position_x, current_position_y);
     }
 
+    // Conectar ao servidor MissionLink: com credenciais guardadas, retomar
+    // sem handshake (o primeiro pacote já segue); a Nave-Mãe pede um novo
+    // handshake se não as reconhecer
+    int resumed = state.conn_id != 0 && state.resume_token != 0;
+    if (resumed)
+    {
+        print_timestamp();
+        printf("⚡ Retoma 0-RTT da conexão %08x\n\n", state.conn_id);
+    }
+    else if (connect_to_server(sockfd, &server_addr, &state))
+    {
+        save_rover_state(state.rover_id, &state, current_position_x, current_position_y);
+    }
+    else
+    {
+        close(sockfd);
+        if (telemetry_fd > 0) close(telemetry_fd);
+        return 1;
+    }
+
     print_timestamp();
     printf("👊 Sistema de Heartbeat ativado - Responderá a PINGs\n");
-    printf("📡 Telemetria ativada - Enviando a cada %d segundos\n\n", TELEMETRY_SEND_INTERVAL);
+    printf("📡 Telemetria ativada - Amostragem a cada %d ms, lotes de até %d amostras / %d ms\n\n",
+           TELEMETRY_SAMPLE_INTERVAL_MS, TELEMETRY_BATCH_SAMPLES, TELEMETRY_BATCH_LATENCY_MS);
 
+    // Negociar stream v2 (deltas); sem resposta, reabrir a conexão em v1
+    int telemetry_version = 1;
+    if (telemetry_fd > 0)
+    {
+        telemetry_version = telemetry_negotiate(telemetry_fd, state.rover_id);
+        if (telemetry_version < 2)
+        {
+            close(telemetry_fd);
+            telemetry_fd = create_telemetry_connection("127.0.0.1", TELEMETRY_PORT);
+        }
+    }
+
+    // Canal UDP opcional: cada amostra segue de imediato (posição ao vivo),
+    // o TCP continua a entregar todas as amostras de forma fiável
+    int telemetry_udp_fd = -1;
+    uint32_t telemetry_udp_seq = 0;
+    if (use_udp_telemetry)
+    {
+        telemetry_udp_fd = create_telemetry_udp_connection("127.0.0.1", TELEMETRY_UDP_PORT);
+    }
+
+    TelemetryBatcher batcher;
+    telemetry_batcher_init(&batcher, telemetry_fd, telemetry_version,
+                           TELEMETRY_BATCH_SAMPLES, TELEMETRY_BATCH_LATENCY_MS);
+    uint64_t last_sample_ms = 0;
+    uint32_t sample_interval_ms = TELEMETRY_SAMPLE_INTERVAL_MS;   // Ajustado pela Nave-Mãe
     last_telemetry_send = time(NULL);
-    time_t last_mission_request_time = time(NULL);
+
+    // MissionLink em janela: PROGRESS/COMPLETE seguem sem esperar pelos ACKs
+    ArqSender link;
+    arq_sender_init(&link, sockfd, &server_addr, state.seq);
+
+    // Sentido inverso: ASSIGN fiáveis da Nave-Mãe
+    ArqReceiver downlink;
+    memset(&downlink, 0, sizeof(downlink));
+
+    // Resultados de missão (imagens, análises): canal TCP dedicado, com
+    // fragmentos MissionLink como alternativa
+    ResultUploader uploader;
+    result_uploader_init(&uploader, "127.0.0.1", RESULT_PORT);
+    result_uploader_set_conn(&uploader, state.conn_id, state.resume_token);
+    FragSender results;
+    frag_sender_init(&results, sockfd, &server_addr, state.rover_id);
+
+    // Fila de ASSIGNs: a próxima missão começa logo a seguir ao COMPLETE,
+    // sem esperar pelo REQUEST; os pedidos repõem a fila em fundo
+    MissionQueue queue;
+    mission_queue_init(&queue);
+    int granted_depth = 0;               // Fila concedida pela Nave-Mãe
+    int exhausted = 0;                   // Nave-Mãe sem mais missões
 
     int mission_num = 1;
     int in_mission = 0;
+    int awaiting_assign = 0;
+    time_t next_request_at = resumed ? time(NULL) : time(NULL) + MISSION_REQUEST_DELAY;
+    uint32_t request_seq = 0;
+    time_t request_acked_at = 0;
+    time_t next_progress_at = 0;
+    uint8_t mission_progress = 0;
+    uint8_t mission_battery = 100;
 
     while (1)
     {
-        // ===== VERIFICAR SE É HORA DE ENVIAR TELEMETRIA =====
+        // ===== AMOSTRAR TELEMETRIA E ENVIAR LOTES =====
         time_t now = time(NULL);
-        if (telemetry_fd > 0 && (now - last_telemetry_send) >= TELEMETRY_SEND_INTERVAL)
+        if (telemetry_fd > 0)
         {
-            TelemetryMessage msg;
-            uint8_t current_state = in_mission ? STATE_IN_MISSION : STATE_IDLE;
-            
-            memset(&msg, 0, sizeof(msg));
-            msg.timestamp = (uint32_t)now;
-            strncpy(msg.rover_id, state.rover_id, sizeof(msg.rover_id) - 1);
-            msg.position_x = current_position_x;
-            msg.position_y = current_position_y;
-            msg.battery = state.battery;
-            msg.state = current_state;
-            msg.temperature = 25.0 + (rand() % 10);
-            msg.signal_strength = 85 + (rand() % 15);
-            msg.nonce = rand() % 100000;
-            
-            send_telemetry_message(telemetry_fd, &msg);
-            last_telemetry_send = now;
+            uint64_t now_ms = monotonic_ms();
+            if (now_ms - last_sample_ms >= sample_interval_ms)
+            {
+                TelemetryMessage msg;
+                prepare_telemetry_message(&msg, &state, current_position_x, current_position_y);
+                msg.state = in_mission ? STATE_IN_MISSION : STATE_IDLE;
+                last_sample_ms = now_ms;
+
+                if (telemetry_udp_fd >= 0)
+                {
+                    send_telemetry_datagram(telemetry_udp_fd, ++telemetry_udp_seq, &msg);
+                }
+
+                if (telemetry_batcher_add(&batcher, &msg) < 0)
+                {
+                    print_timestamp();
+                    printf("❌ Conexão de telemetria perdida - a continuar só com MissionLink\n\n");
+                    close(telemetry_fd);
+                    telemetry_fd = -1;
+                }
+            }
+            if (telemetry_fd > 0 && telemetry_batcher_poll(&batcher) < 0)
+            {
+                print_timestamp();
+                printf("❌ Conexão de telemetria perdida - a continuar só com MissionLink\n\n");
+                close(telemetry_fd);
+                telemetry_fd = -1;
+            }
+        }
+
+        // ===== CONTROLO DE TAXA PEDIDO PELA NAVE-MÃE =====
+        if (telemetry_fd > 0 && telemetry_version >= 2)
+        {
+            TelemetryRateControl ctl;
+            int rc = telemetry_batcher_read_control(&batcher, &ctl);
+            if (rc > 0 && (ctl.sample_interval_ms != sample_interval_ms ||
+                           ctl.batch_latency_ms != batcher.max_latency_ms))
+            {
+                sample_interval_ms = ctl.sample_interval_ms;
+                batcher.max_latency_ms = ctl.batch_latency_ms;
+                print_timestamp();
+                printf("🎚  Nave-Mãe ajustou a telemetria: amostra a cada %u ms, lotes até %u ms\n\n",
+                       (unsigned)ctl.sample_interval_ms, (unsigned)ctl.batch_latency_ms);
+            }
+            else if (rc < 0)
+            {
+                print_timestamp();
+                printf("❌ Conexão de telemetria perdida - a continuar só com MissionLink\n\n");
+                close(telemetry_fd);
+                telemetry_fd = -1;
+            }
         }
 
-        // ===== SE NÃO ESTÁ EM MISSÃO, SOLICITAR UMA =====
-        if (!in_mission && (now - last_mission_request_time) >= 5)
+        // ===== RETRANSMISSÕES MISSIONLINK =====
+        uint64_t link_now_ms = arq_now_ms();
+        if (arq_sender_poll(&link, link_now_ms) < 0)
+        {
+            // Stream novo: a Nave-Mãe toma-o por um rover reiniciado e
+            // retira a fila e a missão em curso. Largá-las também e voltar a pedir
+            if (in_mission || queue.count > 0)
+            {
+                print_timestamp();
+                printf("🚫 Stream reiniciado - %d missão(ões) em fila e a atual abandonadas\n\n",
+                       queue.count);
+            }
+            mission_queue_init(&queue);
+            in_mission = 0;
+            awaiting_assign = 0;
+        }
+        frag_sender_poll(&results, link_now_ms);
+
+        // ===== RESULTADOS DE MISSÃO (sendfile, retoma após falhas) =====
+        int upload_rc = result_upload_poll(&uploader, now);
+        if (upload_rc > 0)
+            remove(uploader.path);           // Entregue: não guardar cópia
+        else if (upload_rc < 0)
         {
+            print_timestamp();
+            printf("⚠  Resultado guardado localmente em %s\n\n", uploader.path);
+        }
+
+        // ===== MANTER A FILA CHEIA: missão atual + fila concedida =====
+        if (!awaiting_assign && !exhausted && now >= next_request_at &&
+            queue.count + in_mission < 1 + granted_depth &&
+            arq_sender_window_open(&link))
+        {
+            if (request_mission(&link, &state) == 0)
+            {
+                awaiting_assign = 1;
+                request_seq = link.next_seq - 1;
+                request_acked_at = 0;
+            }
+        }
+
+        // A ASSIGN chega com o ACK do REQUEST (e é retransmitida pela
+        // Nave-Mãe): REQUEST confirmado e nada de ASSIGN significa que não
+        // há mais missões para este rover
+        if (awaiting_assign && !request_acked_at && (int32_t)(link.base - request_seq) > 0)
+            request_acked_at = now;
+
+        if (awaiting_assign && request_acked_at && (now - request_acked_at) >= MISSION_ASSIGN_TIMEOUT)
+        {
+            print_timestamp();
+            printf("✗ Falha ao receber atribuição de missão\n\n");
+            awaiting_assign = 0;
+            exhausted = 1;
+        }
+
+        // ===== COMEÇAR A PRÓXIMA MISSÃO DA FILA =====
+        if (!in_mission && queue.count > 0)
+        {
+            Packet next;
+            mission_queue_pop(&queue, &next);
+
             print_timestamp();
             printf("┌────────────────────────────────────────────────────┐\n");
             printf("│         🚀 CICLO DE MISSÃO #%d                      │\n", mission_num);
             printf("└────────────────────────────────────────────────────┘\n\n");
+            printf("A missao é %s (%d em fila)\n\n",
+                   receive_mission_assignment(&next, &state), queue.count);
 
-            request_mission(sockfd, &server_addr, &state);
-            next_sequence(&state);
-            
-            // Receber atribuição
-            char *task_type;
-            task_type = receive_mission_assignment(sockfd, &server_addr, &state);
-            if (!task_type || strlen(task_type) == 0)
+            in_mission = 1;
+            mission_progress = 0;
+            mission_battery = 100;
+            next_progress_at = now + MISSION_UPDATE_INTERVAL;
+        }
+
+        if (exhausted && !in_mission && queue.count == 0)
+            break;
+
+        // ===== SE ESTÁ EM MISSÃO, REPORTAR PROGRESSO =====
+        // Cada pacote fica na janela até ao ACK; a missão não espera por ele
+        if (in_mission && now >= next_progress_at && arq_sender_window_open(&link))
+        {
+            // Simular progresso (na prática seria substituído pela lógica real)
+            mission_progress += 20;
+            mission_battery -= 15;
+            if (mission_progress > 100) mission_progress = 100;
+            if (mission_battery < 10) mission_battery = 10;
+
+            if (mission_progress < 100)
             {
-                break;
+                send_mission_progress(&link, &state, mission_progress, mission_battery);
+                state.battery = mission_battery;
+                state.progress = mission_progress;
+                next_progress_at = now + MISSION_UPDATE_INTERVAL;
+            }
+            else
+            {
+                // Missão completa
+                send_mission_complete(&link, &state, mission_battery);
+                state.battery = mission_battery;
+                state.progress = 100;
+                save_rover_state(state.rover_id, &state, current_position_x, current_position_y);
+                send_mission_result(&uploader, &results, &link, &state);
+
+                // Reset para próxima missão
+                in_mission = 0;
+                state.battery = 100;
+                state.progress = 0;
+                mission_num++;
+
+                print_timestamp();
+                printf("📋 Missão terminada - %d em fila\n\n", queue.count);
             }
+        }
 
-            printf("A missao é %s\n\n", task_type);
-            
-            in_mission = 1;
-            last_mission_request_time = now;
+        // ===== AGUARDAR PACOTES MISSIONLINK ATÉ AO PRÓXIMO EVENTO =====
+        // (próxima amostra de telemetria ou próximo temporizador de retransmissão)
+        int wait_ms = (int)(sample_interval_ms < TELEMETRY_SAMPLE_INTERVAL_MS ?
+                            sample_interval_ms : TELEMETRY_SAMPLE_INTERVAL_MS);
+        int rto_ms = arq_sender_next_timeout(&link, link_now_ms);
+        if (rto_ms >= 0 && rto_ms < wait_ms) wait_ms = rto_ms;
+        int frag_ms = frag_sender_next_timeout(&results, link_now_ms);
+        if (frag_ms >= 0 && frag_ms < wait_ms) wait_ms = frag_ms;
+
+        struct timeval tv = {wait_ms / 1000, (wait_ms % 1000) * 1000};
+        fd_set readfds, writefds;
+        FD_ZERO(&readfds);
+        FD_ZERO(&writefds);
+        FD_SET(sockfd, &readfds);
+        int max_fd = sockfd;
+
+        // Transferência de resultado: acordar quando o socket aceitar mais
+        // dados ou chegar a resposta da Nave-Mãe
+        int want_write = 0;
+        int upload_fd = result_upload_fd(&uploader, &want_write);
+        if (upload_fd >= 0)
+        {
+            FD_SET(upload_fd, want_write ? &writefds : &readfds);
+            if (upload_fd > max_fd) max_fd = upload_fd;
         }
 
-        // ===== SE ESTÁ EM MISSÃO, EXECUTAR =====
-        if (in_mission)
+        if (select(max_fd + 1, &readfds, &writefds, NULL, &tv) > 0 && FD_ISSET(sockfd, &readfds))
         {
-            // Usar select com timeout pequeno para não bloquear
-            struct timeval tv = {1, 0};  // 1 segundo timeout
-            fd_set readfds;
-            FD_ZERO(&readfds);
-            FD_SET(sockfd, &readfds);
-            
-            int rv = select(sockfd + 1, &readfds, NULL, NULL, &tv);
-            
-            // Se há dados UDP, processar (é resposta a PING)
-            if (rv > 0 && FD_ISSET(sockfd, &readfds))
+            MissionLinkDatagram dgram;
+            PacketView pkt;
+            struct sockaddr_in from;
+            socklen_t from_len = sizeof(from);
+            ssize_t r;
+
+            while ((r = recvfrom(sockfd, &dgram, sizeof(dgram), MSG_DONTWAIT,
+                                 (struct sockaddr *)&from, &from_len)) > 0)
             {
-                Packet ping_pkt;
-                socklen_t addr_len = sizeof(server_addr);
-                int r = recvfrom(sockfd, &ping_pkt, sizeof(ping_pkt), 0,
-                               (struct sockaddr *)&server_addr, &addr_len);
-                
-                if (r == sizeof(Packet) && ping_pkt.type == PKT_PING)
+                from_len = sizeof(from);
+
+                // Controlo dos fragmentos (NACK / DONE)
+                if (dgram.type == PKT_FRAG_NACK || dgram.type == PKT_FRAG_DONE)
                 {
+                    if (r == sizeof(FragControl))
+                        frag_sender_on_control(&results, &dgram.ctl);
+                    continue;
+                }
+
+                // A Nave-Mãe não reconhece a conexão (reiniciou, credenciais
+                // antigas): novo handshake e streams recomeçados
+                if (dgram.type == ML_HANDSHAKE)
+                {
+                    if (r != sizeof(MLHandshakeReply) || dgram.hello_reply.status != ML_HS_RETRY ||
+                        le32toh(dgram.hello_reply.conn_id) != state.conn_id)
+                        continue;
+
                     print_timestamp();
-                    printf("🔔 PING recebido - Respondendo com PONG\n\n");
-                    process_ping_and_respond(sockfd, &ping_pkt, &server_addr, state.rover_id);
+                    printf("🔁 Conexão %08x recusada - novo handshake\n", state.conn_id);
+                    state.conn_id = 0;
+                    if (!connect_to_server(sockfd, &server_addr, &state))
+                        continue;
+
+                    arq_sender_init(&link, sockfd, &server_addr, state.seq);
+                    memset(&downlink, 0, sizeof(downlink));
+                    result_uploader_set_conn(&uploader, state.conn_id, state.resume_token);
+                    awaiting_assign = 0;
+
+                    // Missões da Nave-Mãe anterior: já não as conhece
+                    mission_queue_init(&queue);
+                    in_mission = 0;
+                    save_rover_state(state.rover_id, &state, current_position_x, current_position_y);
+                    continue;
                 }
-            }
-            
-            // Simular progresso (na prática seria substituído pela lógica real)
-            static uint8_t mission_progress = 0;
-            static uint8_t mission_battery = 100;
-            
-            if (mission_progress < 100)
-            {
-                mission_progress += 20;
-                mission_battery -= 15;
-                if (mission_progress > 100) mission_progress = 100;
-                if (mission_battery < 10) mission_battery = 10;
-                
-                if (mission_progress < 100)
+                if (ml_view_init(&pkt, &dgram, (size_t)r) != ML_WIRE_OK)
+                    continue;
+
+                // ACK cumulativo: num PKT_ACK ou levado por outro pacote (ASSIGN)
+                if (ml_view_flags(&pkt) & ML_FLAG_ACK)
+                    arq_sender_on_ack(&link, &pkt);
+
+                switch (ml_view_type(&pkt))
                 {
-                    Packet pkt;
-                    prepare_progress_packet(&state, &pkt, mission_progress, mission_battery);
-                    ssize_t result = send_udp_with_ack(sockfd, &server_addr, (char *)&pkt, sizeof(pkt));
-                    
-                    if (result > 0)
+                case PKT_ACK:
+                    break;
+                case PKT_PING:
+                    print_timestamp();
+                    printf("🔔 PING recebido - Respondendo com PONG\n\n");
+                    process_ping_and_respond(sockfd, &pkt, &server_addr, state.rover_id, state.conn_id);
+                    break;
+                case PKT_MISSION_DEFER:
+                    // Só a resposta ao REQUEST pendente (o ACK já veio nela)
+                    if (!awaiting_assign || ml_view_seq(&pkt) != request_seq)
+                        break;
+                    print_timestamp();
+                    printf("⏸  Pedido de missão adiado - novo pedido em %ds\n\n",
+                           MISSION_DEFER_DELAY);
+                    awaiting_assign = 0;
+                    next_request_at = now + MISSION_DEFER_DELAY;
+                    break;
+                case PKT_MISSION_ASSIGN:
+                case PKT_MISSION_REVOKE:
+                {
+                    Packet *delivered[ARQ_WINDOW];
+                    int n = receive_server_packet(sockfd, &server_addr, &downlink,
+                                                  &state, &pkt, delivered);
+                    for (int i = 0; i < n; i++)
                     {
+                        if (delivered[i]->type == PKT_MISSION_REVOKE)
+                        {
+                            revoke_mission(&queue, &state, &in_mission, delivered[i]);
+                            continue;
+                        }
+                        if (delivered[i]->type != PKT_MISSION_ASSIGN)
+                            continue;
+
+                        // Também uma ASSIGN tardia (pedido já dado por
+                        // terminado): a Nave-Mãe reservou a missão para nós
+                        if (mission_queue_push(&queue, delivered[i]) < 0)
+                        {
+                            print_timestamp();
+                            printf("⚠  MISSION_ASSIGN %s sem lugar na fila - descartada\n\n",
+                                   delivered[i]->mission_id);
+                            continue;
+                        }
                         print_timestamp();
-                        printf("✓ PROGRESS enviada (progr=%u%%, bat=%u%%)\n\n", mission_progress, mission_battery);
+                        printf("📥 MISSION_ASSIGN %s em fila (fila concedida: %u)\n\n",
+                               delivered[i]->mission_id, delivered[i]->queue_depth);
+                        granted_depth = delivered[i]->queue_depth;
+                        awaiting_assign = 0;
+                        exhausted = 0;
                     }
-                    
-                    state.battery = mission_battery;
-                    state.progress = mission_progress;
-                    next_sequence(&state);
-                    sleep(2);  // Aguardar entre updates
+                    break;
                 }
-                else
-                {
-                    // Missão completa
-                    Packet complete_pkt;
-                    prepare_complete_packet(&state, &complete_pkt, mission_battery);
-                    send_udp_with_ack(sockfd, &server_addr, (char *)&complete_pkt, sizeof(complete_pkt));
-                    
-                    print_timestamp();
-                    printf("✅ COMPLETE enviada\n\n");
-                    
-                    state.battery = mission_battery;
-                    state.progress = 100;
-                    next_sequence(&state);
-                    save_rover_state(state.rover_id, &state, current_position_x, current_position_y);
-                    
-                    // Reset para próxima missão
-                    in_mission = 0;
-                    mission_progress = 0;
-                    mission_battery = 100;
-                    state.battery = 100;
-                    state.progress = 0;
-                    mission_num++;
-                    
-                    print_timestamp();
-                    printf("📋 Rover retornando à base...\n");
-                    printf("⏱ Aguardando antes da próxima missão...\n\n");
-                    sleep(10);
+                default:
+                    break;
                 }
             }
         }
@@ -388,7 +795,12 @@ int main(int argc, char **argv)
 
     save_rover_state(state.rover_id, &state, current_position_x, current_position_y);
 
-    if (telemetry_fd > 0) close(telemetry_fd);
+    if (telemetry_fd > 0)
+    {
+        telemetry_batcher_flush(&batcher);
+        close(telemetry_fd);
+    }
+    if (telemetry_udp_fd >= 0) close(telemetry_udp_fd);
     close(sockfd);
     return 0;
 }
\ No newline at end of file
@@ -1,24 +1,23 @@
 // ============ Server_management.c (ATUALIZADO) ============
 // Implementação da gestão de rovers e missões
 #include "Server_management.h"
+#include "RoverRegistry.h"
 #include "missions.h"
+#include "EventLog.h"
+#include <arpa/inet.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <time.h>
 
-// Tabelas globais
-RoverSession sessions[MAX_ROVERS];
+// Tabelas globais (os rovers vivem no registo: RoverRegistry.c)
 MissionRecord missions[MAX_MISSIONS];
-int num_sessions = 0;
 int num_missions = 0;
 int next_mission_id = 1;
 
 // Inicializar tabelas
 void init_server_tables(void) {
-    memset(sessions, 0, sizeof(sessions));
     memset(missions, 0, sizeof(missions));
-    num_sessions = 0;
     num_missions = 0;
     next_mission_id = 1;
 }
@@ -54,7 +53,7 @@ MissionRecord* create_mission_for_rover(const char *rover_id) {
     //mission->progress = 0;
     mission->battery = 100;
     mission->updates_count = 0;
-    mission->completed = 0;
+    mission->status = MISSION_RESERVED;
     
     print_timestamp();
     printf("🔋 [ML] MISSÃO CRIADA:\n");
@@ -69,70 +68,130 @@ MissionRecord* create_mission_for_rover(const char *rover_id) {
     return mission;
 }
 
-// Atualizar missão
-void add_or_update_mission(const char *mission_id, uint8_t progress, uint8_t battery) {
+static MissionRecord* find_mission(const char *mission_id) {
     for (int i = 0; i < num_missions; i++) {
         if (strcmp(missions[i].mission_id, mission_id) == 0) {
-            missions[i].progress = progress;
-            missions[i].battery = battery;
-            missions[i].last_update = time(NULL);
-            missions[i].updates_count++;
-            return;
+            return &missions[i];
         }
     }
+    return NULL;
+}
+
+// Atualizar missão
+MissionRecord* add_or_update_mission(const char *mission_id, uint8_t progress, uint8_t battery) {
+    MissionRecord *mission = find_mission(mission_id);
+    if (!mission || mission->status == MISSION_REVOKED) return NULL;
+
+    if (mission->status == MISSION_RESERVED) {
+        mission->status = MISSION_ACTIVE;
+        mission->start_time = time(NULL);
+    }
+    mission->progress = progress;
+    mission->battery = battery;
+    mission->last_update = time(NULL);
+    mission->updates_count++;
+    return mission;
 }
 
 // Marcar como concluída
-void mark_mission_complete(const char *mission_id) {
+int mark_mission_complete(const char *mission_id) {
+    MissionRecord *mission = find_mission(mission_id);
+    if (!mission || mission->status == MISSION_REVOKED) return -1;
+    mission->status = MISSION_COMPLETED;
+    return 0;
+}
+
+// Contar missões por concluir de um rover
+int count_open_missions(const char *rover_id) {
+    int count = 0;
     for (int i = 0; i < num_missions; i++) {
-        if (strcmp(missions[i].mission_id, mission_id) == 0) {
-            missions[i].completed = 1;
-            return;
+        if ((missions[i].status == MISSION_RESERVED || missions[i].status == MISSION_ACTIVE) &&
+            strcmp(missions[i].rover_id, rover_id) == 0) {
+            count++;
         }
     }
+    return count;
 }
 
-// Obter sessão de rover
-RoverSession* get_rover_session(const char *rover_id) {
-    for (int i = 0; i < num_sessions; i++) {
-        if (strcmp(sessions[i].rover_id, rover_id) == 0) {
-            return &sessions[i];
-        }
+// Retirar reservas
+int revoke_rover_missions(const char *rover_id, int include_active,
+                          MissionRecord **out, int max_out) {
+    int count = 0;
+    for (int i = 0; i < num_missions; i++) {
+        MissionRecord *mission = &missions[i];
+        if (strcmp(mission->rover_id, rover_id) != 0) continue;
+        if (mission->status != MISSION_RESERVED &&
+            !(include_active && mission->status == MISSION_ACTIVE)) continue;
+
+        mission->status = MISSION_REVOKED;
+        mission->last_update = time(NULL);
+        if (count < max_out) out[count] = mission;
+        count++;
     }
-    return NULL;
+    return count < max_out ? count : max_out;
+}
+
+// Retirar uma missão ainda reservada (não iniciada)
+MissionRecord* revoke_reserved_mission(const char *mission_id) {
+    MissionRecord *mission = find_mission(mission_id);
+    if (!mission || mission->status != MISSION_RESERVED) return NULL;
+    mission->status = MISSION_REVOKED;
+    mission->last_update = time(NULL);
+    return mission;
+}
+
+// Obter rover registado por MissionLink
+RoverEntity* get_rover_session(const char *rover_id) {
+    RoverEntity *rover = rover_registry_find(rover_id);
+    return (rover && rover->has_link) ? rover : NULL;
 }
 
 // Registar ou atualizar rover
-RoverSession* register_or_update_rover(const char *rover_id, struct sockaddr_in *addr) {
-    RoverSession *session = get_rover_session(rover_id);
+RoverEntity* register_or_update_rover(const char *rover_id, struct sockaddr_in *addr) {
+    RoverEntity *rover = rover_registry_get(rover_id);
+    if (!rover) return NULL;
     
-    if (session) {
+    RoverSession *session = &rover->link;
+    if (rover->has_link) {
+        // O ID de conexão já identificou o rover: um endereço novo é uma
+        // migração, a sessão (janelas, missão, heartbeat) segue-o
+        if (session->addr.sin_addr.s_addr != addr->sin_addr.s_addr ||
+            session->addr.sin_port != addr->sin_port) {
+            char from[INET_ADDRSTRLEN], to[INET_ADDRSTRLEN];
+            inet_ntop(AF_INET, &session->addr.sin_addr, from, sizeof(from));
+            inet_ntop(AF_INET, &addr->sin_addr, to, sizeof(to));
+            print_timestamp();
+            printf("🔀 %s mudou de endereço: %s:%u → %s:%u\n", rover_id,
+                   from, ntohs(session->addr.sin_port), to, ntohs(addr->sin_port));
+            event_log_emit(EVENT_INFO, rover_id, "address_migrated", "%s:%u -> %s:%u",
+                           from, ntohs(session->addr.sin_port), to, ntohs(addr->sin_port));
+        }
         session->addr = *addr;
         session->last_update = time(NULL);
-        return session;
+        heartbeat_seen(rover);
+        return rover;
     }
     
-    if (num_sessions < MAX_ROVERS) {
-        session = &sessions[num_sessions++];
-        memset(session, 0, sizeof(*session));
-        strncpy(session->rover_id, rover_id, sizeof(session->rover_id) - 1);
-        session->last_seq = 0;
-        session->addr = *addr;
-        session->active = 1;
-        session->last_update = time(NULL);
-        session->last_ping_sent = time(NULL);
-        
-        // ===== INICIALIZAR CAMPOS DE HEARTBEAT =====
-        session->waiting_for_pong = 0;
-        session->consecutive_missed_pongs = 0;
-        
-        print_timestamp();
-        printf("🆕 Novo Rover conectado: %s\n\n", rover_id);
-        
-        return session;
-    }
+    // Primeiro pacote MissionLink (o rover pode já ser conhecido pela telemetria)
+    memset(session, 0, sizeof(*session));
+    strncpy(session->rover_id, rover_id, sizeof(session->rover_id) - 1);
+    session->last_seq = 0;
+    session->addr = *addr;
+    session->active = 1;
+    session->last_update = time(NULL);
     
-    return NULL;
+    // ===== INICIALIZAR CAMPOS DE HEARTBEAT =====
+    memset(&rover->heartbeat, 0, sizeof(rover->heartbeat));
+    rover->heartbeat.last_ping_sent = time(NULL);
+    rover->heartbeat.is_healthy = 1;
+    arq_rtt_init(&rover->heartbeat.rtt);
+    heartbeat_start(rover);
+    rover->has_link = 1;
+    
+    print_timestamp();
+    printf("🆕 Novo Rover conectado: %s\n\n", rover_id);
+    
+    return rover;
 }
 
 // Imprimir status de missões
@@ -148,7 +207,9 @@ void print_mission_status(void) {
         printf("║ Nenhuma missão ativa                                              ║\n");
     } else {
         for (int i = 0; i < num_missions; i++) {
-            const char *status = missions[i].completed ? "✅" : "⏳";
+            const char *status = missions[i].status == MISSION_COMPLETED ? "✅" :
+                                 missions[i].status == MISSION_ACTIVE ? "⏳" :
+                                 missions[i].status == MISSION_RESERVED ? "📥" : "🚫";
             
             printf("║ %-6s │ %-7s │ %-16s │ %3u%% │ %3u%% │ %7d │ %s      ║\n",
                    missions[i].mission_id,
@@ -172,24 +233,27 @@ void print_rover_status(void) {
     printf("║ Rover   │ Status   │ Missão   │ Progr │ Bat │ Seq  │ Último Update  ║\n");
     printf("╠════════════════════════════════════════════════════════════════════╣\n");
     
-    if (num_sessions == 0) {
+    int shown = 0;
+    for (size_t i = 0; i < rover_registry_count(); i++) {
+        const RoverEntity *rover = rover_registry_at(i);
+        const RoverSession *session = &rover->link;
+        if (!rover->has_link || !session->active) continue;
+        
+        time_t time_since_update = time(NULL) - session->last_update;
+        const char *active = !rover->heartbeat.expired ? "✓ ATIVO" : "✗ INATIVO";
+        
+        printf("║ %-7s │ %-8s │ %-8s │ %3u%% │ %3u%% │ %4u │ %3lds atrás  ║\n",
+               rover->rover_id,
+               active,
+               session->mission_id[0] ? session->mission_id : "N/A",
+               session->progress,
+               rover->battery,
+               session->last_seq,
+               time_since_update);
+        shown++;
+    }
+    if (shown == 0) {
         printf("║ Nenhum rover conectado                                            ║\n");
-    } else {
-        for (int i = 0; i < num_sessions; i++) {
-            if (!sessions[i].active) continue;
-            
-            time_t time_since_update = time(NULL) - sessions[i].last_update;
-            const char *active = time_since_update < 35 ? "✓ ATIVO" : "✗ INATIVO";
-            
-            printf("║ %-7s │ %-8s │ %-8s │ %3u%% │ %3u%% │ %4u │ %3lds atrás  ║\n",
-                   sessions[i].rover_id,
-                   active,
-                   sessions[i].mission_id[0] ? sessions[i].mission_id : "N/A",
-                   sessions[i].progress,
-                   sessions[i].battery,
-                   sessions[i].last_seq,
-                   time_since_update);
-        }
     }
     printf("╚════════════════════════════════════════════════════════════════════╝\n\n");
 }
\ No newline at end of file
@@ -0,0 +1,320 @@
+// ============ SpatialIndex.c ============
+// Implementação do índice espacial (grelha uniforme com hashing)
+#include "SpatialIndex.h"
+#include "MissionLink.h"
+#include "RoverRegistry.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+// Todos os rovers do registo cabem no índice
+typedef char spatial_table_size_check[(SPATIAL_MAX_ENTRIES >= ROVER_REGISTRY_MAX) ? 1 : -1];
+
+// ============ ESTRUTURAS INTERNAS ============
+// Ligações usam índices base 1 (0 = fim da lista), para que as tabelas
+// estáticas fiquem válidas sem inicialização explícita.
+typedef struct {
+    char rover_id[32];
+    float x, y;
+    int32_t cx, cy;                  // Célula atual
+    time_t last_update;
+    int in_use;
+    int cell_prev, cell_next;        // Lista da célula (duplamente ligada)
+    int id_next;                     // Lista da tabela de IDs
+} SpatialEntry;
+
+static SpatialEntry entries[SPATIAL_MAX_ENTRIES];
+static int cell_heads[SPATIAL_CELL_BUCKETS];
+static int id_heads[SPATIAL_ID_BUCKETS];
+static int free_head = 0;            // Entradas libertadas (ligadas por cell_next)
+static int next_unused = 0;          // Entradas nunca usadas
+static size_t entry_count = 0;
+static int limit_warned = 0;
+
+// Escrita pelo ciclo principal, leitura pelos workers HTTP
+static pthread_mutex_t spatial_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// ============ HASHING ============
+
+// Célula de uma coordenada finita (os chamadores rejeitam NaN e infinitos);
+// longe da origem fica presa a ±1e9 para caber em int32_t
+static int32_t cell_coord(float v) {
+    float c = floorf(v / SPATIAL_CELL_SIZE);
+    if (!(c < 1e9f)) c = 1e9f;
+    if (!(c > -1e9f)) c = -1e9f;
+    return (int32_t)c;
+}
+
+static unsigned cell_hash(int32_t cx, int32_t cy) {
+    uint32_t h = ((uint32_t)cx * 73856093u) ^ ((uint32_t)cy * 19349663u);
+    return h & (SPATIAL_CELL_BUCKETS - 1);
+}
+
+static unsigned id_hash(const char *rover_id) {
+    // FNV-1a
+    uint32_t h = 2166136261u;
+    for (const char *p = rover_id; *p; p++) {
+        h ^= (uint8_t)*p;
+        h *= 16777619u;
+    }
+    return h & (SPATIAL_ID_BUCKETS - 1);
+}
+
+// ============ LISTAS ============
+
+static int find_entry(const char *rover_id) {
+    for (int e = id_heads[id_hash(rover_id)]; e; e = entries[e - 1].id_next) {
+        if (strcmp(entries[e - 1].rover_id, rover_id) == 0) return e;
+    }
+    return 0;
+}
+
+static void cell_link(int e) {
+    SpatialEntry *ent = &entries[e - 1];
+    unsigned b = cell_hash(ent->cx, ent->cy);
+    ent->cell_prev = 0;
+    ent->cell_next = cell_heads[b];
+    if (cell_heads[b]) entries[cell_heads[b] - 1].cell_prev = e;
+    cell_heads[b] = e;
+}
+
+static void cell_unlink(int e) {
+    SpatialEntry *ent = &entries[e - 1];
+    if (ent->cell_prev) {
+        entries[ent->cell_prev - 1].cell_next = ent->cell_next;
+    } else {
+        cell_heads[cell_hash(ent->cx, ent->cy)] = ent->cell_next;
+    }
+    if (ent->cell_next) entries[ent->cell_next - 1].cell_prev = ent->cell_prev;
+    ent->cell_prev = ent->cell_next = 0;
+}
+
+// ============ ATUALIZAÇÃO ============
+
+void spatial_index_update(const char *rover_id, float x, float y) {
+    if (!rover_id || rover_id[0] == '\0' || !isfinite(x) || !isfinite(y)) return;
+
+    pthread_mutex_lock(&spatial_lock);
+
+    int e = find_entry(rover_id);
+    if (!e) {
+        if (free_head) {
+            e = free_head;
+            free_head = entries[e - 1].cell_next;
+        } else if (next_unused < SPATIAL_MAX_ENTRIES) {
+            e = ++next_unused;
+        } else {
+            if (!limit_warned) {
+                limit_warned = 1;
+                print_timestamp();
+                printf("⚠  Índice espacial cheio (%d rovers)\n", SPATIAL_MAX_ENTRIES);
+            }
+            pthread_mutex_unlock(&spatial_lock);
+            return;
+        }
+
+        SpatialEntry *ent = &entries[e - 1];
+        memset(ent, 0, sizeof(*ent));
+        strncpy(ent->rover_id, rover_id, sizeof(ent->rover_id) - 1);
+        ent->in_use = 1;
+        unsigned b = id_hash(rover_id);
+        ent->id_next = id_heads[b];
+        id_heads[b] = e;
+
+        ent->cx = cell_coord(x);
+        ent->cy = cell_coord(y);
+        cell_link(e);
+        entry_count++;
+    } else {
+        // Só muda de lista quando atravessa a fronteira de uma célula
+        SpatialEntry *ent = &entries[e - 1];
+        int32_t cx = cell_coord(x), cy = cell_coord(y);
+        if (cx != ent->cx || cy != ent->cy) {
+            cell_unlink(e);
+            ent->cx = cx;
+            ent->cy = cy;
+            cell_link(e);
+        }
+    }
+
+    entries[e - 1].x = x;
+    entries[e - 1].y = y;
+    entries[e - 1].last_update = time(NULL);
+
+    pthread_mutex_unlock(&spatial_lock);
+}
+
+void spatial_index_remove(const char *rover_id) {
+    if (!rover_id) return;
+
+    pthread_mutex_lock(&spatial_lock);
+
+    int e = find_entry(rover_id);
+    if (e) {
+        cell_unlink(e);
+
+        int *link = &id_heads[id_hash(rover_id)];
+        while (*link != e) link = &entries[*link - 1].id_next;
+        *link = entries[e - 1].id_next;
+
+        entries[e - 1].in_use = 0;
+        entries[e - 1].cell_next = free_head;
+        free_head = e;
+        entry_count--;
+    }
+
+    pthread_mutex_unlock(&spatial_lock);
+}
+
+size_t spatial_index_count(void) {
+    pthread_mutex_lock(&spatial_lock);
+    size_t n = entry_count;
+    pthread_mutex_unlock(&spatial_lock);
+    return n;
+}
+
+// ============ CONSULTAS ============
+
+static void fill_result(SpatialResult *r, const SpatialEntry *ent, float distance) {
+    memcpy(r->rover_id, ent->rover_id, sizeof(r->rover_id));
+    r->x = ent->x;
+    r->y = ent->y;
+    r->distance = distance;
+    r->last_update = ent->last_update;
+}
+
+size_t spatial_index_query_bbox(float x1, float y1, float x2, float y2,
+                                SpatialResult *out, size_t max_out, int *truncated) {
+    if (truncated) *truncated = 0;
+    if (!out || max_out == 0) return 0;
+    if (!isfinite(x1) || !isfinite(y1) || !isfinite(x2) || !isfinite(y2)) return 0;
+
+    if (x1 > x2) { float t = x1; x1 = x2; x2 = t; }
+    if (y1 > y2) { float t = y1; y1 = y2; y2 = t; }
+
+    int32_t cx1 = cell_coord(x1), cx2 = cell_coord(x2);
+    int32_t cy1 = cell_coord(y1), cy2 = cell_coord(y2);
+    uint64_t cells = (uint64_t)((int64_t)cx2 - cx1 + 1) * (uint64_t)((int64_t)cy2 - cy1 + 1);
+    size_t n = 0;
+
+    pthread_mutex_lock(&spatial_lock);
+
+    if (cells > entry_count) {
+        // Retângulo com mais células do que rovers: varrer as entradas é mais barato
+        for (int e = 1; e <= next_unused; e++) {
+            const SpatialEntry *ent = &entries[e - 1];
+            if (!ent->in_use) continue;
+            if (ent->x < x1 || ent->x > x2 || ent->y < y1 || ent->y > y2) continue;
+            if (n == max_out) {
+                if (truncated) *truncated = 1;
+                break;
+            }
+            fill_result(&out[n++], ent, 0.0f);
+        }
+    } else {
+        for (int32_t cx = cx1; cx <= cx2; cx++) {
+            for (int32_t cy = cy1; cy <= cy2; cy++) {
+                for (int e = cell_heads[cell_hash(cx, cy)]; e; e = entries[e - 1].cell_next) {
+                    const SpatialEntry *ent = &entries[e - 1];
+                    if (ent->cx != cx || ent->cy != cy) continue;
+                    if (ent->x < x1 || ent->x > x2 || ent->y < y1 || ent->y > y2) continue;
+                    if (n == max_out) {
+                        if (truncated) *truncated = 1;
+                        goto done;
+                    }
+                    fill_result(&out[n++], ent, 0.0f);
+                }
+            }
+        }
+    }
+done:
+    pthread_mutex_unlock(&spatial_lock);
+    return n;
+}
+
+// Melhores k candidatos, ordenados por distância (ao quadrado) crescente
+typedef struct {
+    int entry[SPATIAL_MAX_K];
+    float d2[SPATIAL_MAX_K];
+    size_t count;
+    size_t k;
+} NearestSet;
+
+static void nearest_offer(NearestSet *set, int e, float d2) {
+    if (set->count == set->k && d2 >= set->d2[set->count - 1]) return;
+
+    size_t i = (set->count < set->k) ? set->count++ : set->count - 1;
+    while (i > 0 && set->d2[i - 1] > d2) {
+        set->d2[i] = set->d2[i - 1];
+        set->entry[i] = set->entry[i - 1];
+        i--;
+    }
+    set->d2[i] = d2;
+    set->entry[i] = e;
+}
+
+static size_t visit_cell(NearestSet *set, int32_t cx, int32_t cy, float x, float y) {
+    size_t visited = 0;
+    for (int e = cell_heads[cell_hash(cx, cy)]; e; e = entries[e - 1].cell_next) {
+        const SpatialEntry *ent = &entries[e - 1];
+        if (ent->cx != cx || ent->cy != cy) continue;
+        float dx = ent->x - x, dy = ent->y - y;
+        nearest_offer(set, e, dx * dx + dy * dy);
+        visited++;
+    }
+    return visited;
+}
+
+size_t spatial_index_nearest(float x, float y, size_t k, SpatialResult *out) {
+    if (!out || k == 0 || !isfinite(x) || !isfinite(y)) return 0;
+    if (k > SPATIAL_MAX_K) k = SPATIAL_MAX_K;
+
+    NearestSet set;
+    set.count = 0;
+    set.k = k;
+
+    pthread_mutex_lock(&spatial_lock);
+
+    int32_t qx = cell_coord(x), qy = cell_coord(y);
+    size_t visited = 0;
+    int r;
+
+    // Anéis de células concêntricos à volta da célula da consulta. Após o
+    // anel r, qualquer rover por visitar está a pelo menos r * CELL_SIZE.
+    for (r = 0; r <= SPATIAL_MAX_RINGS && visited < entry_count; r++) {
+        if (r == 0) {
+            visited += visit_cell(&set, qx, qy, x, y);
+        } else {
+            for (int32_t dx = -r; dx <= r; dx++) {
+                visited += visit_cell(&set, qx + dx, qy - r, x, y);
+                visited += visit_cell(&set, qx + dx, qy + r, x, y);
+            }
+            for (int32_t dy = -r + 1; dy <= r - 1; dy++) {
+                visited += visit_cell(&set, qx - r, qy + dy, x, y);
+                visited += visit_cell(&set, qx + r, qy + dy, x, y);
+            }
+        }
+
+        float reach = (float)r * SPATIAL_CELL_SIZE;
+        if (set.count == set.k && set.d2[set.count - 1] <= reach * reach) break;
+    }
+
+    // Rovers muito afastados: completar com um varrimento das entradas
+    if (r > SPATIAL_MAX_RINGS && visited < entry_count) {
+        set.count = 0;
+        for (int e = 1; e <= next_unused; e++) {
+            const SpatialEntry *ent = &entries[e - 1];
+            if (!ent->in_use) continue;
+            float dx = ent->x - x, dy = ent->y - y;
+            nearest_offer(&set, e, dx * dx + dy * dy);
+        }
+    }
+
+    for (size_t i = 0; i < set.count; i++) {
+        fill_result(&out[i], &entries[set.entry[i] - 1], sqrtf(set.d2[i]));
+    }
+
+    pthread_mutex_unlock(&spatial_lock);
+    return set.count;
+}
@@ -0,0 +1,245 @@
+// ============ TelemetryCompression.c ============
+// Codificador/descodificador Gorilla para blocos de telemetria
+#include "TelemetryCompression.h"
+#include <string.h>
+
+// ============ ESCRITA DE BITS ============
+
+typedef struct {
+    uint8_t *buf;                    // Buffer previamente a zero
+    size_t pos;                      // Posição em bits
+} BitWriter;
+
+static void bw_put(BitWriter *w, uint32_t value, int nbits) {
+    while (nbits > 0) {
+        size_t byte = w->pos >> 3;
+        int space = 8 - (int)(w->pos & 7);
+        int take = (nbits < space) ? nbits : space;
+        uint32_t chunk = (value >> (nbits - take)) & ((1u << take) - 1);
+
+        w->buf[byte] |= (uint8_t)(chunk << (space - take));
+        w->pos += take;
+        nbits -= take;
+    }
+}
+
+// ============ LEITURA DE BITS ============
+
+typedef struct {
+    const uint8_t *buf;
+    size_t pos;                      // Posição em bits
+    size_t limit;                    // Bits úteis
+} BitReader;
+
+static inline uint64_t load_be64(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+// Ler 1..32 bits (o padding garante 8 bytes legíveis em qualquer posição)
+static inline uint32_t br_get(BitReader *r, int nbits) {
+    uint64_t word = load_be64(r->buf + (r->pos >> 3)) << (r->pos & 7);
+    r->pos += nbits;
+    return (uint32_t)(word >> (64 - nbits));
+}
+
+static inline uint32_t float_bits(float f) {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+static inline float bits_float(uint32_t u) {
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+// ============ COLUNAS ============
+
+// Timestamps: valor inicial em bruto (segundos + milissegundos), depois
+// delta-of-delta em milissegundos. Amostragem regular (ex.: 200 ms) custa 1 bit.
+static void encode_timestamps(BitWriter *w, const uint32_t *ts, const uint16_t *ms, size_t n) {
+    bw_put(w, ts[0], 32);
+    bw_put(w, ms[0], 10);
+    int64_t prev = ms[0];
+    int64_t prev_delta = 0;
+
+    for (size_t i = 1; i < n; i++) {
+        int64_t cur = ((int64_t)ts[i] - (int64_t)ts[0]) * 1000 + ms[i];
+        int64_t delta = cur - prev;
+        int64_t dod = delta - prev_delta;
+        prev = cur;
+        prev_delta = delta;
+
+        if (dod == 0) {
+            bw_put(w, 0x0, 1);                      // '0'
+        } else if (dod >= -64 && dod <= 63) {
+            bw_put(w, 0x2, 2);                      // '10'
+            bw_put(w, (uint32_t)dod & 0x7F, 7);
+        } else if (dod >= -256 && dod <= 255) {
+            bw_put(w, 0x6, 3);                      // '110'
+            bw_put(w, (uint32_t)dod & 0x1FF, 9);
+        } else if (dod >= -2048 && dod <= 2047) {
+            bw_put(w, 0xE, 4);                      // '1110'
+            bw_put(w, (uint32_t)dod & 0xFFF, 12);
+        } else {
+            bw_put(w, 0xF, 4);                      // '1111' + 48 bits
+            bw_put(w, (uint32_t)((uint64_t)dod >> 32) & 0xFFFF, 16);
+            bw_put(w, (uint32_t)dod, 32);
+        }
+    }
+}
+
+static inline int64_t sign_extend(uint32_t v, int bits) {
+    uint32_t m = 1u << (bits - 1);
+    return (int64_t)(int32_t)((v ^ m) - m);
+}
+
+static void decode_timestamps(BitReader *r, uint32_t *ts, uint16_t *ms, size_t n) {
+    ts[0] = br_get(r, 32);
+    ms[0] = (uint16_t)br_get(r, 10);
+    int64_t cur = ms[0];
+    int64_t delta = 0;
+
+    for (size_t i = 1; i < n; i++) {
+        int64_t dod;
+        if (br_get(r, 1) == 0) {
+            dod = 0;
+        } else if (br_get(r, 1) == 0) {
+            dod = sign_extend(br_get(r, 7), 7);
+        } else if (br_get(r, 1) == 0) {
+            dod = sign_extend(br_get(r, 9), 9);
+        } else if (br_get(r, 1) == 0) {
+            dod = sign_extend(br_get(r, 12), 12);
+        } else {
+            uint64_t hi = br_get(r, 16);
+            uint64_t raw = (hi << 32) | br_get(r, 32);
+            uint64_t m = 1ull << 47;
+            dod = (int64_t)((raw ^ m) - m);
+        }
+        delta += dod;
+        cur += delta;
+        ts[i] = (uint32_t)((int64_t)ts[0] + cur / 1000);
+        ms[i] = (uint16_t)(cur % 1000);
+    }
+}
+
+// Floats: XOR com o anterior, reutilizando a janela de bits significativos
+static void encode_floats(BitWriter *w, const float *v, size_t n) {
+    uint32_t prev = float_bits(v[0]);
+    int prev_lead = -1, prev_trail = 0;
+
+    bw_put(w, prev, 32);
+
+    for (size_t i = 1; i < n; i++) {
+        uint32_t bits = float_bits(v[i]);
+        uint32_t x = bits ^ prev;
+        prev = bits;
+
+        if (x == 0) {
+            bw_put(w, 0x0, 1);                      // '0': valor repetido
+            continue;
+        }
+
+        int lead = __builtin_clz(x);
+        int trail = __builtin_ctz(x);
+
+        if (prev_lead >= 0 && lead >= prev_lead && trail >= prev_trail) {
+            int len = 32 - prev_lead - prev_trail;
+            bw_put(w, 0x2, 2);                      // '10': mesma janela
+            bw_put(w, x >> prev_trail, len);
+        } else {
+            int len = 32 - lead - trail;
+            bw_put(w, 0x3, 2);                      // '11': nova janela
+            bw_put(w, (uint32_t)lead, 5);
+            bw_put(w, (uint32_t)(len - 1), 5);
+            bw_put(w, x >> trail, len);
+            prev_lead = lead;
+            prev_trail = trail;
+        }
+    }
+}
+
+static void decode_floats(BitReader *r, float *v, size_t n) {
+    uint32_t prev = br_get(r, 32);
+    int lead = 0, len = 32;
+
+    v[0] = bits_float(prev);
+
+    for (size_t i = 1; i < n; i++) {
+        if (br_get(r, 1) == 0) {
+            v[i] = bits_float(prev);
+            continue;
+        }
+        if (br_get(r, 1) == 1) {
+            lead = (int)br_get(r, 5);
+            len = (int)br_get(r, 5) + 1;
+        }
+        uint32_t x = br_get(r, len) << (32 - lead - len);
+        prev ^= x;
+        v[i] = bits_float(prev);
+    }
+}
+
+// Bytes: '0' se igual ao anterior, '1' + 8 bits caso contrário
+static void encode_bytes(BitWriter *w, const uint8_t *v, size_t n) {
+    bw_put(w, v[0], 8);
+    for (size_t i = 1; i < n; i++) {
+        if (v[i] == v[i - 1]) {
+            bw_put(w, 0x0, 1);
+        } else {
+            bw_put(w, 0x100u | v[i], 9);
+        }
+    }
+}
+
+static void decode_bytes(BitReader *r, uint8_t *v, size_t n) {
+    v[0] = (uint8_t)br_get(r, 8);
+    for (size_t i = 1; i < n; i++) {
+        v[i] = br_get(r, 1) ? (uint8_t)br_get(r, 8) : v[i - 1];
+    }
+}
+
+// ============ BLOCOS ============
+
+size_t tc_max_encoded_size(size_t n) {
+    return TC_MAX_ENCODED_SIZE(n);
+}
+
+size_t tc_encode_block(const TelemetryColumns *cols, size_t n, uint8_t *out) {
+    if (!cols || !out || n == 0) return 0;
+
+    memset(out, 0, tc_max_encoded_size(n));
+    BitWriter w = {out, 0};
+
+    encode_timestamps(&w, cols->timestamp, cols->timestamp_ms, n);
+    encode_floats(&w, cols->position_x, n);
+    encode_floats(&w, cols->position_y, n);
+    encode_floats(&w, cols->temperature, n);
+    encode_bytes(&w, cols->battery, n);
+    encode_bytes(&w, cols->signal_strength, n);
+    encode_bytes(&w, cols->state, n);
+
+    return (w.pos + 7) / 8;
+}
+
+int tc_decode_block(const uint8_t *in, size_t in_len, size_t n, TelemetryColumns *cols) {
+    if (!in || !cols || n == 0) return -1;
+
+    BitReader r = {in, 0, in_len * 8};
+
+    decode_timestamps(&r, cols->timestamp, cols->timestamp_ms, n);
+    decode_floats(&r, cols->position_x, n);
+    decode_floats(&r, cols->position_y, n);
+    decode_floats(&r, cols->temperature, n);
+    decode_bytes(&r, cols->battery, n);
+    decode_bytes(&r, cols->signal_strength, n);
+    decode_bytes(&r, cols->state, n);
+
+    return (r.pos <= r.limit) ? 0 : -1;
+}
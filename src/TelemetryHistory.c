@@ -0,0 +1,395 @@
+// ============ TelemetryHistory.c ============
+// Implementação do histórico de telemetria em memória
+#include "TelemetryHistory.h"
+#include "TelemetryCompression.h"
+#include "TelemetryStore.h"
+#include "MissionLink.h"
+#include "RoverRegistry.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Bytes por amostra sem compressão (todas as colunas)
+#define HISTORY_RAW_SAMPLE_BYTES (sizeof(uint32_t) + sizeof(uint16_t) + 3 * sizeof(float) + \
+                                  3 * sizeof(uint8_t))
+
+// Todos os rovers do registo podem ter histórico
+typedef char history_table_size_check[(MAX_HISTORY_ROVERS >= ROVER_REGISTRY_MAX) ? 1 : -1];
+
+// Tabela de IDs: endereçamento aberto com o dobro das entradas (nunca enche)
+#define HISTORY_ID_SLOTS (2 * MAX_HISTORY_ROVERS)
+
+// Tabela global de históricos, alocados a pedido (entradas nunca são removidas).
+// Só o ciclo principal insere; os workers HTTP leem sem lock: a entrada é
+// preenchida antes de o seu índice ser publicado (release/acquire).
+static TelemetryHistory *histories[MAX_HISTORY_ROVERS];
+static int id_slots[HISTORY_ID_SLOTS];       // Índice + 1 (0 = vazio)
+static int num_histories = 0;
+static int limit_warned = 0;
+static size_t history_capacity = TELEMETRY_HISTORY_DEFAULT_CAPACITY;
+
+void telemetry_history_init(size_t capacity) {
+    if (capacity < HISTORY_BLOCK_SAMPLES) capacity = HISTORY_BLOCK_SAMPLES;
+    history_capacity = capacity;
+
+    print_timestamp();
+    printf("📈 Histórico de telemetria: %zu amostras por rover (blocos de %d, Gorilla)\n\n",
+           history_capacity, HISTORY_BLOCK_SAMPLES);
+}
+
+static unsigned history_id_hash(const char *rover_id) {
+    // FNV-1a
+    uint32_t h = 2166136261u;
+    for (const char *p = rover_id; *p; p++) {
+        h ^= (uint8_t)*p;
+        h *= 16777619u;
+    }
+    return h & (HISTORY_ID_SLOTS - 1);
+}
+
+TelemetryHistory* telemetry_history_get(const char *rover_id) {
+    for (unsigned i = history_id_hash(rover_id);; i = (i + 1) & (HISTORY_ID_SLOTS - 1)) {
+        int e = __atomic_load_n(&id_slots[i], __ATOMIC_ACQUIRE);
+        if (e == 0) return NULL;
+        if (strcmp(histories[e - 1]->rover_id, rover_id) == 0) return histories[e - 1];
+    }
+}
+
+// Criar histórico (apenas o ciclo principal cria entradas)
+static TelemetryHistory* telemetry_history_create(const char *rover_id) {
+    if (num_histories >= MAX_HISTORY_ROVERS) {
+        if (!limit_warned) {
+            limit_warned = 1;
+            print_timestamp();
+            printf("⚠  Limite de históricos de telemetria atingido (%d rovers)\n",
+                   MAX_HISTORY_ROVERS);
+        }
+        return NULL;
+    }
+
+    TelemetryHistory *h = calloc(1, sizeof(*h));
+    if (!h) {
+        print_timestamp();
+        printf("❌ Sem memória para histórico de %s\n", rover_id);
+        return NULL;
+    }
+    snprintf(h->rover_id, sizeof(h->rover_id), "%s", rover_id);
+
+    // O bloco aberto conta para a capacidade total
+    h->max_blocks = (history_capacity + HISTORY_BLOCK_SAMPLES - 1) / HISTORY_BLOCK_SAMPLES;
+    if (h->max_blocks > 1) h->max_blocks--;
+    h->blocks = calloc(h->max_blocks, sizeof(HistoryBlock));
+    if (!h->blocks) {
+        print_timestamp();
+        printf("❌ Sem memória para histórico de %s\n", rover_id);
+        free(h);
+        return NULL;
+    }
+    pthread_mutex_init(&h->lock, NULL);
+
+    int idx = num_histories;
+    histories[idx] = h;
+    unsigned i = history_id_hash(rover_id);
+    while (id_slots[i] != 0) i = (i + 1) & (HISTORY_ID_SLOTS - 1);
+    __atomic_store_n(&id_slots[i], idx + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&num_histories, idx + 1, __ATOMIC_RELEASE);
+    return h;
+}
+
+static void history_open_columns(TelemetryHistory *h, TelemetryColumns *cols) {
+    cols->timestamp = h->open_timestamps;
+    cols->timestamp_ms = h->open_timestamp_ms;
+    cols->position_x = h->open_position_x;
+    cols->position_y = h->open_position_y;
+    cols->temperature = h->open_temperature;
+    cols->battery = h->open_battery;
+    cols->signal_strength = h->open_signal_strength;
+    cols->state = h->open_state;
+}
+
+// Comprimir o bloco aberto e acrescentá-lo aos blocos fechados
+// (chamado com o lock adquirido)
+static void history_close_block(TelemetryHistory *h) {
+    size_t n = h->open_count;
+    if (n == 0) return;
+
+    uint8_t scratch[TC_MAX_ENCODED_SIZE(HISTORY_BLOCK_SAMPLES)];
+    TelemetryColumns cols;
+    history_open_columns(h, &cols);
+    size_t nbytes = tc_encode_block(&cols, n, scratch);
+
+    uint8_t *data = malloc(nbytes + TC_STREAM_PADDING);
+    if (!data) return;  // Sem memória: o bloco aberto é simplesmente reciclado
+    memcpy(data, scratch, nbytes);
+    memset(data + nbytes, 0, TC_STREAM_PADDING);
+
+    // Buffer circular cheio: descartar o bloco mais antigo
+    if (h->num_blocks == h->max_blocks) {
+        HistoryBlock *oldest = &h->blocks[h->block_head];
+        h->compressed_bytes -= oldest->nbytes;
+        free(oldest->data);
+        h->block_head = (h->block_head + 1) % h->max_blocks;
+        h->num_blocks--;
+    }
+
+    HistoryBlock *b = &h->blocks[(h->block_head + h->num_blocks) % h->max_blocks];
+    b->first_ts = h->open_timestamps[0];
+    b->last_ts = h->open_timestamps[n - 1];
+    b->last_ms = h->open_timestamp_ms[n - 1];
+    b->count = (uint16_t)n;
+    b->nbytes = (uint32_t)nbytes;
+    b->data = data;
+    h->num_blocks++;
+    h->compressed_bytes += nbytes;
+}
+
+// Armazenar dados de telemetria no histórico
+void store_telemetry(TelemetrySession *session, TelemetryMessage *msg) {
+    if (!session || !msg || session->rover_id[0] == '\0') return;
+
+    TelemetryHistory *h = telemetry_history_get(session->rover_id);
+    if (!h) h = telemetry_history_create(session->rover_id);
+    if (!h) return;
+
+    pthread_mutex_lock(&h->lock);
+
+    // A pesquisa binária (e a compressão) exige timestamps não decrescentes
+    uint32_t ts = msg->timestamp;
+    uint16_t ms = (msg->timestamp_ms < 1000) ? msg->timestamp_ms : 0;
+    uint32_t last = 0;
+    uint16_t last_ms = 0;
+    if (h->open_count > 0) {
+        last = h->open_timestamps[h->open_count - 1];
+        last_ms = h->open_timestamp_ms[h->open_count - 1];
+    } else if (h->num_blocks > 0) {
+        HistoryBlock *b = &h->blocks[(h->block_head + h->num_blocks - 1) % h->max_blocks];
+        last = b->last_ts;
+        last_ms = b->last_ms;
+    }
+    if (ts < last || (ts == last && ms < last_ms)) {
+        ts = last;
+        ms = last_ms;
+    }
+
+    size_t idx = h->open_count++;
+    h->open_timestamps[idx] = ts;
+    h->open_timestamp_ms[idx] = ms;
+    h->open_position_x[idx] = msg->position_x;
+    h->open_position_y[idx] = msg->position_y;
+    h->open_temperature[idx] = msg->temperature;
+    h->open_battery[idx] = msg->battery;
+    h->open_signal_strength[idx] = msg->signal_strength;
+    h->open_state[idx] = msg->state;
+    h->written++;
+
+    if (h->open_count == HISTORY_BLOCK_SAMPLES) {
+        history_close_block(h);
+        h->open_count = 0;
+    }
+
+    pthread_mutex_unlock(&h->lock);
+
+    // Persistir em disco (segmentos mmap)
+    telemetry_store_append(session->rover_id, msg);
+}
+
+int telemetry_history_oldest(const char *rover_id, uint32_t *oldest) {
+    TelemetryHistory *h = telemetry_history_get(rover_id);
+    if (!h || !oldest) return 0;
+
+    pthread_mutex_lock(&h->lock);
+    int found = 1;
+    if (h->num_blocks > 0) {
+        *oldest = h->blocks[h->block_head].first_ts;
+    } else if (h->open_count > 0) {
+        *oldest = h->open_timestamps[0];
+    } else {
+        found = 0;
+    }
+    pthread_mutex_unlock(&h->lock);
+    return found;
+}
+
+// ============ CONSULTA ============
+
+// Estado da consulta, partilhado entre blocos. Guarda os max_out pontos
+// mais recentes (buffer circular em out[]): um intervalo largo devolve o fim
+typedef struct {
+    uint32_t from, to, step;
+    uint32_t next_ts;                // Próximo timestamp aceite (step)
+    TelemetrySample *out;
+    size_t max_out;
+    size_t seen;                     // Pontos aceites (devolvidos = min(seen, max_out))
+    int done;
+} HistoryCursor;
+
+// Primeira posição em [lo, count) com timestamp >= ts
+static size_t lower_bound_ts(const uint32_t *ts, size_t lo, size_t count, uint32_t target) {
+    size_t hi = count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (ts[mid] < target) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Emitir as amostras de um bloco (descomprimido ou aberto) que caem no intervalo
+static void history_emit_columns(HistoryCursor *c, const TelemetryColumns *cols, size_t count) {
+    uint32_t start = (c->next_ts > c->from) ? c->next_ts : c->from;
+    size_t i = lower_bound_ts(cols->timestamp, 0, count, start);
+
+    while (i < count) {
+        uint32_t ts = cols->timestamp[i];
+        if (ts > c->to) {
+            c->done = 1;
+            return;
+        }
+
+        TelemetrySample *s = &c->out[c->seen++ % c->max_out];
+        s->timestamp = ts;
+        s->timestamp_ms = cols->timestamp_ms[i];
+        s->position_x = cols->position_x[i];
+        s->position_y = cols->position_y[i];
+        s->battery = cols->battery[i];
+        s->temperature = cols->temperature[i];
+        s->signal_strength = cols->signal_strength[i];
+        s->state = cols->state[i];
+
+        if (c->step > 0) {
+            // Saltar diretamente para o próximo intervalo de 'step' segundos
+            uint32_t next = ts + c->step;
+            if (next < ts) {
+                c->done = 1;
+                return;
+            }
+            c->next_ts = next;
+            i = lower_bound_ts(cols->timestamp, i + 1, count, next);
+        } else {
+            i++;
+        }
+    }
+}
+
+static void reverse_samples(TelemetrySample *s, size_t lo, size_t hi) {
+    while (lo + 1 < hi) {
+        TelemetrySample tmp = s[lo];
+        s[lo++] = s[--hi];
+        s[hi] = tmp;
+    }
+}
+
+// Pôr o buffer circular por ordem cronológica (rotação in-place)
+static size_t history_cursor_finish(HistoryCursor *c) {
+    if (c->seen <= c->max_out) return c->seen;
+
+    size_t head = c->seen % c->max_out;
+    if (head > 0) {
+        reverse_samples(c->out, 0, head);
+        reverse_samples(c->out, head, c->max_out);
+        reverse_samples(c->out, 0, c->max_out);
+    }
+    return c->max_out;
+}
+
+// Primeiro bloco que pode contribuir para os max_out pontos mais recentes:
+// sem 'step', os blocos inteiramente dentro do intervalo contam todas as
+// amostras, e os anteriores seriam descartados pelo buffer circular
+static size_t history_first_useful_block(const TelemetryHistory *h, const HistoryCursor *c) {
+    if (c->step > 0) return 0;
+
+    size_t newer = 0;
+    if (h->open_count > 0 && h->open_timestamps[0] >= c->from &&
+        h->open_timestamps[h->open_count - 1] <= c->to) {
+        newer = h->open_count;
+    }
+    for (size_t b = h->num_blocks; b-- > 0;) {
+        if (newer >= c->max_out) return b + 1;
+        const HistoryBlock *blk = &h->blocks[(h->block_head + b) % h->max_blocks];
+        if (blk->first_ts >= c->from && blk->last_ts <= c->to) newer += blk->count;
+    }
+    return 0;
+}
+
+size_t telemetry_history_query(const char *rover_id, uint32_t from, uint32_t to,
+                               uint32_t step, TelemetrySample *out, size_t max_out,
+                               int *truncated) {
+    if (truncated) *truncated = 0;
+
+    TelemetryHistory *h = telemetry_history_get(rover_id);
+    if (!h || !out || max_out == 0 || from > to) return 0;
+
+    HistoryCursor c;
+    memset(&c, 0, sizeof(c));
+    c.from = from;
+    c.to = to;
+    c.step = step;
+    c.out = out;
+    c.max_out = max_out;
+
+    // Colunas temporárias para descomprimir um bloco de cada vez
+    uint32_t ts[HISTORY_BLOCK_SAMPLES];
+    uint16_t ms[HISTORY_BLOCK_SAMPLES];
+    float px[HISTORY_BLOCK_SAMPLES], py[HISTORY_BLOCK_SAMPLES], temp[HISTORY_BLOCK_SAMPLES];
+    uint8_t bat[HISTORY_BLOCK_SAMPLES], sig[HISTORY_BLOCK_SAMPLES], st[HISTORY_BLOCK_SAMPLES];
+    TelemetryColumns decoded = {ts, ms, px, py, temp, bat, sig, st};
+
+    pthread_mutex_lock(&h->lock);
+
+    size_t first = history_first_useful_block(h, &c);
+    for (size_t b = 0; b < first; b++) {
+        // Blocos saltados com pontos no intervalo: a resposta está truncada
+        // (somar max_out não muda a posição no buffer circular)
+        HistoryBlock *blk = &h->blocks[(h->block_head + b) % h->max_blocks];
+        if (blk->last_ts >= from && blk->first_ts <= to) {
+            c.seen += c.max_out;
+            break;
+        }
+    }
+
+    for (size_t b = first; b < h->num_blocks && !c.done; b++) {
+        HistoryBlock *blk = &h->blocks[(h->block_head + b) % h->max_blocks];
+        if (blk->last_ts < from || blk->last_ts < c.next_ts) continue;
+        if (blk->first_ts > to) {
+            c.done = 1;
+            break;
+        }
+        if (tc_decode_block(blk->data, blk->nbytes, blk->count, &decoded) < 0) continue;
+        history_emit_columns(&c, &decoded, blk->count);
+    }
+
+    if (!c.done && h->open_count > 0) {
+        TelemetryColumns open;
+        history_open_columns(h, &open);
+        history_emit_columns(&c, &open, h->open_count);
+    }
+
+    pthread_mutex_unlock(&h->lock);
+
+    if (truncated) *truncated = (c.seen > c.max_out);
+    return history_cursor_finish(&c);
+}
+
+void telemetry_history_stats(TelemetryHistoryStats *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(*stats));
+
+    int count = __atomic_load_n(&num_histories, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < count; i++) {
+        TelemetryHistory *h = histories[i];
+        pthread_mutex_lock(&h->lock);
+
+        uint64_t samples = h->open_count;
+        for (size_t b = 0; b < h->num_blocks; b++) {
+            samples += h->blocks[(h->block_head + b) % h->max_blocks].count;
+        }
+        stats->samples += samples;
+        stats->raw_bytes += samples * HISTORY_RAW_SAMPLE_BYTES;
+        stats->stored_bytes += h->compressed_bytes + h->open_count * HISTORY_RAW_SAMPLE_BYTES;
+
+        pthread_mutex_unlock(&h->lock);
+    }
+}
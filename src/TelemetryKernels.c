@@ -0,0 +1,364 @@
+// ============ TelemetryKernels.c ============
+// Implementação dos kernels de agregação (escalar, SSE2, AVX2)
+#include "TelemetryKernels.h"
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TK_HAVE_X86 1
+#endif
+
+// ============ ESCALAR ============
+
+static void scalar_minmax_f32(const float *v, size_t n, float *min, float *max) {
+    float lo = 0.0f, hi = 0.0f;
+    if (n > 0) {
+        lo = hi = v[0];
+        for (size_t i = 1; i < n; i++) {
+            if (v[i] < lo) lo = v[i];
+            if (v[i] > hi) hi = v[i];
+        }
+    }
+    *min = lo;
+    *max = hi;
+}
+
+static double scalar_sum_f32(const float *v, size_t n) {
+    double sum = 0.0;
+    for (size_t i = 0; i < n; i++) sum += v[i];
+    return sum;
+}
+
+static size_t scalar_count_below_f32(const float *v, size_t n, float threshold) {
+    size_t count = 0;
+    for (size_t i = 0; i < n; i++) count += (v[i] < threshold);
+    return count;
+}
+
+static void scalar_minmax_u8(const uint8_t *v, size_t n, uint8_t *min, uint8_t *max) {
+    uint8_t lo = 0, hi = 0;
+    if (n > 0) {
+        lo = hi = v[0];
+        for (size_t i = 1; i < n; i++) {
+            if (v[i] < lo) lo = v[i];
+            if (v[i] > hi) hi = v[i];
+        }
+    }
+    *min = lo;
+    *max = hi;
+}
+
+static uint64_t scalar_sum_u8(const uint8_t *v, size_t n) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; i++) sum += v[i];
+    return sum;
+}
+
+static size_t scalar_count_below_u8(const uint8_t *v, size_t n, uint8_t threshold) {
+    size_t count = 0;
+    for (size_t i = 0; i < n; i++) count += (v[i] < threshold);
+    return count;
+}
+
+static const TelemetryKernels kernels_scalar = {
+    "scalar",
+    scalar_minmax_f32, scalar_sum_f32, scalar_count_below_f32,
+    scalar_minmax_u8, scalar_sum_u8, scalar_count_below_u8
+};
+
+#ifdef TK_HAVE_X86
+
+// ============ SSE2 ============
+// Blocos de 16 bytes; o resto é tratado pelos kernels escalares
+
+__attribute__((target("sse2")))
+static void sse2_minmax_f32(const float *v, size_t n, float *min, float *max) {
+    if (n < 4) {
+        scalar_minmax_f32(v, n, min, max);
+        return;
+    }
+
+    __m128 vmin = _mm_loadu_ps(v), vmax = vmin;
+    size_t i = 4;
+    for (; i + 4 <= n; i += 4) {
+        __m128 x = _mm_loadu_ps(v + i);
+        vmin = _mm_min_ps(vmin, x);
+        vmax = _mm_max_ps(vmax, x);
+    }
+
+    float lanes_min[4], lanes_max[4], tail_min, tail_max;
+    _mm_storeu_ps(lanes_min, vmin);
+    _mm_storeu_ps(lanes_max, vmax);
+    float lo = lanes_min[0], hi = lanes_max[0];
+    for (int k = 1; k < 4; k++) {
+        if (lanes_min[k] < lo) lo = lanes_min[k];
+        if (lanes_max[k] > hi) hi = lanes_max[k];
+    }
+    if (i < n) {
+        scalar_minmax_f32(v + i, n - i, &tail_min, &tail_max);
+        if (tail_min < lo) lo = tail_min;
+        if (tail_max > hi) hi = tail_max;
+    }
+    *min = lo;
+    *max = hi;
+}
+
+__attribute__((target("sse2")))
+static double sse2_sum_f32(const float *v, size_t n) {
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 x = _mm_loadu_ps(v + i);
+        acc0 = _mm_add_pd(acc0, _mm_cvtps_pd(x));
+        acc1 = _mm_add_pd(acc1, _mm_cvtps_pd(_mm_movehl_ps(x, x)));
+    }
+
+    double lanes[2];
+    _mm_storeu_pd(lanes, _mm_add_pd(acc0, acc1));
+    return lanes[0] + lanes[1] + scalar_sum_f32(v + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static size_t sse2_count_below_f32(const float *v, size_t n, float threshold) {
+    // A máscara da comparação vale -1 por faixa: subtrair acumula contagens
+    __m128 t = _mm_set1_ps(threshold);
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 lt = _mm_cmplt_ps(_mm_loadu_ps(v + i), t);
+        acc = _mm_sub_epi32(acc, _mm_castps_si128(lt));
+    }
+
+    uint32_t lanes[4];
+    _mm_storeu_si128((__m128i *)lanes, acc);
+    return (size_t)lanes[0] + lanes[1] + lanes[2] + lanes[3] +
+           scalar_count_below_f32(v + i, n - i, threshold);
+}
+
+__attribute__((target("sse2")))
+static void sse2_minmax_u8(const uint8_t *v, size_t n, uint8_t *min, uint8_t *max) {
+    if (n < 16) {
+        scalar_minmax_u8(v, n, min, max);
+        return;
+    }
+
+    __m128i vmin = _mm_loadu_si128((const __m128i *)v), vmax = vmin;
+    size_t i = 16;
+    for (; i + 16 <= n; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(v + i));
+        vmin = _mm_min_epu8(vmin, x);
+        vmax = _mm_max_epu8(vmax, x);
+    }
+
+    uint8_t lanes_min[16], lanes_max[16], lo, hi, tail_min, tail_max;
+    _mm_storeu_si128((__m128i *)lanes_min, vmin);
+    _mm_storeu_si128((__m128i *)lanes_max, vmax);
+    scalar_minmax_u8(lanes_min, 16, &lo, &tail_max);
+    scalar_minmax_u8(lanes_max, 16, &tail_min, &hi);
+    if (i < n) {
+        scalar_minmax_u8(v + i, n - i, &tail_min, &tail_max);
+        if (tail_min < lo) lo = tail_min;
+        if (tail_max > hi) hi = tail_max;
+    }
+    *min = lo;
+    *max = hi;
+}
+
+__attribute__((target("sse2")))
+static uint64_t sse2_sum_u8(const uint8_t *v, size_t n) {
+    // PSADBW contra zero soma 8 bytes em cada metade de 64 bits
+    __m128i zero = _mm_setzero_si128(), acc = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(v + i));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(x, zero));
+    }
+
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i *)lanes, acc);
+    return lanes[0] + lanes[1] + scalar_sum_u8(v + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static size_t sse2_count_below_u8(const uint8_t *v, size_t n, uint8_t threshold) {
+    if (threshold == 0) return 0;
+
+    // Sem comparação sem sinal em SSE2: x < t  <=>  min(x, t-1) == x.
+    // Contadores de 8 bits por faixa, despejados em 64 bits a cada 255 blocos.
+    __m128i limit = _mm_set1_epi8((char)(threshold - 1));
+    __m128i zero = _mm_setzero_si128(), total = _mm_setzero_si128();
+    size_t i = 0;
+    while (i + 16 <= n) {
+        __m128i acc = _mm_setzero_si128();
+        for (int k = 0; k < 255 && i + 16 <= n; k++, i += 16) {
+            __m128i x = _mm_loadu_si128((const __m128i *)(v + i));
+            acc = _mm_sub_epi8(acc, _mm_cmpeq_epi8(_mm_min_epu8(x, limit), x));
+        }
+        total = _mm_add_epi64(total, _mm_sad_epu8(acc, zero));
+    }
+
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i *)lanes, total);
+    return (size_t)(lanes[0] + lanes[1]) + scalar_count_below_u8(v + i, n - i, threshold);
+}
+
+static const TelemetryKernels kernels_sse2 = {
+    "sse2",
+    sse2_minmax_f32, sse2_sum_f32, sse2_count_below_f32,
+    sse2_minmax_u8, sse2_sum_u8, sse2_count_below_u8
+};
+
+// ============ AVX2 ============
+// Blocos de 32 bytes; o resto é tratado pelos kernels escalares
+
+__attribute__((target("avx2")))
+static void avx2_minmax_f32(const float *v, size_t n, float *min, float *max) {
+    if (n < 8) {
+        scalar_minmax_f32(v, n, min, max);
+        return;
+    }
+
+    __m256 vmin = _mm256_loadu_ps(v), vmax = vmin;
+    size_t i = 8;
+    for (; i + 8 <= n; i += 8) {
+        __m256 x = _mm256_loadu_ps(v + i);
+        vmin = _mm256_min_ps(vmin, x);
+        vmax = _mm256_max_ps(vmax, x);
+    }
+
+    float lanes_min[8], lanes_max[8], lo, hi, tail_min, tail_max;
+    _mm256_storeu_ps(lanes_min, vmin);
+    _mm256_storeu_ps(lanes_max, vmax);
+    scalar_minmax_f32(lanes_min, 8, &lo, &tail_max);
+    scalar_minmax_f32(lanes_max, 8, &tail_min, &hi);
+    if (i < n) {
+        scalar_minmax_f32(v + i, n - i, &tail_min, &tail_max);
+        if (tail_min < lo) lo = tail_min;
+        if (tail_max > hi) hi = tail_max;
+    }
+    *min = lo;
+    *max = hi;
+}
+
+__attribute__((target("avx2")))
+static double avx2_sum_f32(const float *v, size_t n) {
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_pd(acc0, _mm256_cvtps_pd(_mm_loadu_ps(v + i)));
+        acc1 = _mm256_add_pd(acc1, _mm256_cvtps_pd(_mm_loadu_ps(v + i + 4)));
+    }
+
+    double lanes[4];
+    _mm256_storeu_pd(lanes, _mm256_add_pd(acc0, acc1));
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + scalar_sum_f32(v + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static size_t avx2_count_below_f32(const float *v, size_t n, float threshold) {
+    __m256 t = _mm256_set1_ps(threshold);
+    size_t count = 0, i = 0;
+    for (; i + 8 <= n; i += 8) {
+        int mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(v + i), t, _CMP_LT_OQ));
+        count += (size_t)__builtin_popcount((unsigned)mask);
+    }
+    return count + scalar_count_below_f32(v + i, n - i, threshold);
+}
+
+__attribute__((target("avx2")))
+static void avx2_minmax_u8(const uint8_t *v, size_t n, uint8_t *min, uint8_t *max) {
+    if (n < 32) {
+        scalar_minmax_u8(v, n, min, max);
+        return;
+    }
+
+    __m256i vmin = _mm256_loadu_si256((const __m256i *)v), vmax = vmin;
+    size_t i = 32;
+    for (; i + 32 <= n; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(v + i));
+        vmin = _mm256_min_epu8(vmin, x);
+        vmax = _mm256_max_epu8(vmax, x);
+    }
+
+    uint8_t lanes_min[32], lanes_max[32], lo, hi, tail_min, tail_max;
+    _mm256_storeu_si256((__m256i *)lanes_min, vmin);
+    _mm256_storeu_si256((__m256i *)lanes_max, vmax);
+    scalar_minmax_u8(lanes_min, 32, &lo, &tail_max);
+    scalar_minmax_u8(lanes_max, 32, &tail_min, &hi);
+    if (i < n) {
+        scalar_minmax_u8(v + i, n - i, &tail_min, &tail_max);
+        if (tail_min < lo) lo = tail_min;
+        if (tail_max > hi) hi = tail_max;
+    }
+    *min = lo;
+    *max = hi;
+}
+
+__attribute__((target("avx2")))
+static uint64_t avx2_sum_u8(const uint8_t *v, size_t n) {
+    __m256i zero = _mm256_setzero_si256(), acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(v + i));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(x, zero));
+    }
+
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, acc);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + scalar_sum_u8(v + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static size_t avx2_count_below_u8(const uint8_t *v, size_t n, uint8_t threshold) {
+    if (threshold == 0) return 0;
+
+    __m256i limit = _mm256_set1_epi8((char)(threshold - 1));
+    size_t count = 0, i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(v + i));
+        int mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(x, limit), x));
+        count += (size_t)__builtin_popcount((unsigned)mask);
+    }
+    return count + scalar_count_below_u8(v + i, n - i, threshold);
+}
+
+static const TelemetryKernels kernels_avx2 = {
+    "avx2",
+    avx2_minmax_f32, avx2_sum_f32, avx2_count_below_f32,
+    avx2_minmax_u8, avx2_sum_u8, avx2_count_below_u8
+};
+
+#endif // TK_HAVE_X86
+
+// ============ DESPACHO ============
+
+static const TelemetryKernels *kernels_best = &kernels_scalar;
+static pthread_once_t kernels_once = PTHREAD_ONCE_INIT;
+
+static void kernels_select(void) {
+    kernels_best = telemetry_kernels_variant(TK_AVX2);
+    if (!kernels_best) kernels_best = telemetry_kernels_variant(TK_SSE2);
+    if (!kernels_best) kernels_best = &kernels_scalar;
+}
+
+const TelemetryKernels* telemetry_kernels(void) {
+    pthread_once(&kernels_once, kernels_select);
+    return kernels_best;
+}
+
+const TelemetryKernels* telemetry_kernels_variant(TelemetryKernelISA isa) {
+    switch (isa) {
+        case TK_SCALAR:
+            return &kernels_scalar;
+#ifdef TK_HAVE_X86
+        case TK_SSE2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse2") ? &kernels_sse2 : NULL;
+        case TK_AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") ? &kernels_avx2 : NULL;
+#endif
+        default:
+            return NULL;
+    }
+}
@@ -0,0 +1,172 @@
+// ============ TelemetryRate.c ============
+// Implementação do controlo adaptativo da taxa de telemetria
+#include "TelemetryRate.h"
+#include "MissionLink.h"
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/socket.h>
+
+// ============ OBSERVADORES (API) ============
+
+typedef struct {
+    char rover_id[32];
+    time_t last_watch;
+} WatchSlot;
+
+static WatchSlot watch_slots[TELEMETRY_WATCH_SLOTS];
+static pthread_mutex_t watch_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void telemetry_watch_touch(const char *rover_id) {
+    if (!rover_id || rover_id[0] == '\0') return;
+
+    time_t now = time(NULL);
+    pthread_mutex_lock(&watch_lock);
+
+    // Reutilizar a entrada do rover ou a mais antiga
+    int slot = 0;
+    for (int i = 0; i < TELEMETRY_WATCH_SLOTS; i++) {
+        if (strcmp(watch_slots[i].rover_id, rover_id) == 0) {
+            slot = i;
+            break;
+        }
+        if (watch_slots[i].last_watch < watch_slots[slot].last_watch) slot = i;
+    }
+    strncpy(watch_slots[slot].rover_id, rover_id, sizeof(watch_slots[slot].rover_id) - 1);
+    watch_slots[slot].last_watch = now;
+
+    pthread_mutex_unlock(&watch_lock);
+}
+
+int telemetry_watch_active(const char *rover_id, time_t now) {
+    int active = 0;
+    pthread_mutex_lock(&watch_lock);
+    for (int i = 0; i < TELEMETRY_WATCH_SLOTS; i++) {
+        if (strcmp(watch_slots[i].rover_id, rover_id) == 0) {
+            active = (now - watch_slots[i].last_watch) < TELEMETRY_WATCH_WINDOW;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&watch_lock);
+    return active;
+}
+
+// ============ CARGA DO SERVIDOR ============
+
+static time_t last_period = 0;
+static uint64_t last_ingested = 0;
+static double last_wall = 0.0;
+static double last_cpu = 0.0;
+
+static double clock_seconds(clockid_t id) {
+    struct timespec ts;
+    clock_gettime(id, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Intervalo de um rover (ms), dado o fator de carga do servidor
+static uint32_t rover_interval(const TelemetrySession *s, double load, time_t now) {
+    int favored = s->last_state == STATE_IN_MISSION ||
+                  s->last_battery < TELEMETRY_LOW_BATTERY ||
+                  telemetry_watch_active(s->rover_id, now);
+
+    double interval = TELEMETRY_SAMPLE_INTERVAL_MS;
+    if (favored) {
+        // Prioritários abrandam para metade do que a carga exigiria
+        if (load > 2.0) interval *= load / 2.0;
+    } else {
+        interval *= TELEMETRY_IDLE_FACTOR;
+        if (load > 1.0) interval *= load;
+    }
+
+    if (interval < TELEMETRY_RATE_MIN_MS) interval = TELEMETRY_RATE_MIN_MS;
+    if (interval > TELEMETRY_RATE_MAX_MS) interval = TELEMETRY_RATE_MAX_MS;
+    return (uint32_t)interval;
+}
+
+// Enviar o resto de uma mensagem de controlo parcialmente enviada.
+// Devolve 1 se não ficou nada pendente, 0 se o socket continua cheio.
+static int rate_flush_pending(TelemetrySession *s) {
+    while (s->rate_pending_off < s->rate_pending_len) {
+        ssize_t sent = send(s->sockfd, s->rate_pending + s->rate_pending_off,
+                            s->rate_pending_len - s->rate_pending_off,
+                            MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (sent <= 0) return 0;     // Cheio ou erro (a receção fecha a sessão)
+        s->rate_pending_off += (uint8_t)sent;
+    }
+    s->rate_pending_len = s->rate_pending_off = 0;
+    return 1;
+}
+
+void telemetry_rate_control(TelemetryPool *pool, time_t now) {
+    if (now - last_period < TELEMETRY_RATE_PERIOD) return;
+
+    double wall = clock_seconds(CLOCK_MONOTONIC);
+    double cpu = clock_seconds(CLOCK_PROCESS_CPUTIME_ID);
+    uint64_t ingested = telemetry_samples_ingested();
+
+    if (last_period == 0) {
+        // Primeira medição: só estabelecer a referência
+        last_period = now;
+        last_wall = wall;
+        last_cpu = cpu;
+        last_ingested = ingested;
+        return;
+    }
+
+    double elapsed = wall - last_wall;
+    if (elapsed <= 0.0) return;
+    double ingest_rate = (double)(ingested - last_ingested) / elapsed;
+    double cpu_share = (cpu - last_cpu) / elapsed;
+
+    last_period = now;
+    last_wall = wall;
+    last_cpu = cpu;
+    last_ingested = ingested;
+
+    // Fator de carga: >1 significa que o servidor está acima do orçamento
+    double load = ingest_rate / TELEMETRY_INGEST_BUDGET;
+    if (cpu_share / TELEMETRY_CPU_BUDGET > load) load = cpu_share / TELEMETRY_CPU_BUDGET;
+
+    for (size_t i = 0; i < pool->used; i++) {
+        TelemetrySession *s = telemetry_pool_at(pool, i);
+        // Só rovers que negociaram v2 sabem ler mensagens de controlo
+        if (!s->active || s->sockfd <= 0 || s->version < 2) continue;
+
+        // Mensagem anterior a meio: acabá-la primeiro (o rover lê frames de 8 bytes)
+        if (!rate_flush_pending(s)) continue;
+
+        uint32_t interval = rover_interval(s, load, now);
+        uint32_t latency = interval * 5;
+        if (latency < TELEMETRY_BATCH_LATENCY_MS) latency = TELEMETRY_BATCH_LATENCY_MS;
+        if (latency > TELEMETRY_RATE_MAX_MS) latency = TELEMETRY_RATE_MAX_MS;
+
+        // Enviar só quando muda mais de 10% (ou periodicamente)
+        uint32_t prev = s->rate_interval_ms;
+        int changed = prev == 0 || interval * 10 > prev * 11 || interval * 11 < prev * 10;
+        if (!changed && now - s->rate_sent_at < TELEMETRY_RATE_REFRESH) continue;
+
+        TelemetryRateControl ctl;
+        ctl.magic = TELEMETRY_CONTROL_MAGIC;
+        ctl.sample_interval_ms = (uint16_t)interval;
+        ctl.batch_latency_ms = (uint16_t)latency;
+
+        // Nunca bloquear o ciclo select(): um rover que não lê o controlo
+        // só perde as atualizações de taxa
+        ssize_t sent = send(s->sockfd, &ctl, sizeof(ctl), MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (sent > 0) {
+            if ((size_t)sent < sizeof(ctl)) {
+                memcpy(s->rate_pending, &ctl, sizeof(ctl));
+                s->rate_pending_len = sizeof(ctl);
+                s->rate_pending_off = (uint8_t)sent;
+            }
+            if (changed) {
+                print_timestamp();
+                printf("🎚  Taxa de telemetria %s: %u ms (carga %.2f, ingestão %.0f/s, CPU %.0f%%)\n\n",
+                       s->rover_id, interval, load, ingest_rate, cpu_share * 100.0);
+            }
+            s->rate_interval_ms = interval;
+            s->rate_sent_at = now;
+        }
+    }
+}
@@ -0,0 +1,267 @@
+// ============ TelemetryRollup.c ============
+// Implementação dos agregados multi-resolução de telemetria
+#include "TelemetryRollup.h"
+#include "MissionLink.h"
+#include "RoverRegistry.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const uint32_t level_resolution[ROLLUP_LEVELS] = {
+    ROLLUP_10S_RESOLUTION, ROLLUP_1MIN_RESOLUTION, ROLLUP_1H_RESOLUTION
+};
+static const size_t level_buckets[ROLLUP_LEVELS] = {
+    ROLLUP_10S_BUCKETS, ROLLUP_1MIN_BUCKETS, ROLLUP_1H_BUCKETS
+};
+
+// Todos os rovers do registo podem ter agregados
+typedef char rollup_table_size_check[(ROLLUP_MAX_ROVERS >= ROVER_REGISTRY_MAX) ? 1 : -1];
+
+// Tabela de IDs: endereçamento aberto com o dobro das entradas (nunca enche)
+#define ROLLUP_ID_SLOTS (2 * ROLLUP_MAX_ROVERS)
+
+// Tabela global, alocada a pedido (entradas nunca são removidas). Só o ciclo
+// principal insere; os workers leem sem lock (publicação release/acquire).
+static RoverRollups *rollups[ROLLUP_MAX_ROVERS];
+static int id_slots[ROLLUP_ID_SLOTS];        // Índice + 1 (0 = vazio)
+static int num_rollups = 0;
+static int limit_warned = 0;
+
+static unsigned rollup_id_hash(const char *rover_id) {
+    // FNV-1a
+    uint32_t h = 2166136261u;
+    for (const char *p = rover_id; *p; p++) {
+        h ^= (uint8_t)*p;
+        h *= 16777619u;
+    }
+    return h & (ROLLUP_ID_SLOTS - 1);
+}
+
+static RoverRollups* rollup_find(const char *rover_id) {
+    for (unsigned i = rollup_id_hash(rover_id);; i = (i + 1) & (ROLLUP_ID_SLOTS - 1)) {
+        int e = __atomic_load_n(&id_slots[i], __ATOMIC_ACQUIRE);
+        if (e == 0) return NULL;
+        if (strcmp(rollups[e - 1]->rover_id, rover_id) == 0) return rollups[e - 1];
+    }
+}
+
+// Criar agregados (apenas o ciclo principal cria entradas)
+static RoverRollups* rollup_create(const char *rover_id) {
+    if (num_rollups >= ROLLUP_MAX_ROVERS) {
+        if (!limit_warned) {
+            limit_warned = 1;
+            print_timestamp();
+            printf("⚠  Limite de agregados de telemetria atingido (%d rovers)\n",
+                   ROLLUP_MAX_ROVERS);
+        }
+        return NULL;
+    }
+
+    RoverRollups *r = calloc(1, sizeof(*r));
+    if (!r) return NULL;
+    snprintf(r->rover_id, sizeof(r->rover_id), "%s", rover_id);
+
+    for (int l = 0; l < ROLLUP_LEVELS; l++) {
+        r->levels[l].resolution = level_resolution[l];
+        r->levels[l].capacity = level_buckets[l];
+        r->levels[l].buckets = calloc(level_buckets[l], sizeof(RollupBucket));
+        if (!r->levels[l].buckets) {
+            for (int k = 0; k < l; k++) free(r->levels[k].buckets);
+            free(r);
+            print_timestamp();
+            printf("❌ Sem memória para agregados de %s\n", rover_id);
+            return NULL;
+        }
+    }
+    pthread_mutex_init(&r->lock, NULL);
+
+    int idx = num_rollups;
+    rollups[idx] = r;
+    unsigned i = rollup_id_hash(rover_id);
+    while (id_slots[i] != 0) i = (i + 1) & (ROLLUP_ID_SLOTS - 1);
+    __atomic_store_n(&id_slots[i], idx + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&num_rollups, idx + 1, __ATOMIC_RELEASE);
+    return r;
+}
+
+// ============ AGREGAÇÃO ============
+
+static void stat_init(RollupStat *s, float v) {
+    s->min = v;
+    s->max = v;
+    s->sum = v;
+    s->last = v;
+}
+
+static void stat_add(RollupStat *s, float v) {
+    if (v < s->min) s->min = v;
+    if (v > s->max) s->max = v;
+    s->sum += v;
+    s->last = v;
+}
+
+static void stat_merge(RollupStat *dst, const RollupStat *src) {
+    if (src->min < dst->min) dst->min = src->min;
+    if (src->max > dst->max) dst->max = src->max;
+    dst->sum += src->sum;
+    dst->last = src->last;
+}
+
+static void bucket_init(RollupBucket *b, uint32_t start, const TelemetryMessage *msg) {
+    b->start = start;
+    b->count = 1;
+    stat_init(&b->battery, msg->battery);
+    stat_init(&b->temperature, msg->temperature);
+    stat_init(&b->signal_strength, msg->signal_strength);
+    b->min_x = b->max_x = msg->position_x;
+    b->min_y = b->max_y = msg->position_y;
+    b->last_state = msg->state;
+}
+
+static void bucket_add(RollupBucket *b, const TelemetryMessage *msg) {
+    b->count++;
+    stat_add(&b->battery, msg->battery);
+    stat_add(&b->temperature, msg->temperature);
+    stat_add(&b->signal_strength, msg->signal_strength);
+    if (msg->position_x < b->min_x) b->min_x = msg->position_x;
+    if (msg->position_x > b->max_x) b->max_x = msg->position_x;
+    if (msg->position_y < b->min_y) b->min_y = msg->position_y;
+    if (msg->position_y > b->max_y) b->max_y = msg->position_y;
+    b->last_state = msg->state;
+}
+
+static void bucket_merge(RollupBucket *dst, const RollupBucket *src) {
+    dst->count += src->count;
+    stat_merge(&dst->battery, &src->battery);
+    stat_merge(&dst->temperature, &src->temperature);
+    stat_merge(&dst->signal_strength, &src->signal_strength);
+    if (src->min_x < dst->min_x) dst->min_x = src->min_x;
+    if (src->max_x > dst->max_x) dst->max_x = src->max_x;
+    if (src->min_y < dst->min_y) dst->min_y = src->min_y;
+    if (src->max_y > dst->max_y) dst->max_y = src->max_y;
+    dst->last_state = src->last_state;
+}
+
+static void level_update(RollupLevel *lvl, const TelemetryMessage *msg) {
+    uint32_t start = msg->timestamp - (msg->timestamp % lvl->resolution);
+
+    if (lvl->count > 0) {
+        RollupBucket *last = &lvl->buckets[(lvl->head + lvl->count - 1) % lvl->capacity];
+        // Amostras atrasadas são agregadas no intervalo corrente
+        if (start <= last->start) {
+            bucket_add(last, msg);
+            return;
+        }
+    }
+
+    // Novo intervalo: descartar o mais antigo se o buffer estiver cheio
+    if (lvl->count == lvl->capacity) {
+        lvl->head = (lvl->head + 1) % lvl->capacity;
+        lvl->count--;
+    }
+    bucket_init(&lvl->buckets[(lvl->head + lvl->count) % lvl->capacity], start, msg);
+    lvl->count++;
+}
+
+void telemetry_rollup_update(const char *rover_id, const TelemetryMessage *msg) {
+    if (!rover_id || !msg || rover_id[0] == '\0') return;
+
+    RoverRollups *r = rollup_find(rover_id);
+    if (!r) r = rollup_create(rover_id);
+    if (!r) return;
+
+    pthread_mutex_lock(&r->lock);
+    for (int l = 0; l < ROLLUP_LEVELS; l++) {
+        level_update(&r->levels[l], msg);
+    }
+    pthread_mutex_unlock(&r->lock);
+}
+
+// ============ CONSULTA ============
+
+uint32_t telemetry_rollup_resolution(uint32_t step) {
+    for (int l = ROLLUP_LEVELS - 1; l >= 0; l--) {
+        if (level_resolution[l] <= step) return level_resolution[l];
+    }
+    return 0;
+}
+
+int telemetry_rollup_query(const char *rover_id, uint32_t resolution,
+                           uint32_t from, uint32_t to, uint32_t step,
+                           RollupBucket *out, size_t max_out, int *truncated) {
+    if (truncated) *truncated = 0;
+
+    RoverRollups *r = rollup_find(rover_id);
+    if (!r) return -1;
+    if (!out || max_out == 0 || from > to) return 0;
+
+    RollupLevel *lvl = NULL;
+    for (int l = 0; l < ROLLUP_LEVELS; l++) {
+        if (r->levels[l].resolution == resolution) lvl = &r->levels[l];
+    }
+    if (!lvl) return 0;
+    if (step < resolution) step = resolution;
+
+    // Incluir o intervalo que contém 'from'
+    uint32_t first = from - (from % resolution);
+    size_t n = 0;
+
+    pthread_mutex_lock(&r->lock);
+
+    // Pesquisa binária pelo primeiro intervalo com início >= first
+    size_t lo = 0, hi = lvl->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (lvl->buckets[(lvl->head + mid) % lvl->capacity].start < first) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    size_t begin = lo;
+
+    // ...e pelo fim do intervalo (primeiro com início > to)
+    hi = lvl->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (lvl->buckets[(lvl->head + mid) % lvl->capacity].start <= to) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    // Percorrer do mais recente para o mais antigo: um intervalo largo
+    // devolve os max_out grupos mais recentes
+    for (size_t i = lo; i-- > begin;) {
+        const RollupBucket *b = &lvl->buckets[(lvl->head + i) % lvl->capacity];
+
+        // Reagrupar em intervalos de 'step' segundos
+        uint32_t group = b->start - (b->start % step);
+        if (n > 0 && out[n - 1].start == group) {
+            // O grupo já tem os intervalos mais recentes: são eles que ditam 'last'
+            RollupBucket older = *b;
+            older.start = group;
+            bucket_merge(&older, &out[n - 1]);
+            out[n - 1] = older;
+            continue;
+        }
+        if (n == max_out) {
+            if (truncated) *truncated = 1;
+            break;
+        }
+        out[n] = *b;
+        out[n].start = group;
+        n++;
+    }
+
+    pthread_mutex_unlock(&r->lock);
+
+    // Por ordem cronológica
+    for (size_t a = 0, z = n; a + 1 < z; a++, z--) {
+        RollupBucket tmp = out[a];
+        out[a] = out[z - 1];
+        out[z - 1] = tmp;
+    }
+    return (int)n;
+}
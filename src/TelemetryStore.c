@@ -0,0 +1,468 @@
+// ============ TelemetryStore.c ============
+// Implementação do armazenamento de telemetria em segmentos mmap
+#include "TelemetryStore.h"
+#include "MissionLink.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Verificações de layout em tempo de compilação (C99)
+typedef char store_record_size_check[(sizeof(TelemetryRecord) == 64) ? 1 : -1];
+typedef char store_header_size_check[(sizeof(StoreSegmentHeader) <= STORE_HEADER_SIZE_V1) ? 1 : -1];
+
+#define STORE_RECORD_BYTES ((size_t)STORE_SEGMENT_RECORDS * sizeof(TelemetryRecord))
+#define STORE_SEGMENT_BYTES (STORE_HEADER_SIZE + STORE_RECORD_BYTES)
+
+// ============ ESTRUTURA: SEGMENTO MAPEADO ============
+typedef struct {
+    uint32_t id;
+    char path[256];
+    int fd;
+    uint8_t *map;
+    size_t bytes;                    // Tamanho mapeado
+    StoreSegmentHeader *hdr;
+    StoreRoverFilter *filters;       // Um por bloco do índice (NULL na v1)
+    TelemetryRecord *records;
+    int in_use;                      // Publicado aos leitores (atómico)
+} StoreSegment;
+
+// Slots fixos: um segmento nunca muda de endereço enquanto está publicado.
+// Só o ciclo principal escreve; a remoção por retenção exige o write lock,
+// que só é tentado (trywrlock) para nunca bloquear o ciclo principal.
+static StoreSegment segments[STORE_MAX_SEGMENTS];
+static StoreSegment *active_segment = NULL;
+static uint32_t next_segment_id = 1;
+static char store_dir[128];
+static int store_open = 0;
+static pthread_rwlock_t store_lock = PTHREAD_RWLOCK_INITIALIZER;
+static time_t store_full_warned = 0;
+static uint64_t store_dropped = 0;      // Amostras perdidas sem slot livre
+
+// ============ FILTRO DE ROVERS ============
+// FNV-1a de 64 bits; as STORE_FILTER_HASHES posições saem de fatias do hash
+
+static uint64_t store_rover_hash(const char *rover_id) {
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < 32 && rover_id[i]; i++) {
+        h ^= (uint8_t)rover_id[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+static void store_filter_add(uint8_t *filter, uint64_t hash) {
+    for (int k = 0; k < STORE_FILTER_HASHES; k++) {
+        uint32_t bit = (uint32_t)(hash >> (k * 21)) % STORE_FILTER_BITS;
+        filter[bit >> 3] |= (uint8_t)(1u << (bit & 7));
+    }
+}
+
+static int store_filter_test(const uint8_t *filter, uint64_t hash) {
+    for (int k = 0; k < STORE_FILTER_HASHES; k++) {
+        uint32_t bit = (uint32_t)(hash >> (k * 21)) % STORE_FILTER_BITS;
+        if (!((filter[bit >> 3] >> (bit & 7)) & 1u)) return 0;
+    }
+    return 1;
+}
+
+// ============ SEGMENTOS ============
+
+static StoreSegment* store_free_slot(void) {
+    for (int i = 0; i < STORE_MAX_SEGMENTS; i++) {
+        if (!__atomic_load_n(&segments[i].in_use, __ATOMIC_ACQUIRE)) {
+            return &segments[i];
+        }
+    }
+    return NULL;
+}
+
+static int store_map_segment(StoreSegment *seg, int create) {
+    int flags = O_RDWR | (create ? (O_CREAT | O_EXCL) : 0);
+    seg->fd = open(seg->path, flags, 0644);
+    if (seg->fd < 0) {
+        perror("open segmento telemetria");
+        return -1;
+    }
+
+    if (create && ftruncate(seg->fd, (off_t)STORE_SEGMENT_BYTES) < 0) {
+        perror("ftruncate segmento telemetria");
+        close(seg->fd);
+        unlink(seg->path);
+        return -1;
+    }
+
+    // O tamanho depende da versão (cabeçalho da v1 sem filtros): mapear o
+    // ficheiro todo e validar a disposição depois de ler o cabeçalho
+    struct stat st;
+    if (fstat(seg->fd, &st) < 0 || (size_t)st.st_size < STORE_HEADER_SIZE_V1 + STORE_RECORD_BYTES) {
+        print_timestamp();
+        printf("⚠  Segmento inválido ignorado: %s\n", seg->path);
+        close(seg->fd);
+        return -1;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, seg->fd, 0);
+    if (map == MAP_FAILED) {
+        perror("mmap segmento telemetria");
+        close(seg->fd);
+        return -1;
+    }
+
+    seg->map = map;
+    seg->bytes = (size_t)st.st_size;
+    seg->hdr = (StoreSegmentHeader *)map;
+    seg->filters = (StoreRoverFilter *)(seg->map + STORE_HEADER_SIZE_V1);
+    seg->records = (TelemetryRecord *)(seg->map + STORE_HEADER_SIZE);
+    return 0;
+}
+
+// Segmentos v1 (antes dos filtros): registos logo a seguir à primeira página
+static void store_layout_v1(StoreSegment *seg) {
+    seg->filters = NULL;
+    seg->records = (TelemetryRecord *)(seg->map + STORE_HEADER_SIZE_V1);
+}
+
+static void store_unmap_segment(StoreSegment *seg) {
+    if (seg->map) munmap(seg->map, seg->bytes);
+    if (seg->fd >= 0) close(seg->fd);
+    seg->map = NULL;
+    seg->hdr = NULL;
+    seg->records = NULL;
+    seg->fd = -1;
+}
+
+static void store_seal_segment(StoreSegment *seg) {
+    if (!seg || seg->hdr->sealed) return;
+    seg->hdr->sealed = 1;
+    msync(seg->map, seg->bytes, MS_ASYNC);
+}
+
+// Apagar o segmento fechado mais antigo (com o write lock); 0 se não há
+static int store_evict_oldest(void) {
+    StoreSegment *oldest = NULL;
+    for (int i = 0; i < STORE_MAX_SEGMENTS; i++) {
+        StoreSegment *seg = &segments[i];
+        if (!seg->in_use || seg == active_segment) continue;
+        if (!oldest || seg->id < oldest->id) oldest = seg;
+    }
+    if (!oldest) return 0;
+
+    __atomic_store_n(&oldest->in_use, 0, __ATOMIC_RELEASE);
+    unlink(oldest->path);
+    store_unmap_segment(oldest);
+    return 1;
+}
+
+static StoreSegment* store_create_segment(uint32_t now) {
+    StoreSegment *seg = store_free_slot();
+
+    // Limite de espaço: dar lugar ao novo à custa do mais antigo. Se uma
+    // consulta tem o lock, a amostra perde-se (aviso no máximo por intervalo)
+    if (!seg && pthread_rwlock_trywrlock(&store_lock) == 0) {
+        if (store_evict_oldest()) seg = store_free_slot();
+        pthread_rwlock_unlock(&store_lock);
+    }
+    if (!seg) {
+        store_dropped++;
+        if ((time_t)now - store_full_warned >= STORE_MAINTENANCE_INTERVAL) {
+            store_full_warned = (time_t)now;
+            print_timestamp();
+            printf("⚠  Limite de segmentos de telemetria atingido (%llu amostras perdidas)\n",
+                   (unsigned long long)store_dropped);
+        }
+        return NULL;
+    }
+
+    memset(seg, 0, sizeof(*seg));
+    seg->id = next_segment_id++;
+    snprintf(seg->path, sizeof(seg->path), "%s/seg_%010u.tlm", store_dir, seg->id);
+
+    if (store_map_segment(seg, 1) < 0) return NULL;
+
+    StoreSegmentHeader *hdr = seg->hdr;
+    hdr->magic = STORE_MAGIC;
+    hdr->version = STORE_VERSION;
+    hdr->record_size = sizeof(TelemetryRecord);
+    hdr->capacity = STORE_SEGMENT_RECORDS;
+    hdr->count = 0;
+    hdr->sealed = 0;
+    hdr->created_at = now;
+    hdr->min_ts = UINT32_MAX;
+    hdr->max_ts = 0;
+
+    __atomic_store_n(&seg->in_use, 1, __ATOMIC_RELEASE);
+
+    print_timestamp();
+    printf("💽 Novo segmento de telemetria: %s\n", seg->path);
+    return seg;
+}
+
+// Carregar segmento existente a partir do cabeçalho (sem replay)
+static void store_load_segment(uint32_t id, const char *name) {
+    StoreSegment *seg = store_free_slot();
+    if (!seg) return;
+
+    memset(seg, 0, sizeof(*seg));
+    seg->id = id;
+    snprintf(seg->path, sizeof(seg->path), "%s/%.64s", store_dir, name);
+
+    if (store_map_segment(seg, 0) < 0) return;
+
+    StoreSegmentHeader *hdr = seg->hdr;
+    if (hdr->magic == STORE_MAGIC && hdr->version == 1) store_layout_v1(seg);
+    if (hdr->magic != STORE_MAGIC || hdr->version < 1 || hdr->version > STORE_VERSION ||
+        hdr->record_size != sizeof(TelemetryRecord) || hdr->capacity != STORE_SEGMENT_RECORDS ||
+        hdr->count > hdr->capacity ||
+        seg->bytes < (size_t)((uint8_t *)seg->records - seg->map) + STORE_RECORD_BYTES) {
+        print_timestamp();
+        printf("⚠  Cabeçalho inválido, segmento ignorado: %s\n", seg->path);
+        store_unmap_segment(seg);
+        return;
+    }
+
+    if (id >= next_segment_id) next_segment_id = id + 1;
+    __atomic_store_n(&seg->in_use, 1, __ATOMIC_RELEASE);
+}
+
+// ============ ABRIR / FECHAR ============
+
+int telemetry_store_open(const char *dir) {
+    if (store_open) return 0;
+
+    strncpy(store_dir, dir, sizeof(store_dir) - 1);
+    if (mkdir(store_dir, 0755) < 0 && errno != EEXIST) {
+        perror("mkdir armazenamento telemetria");
+        return -1;
+    }
+
+    for (int i = 0; i < STORE_MAX_SEGMENTS; i++) {
+        segments[i].fd = -1;
+        segments[i].in_use = 0;
+    }
+
+    DIR *d = opendir(store_dir);
+    if (!d) {
+        perror("opendir armazenamento telemetria");
+        return -1;
+    }
+
+    int loaded = 0;
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL) {
+        unsigned int id;
+        if (sscanf(entry->d_name, "seg_%10u.tlm", &id) == 1) {
+            store_load_segment(id, entry->d_name);
+            loaded++;
+        }
+    }
+    closedir(d);
+
+    // Continuar a escrever no segmento mais recente se ainda não foi fechado
+    StoreSegment *latest = NULL;
+    for (int i = 0; i < STORE_MAX_SEGMENTS; i++) {
+        if (segments[i].in_use && (!latest || segments[i].id > latest->id)) {
+            latest = &segments[i];
+        }
+    }
+    for (int i = 0; i < STORE_MAX_SEGMENTS; i++) {
+        if (segments[i].in_use && &segments[i] != latest) {
+            store_seal_segment(&segments[i]);
+        }
+    }
+    // (só da versão atual: os v1 ficam só de leitura até à retenção)
+    if (latest && latest->hdr->version == STORE_VERSION && !latest->hdr->sealed &&
+        latest->hdr->count < latest->hdr->capacity) {
+        active_segment = latest;
+    } else {
+        store_seal_segment(latest);
+        active_segment = NULL;
+    }
+
+    store_open = 1;
+
+    print_timestamp();
+    printf("💽 Armazenamento de telemetria aberto: %s (%d segmentos)\n\n", store_dir, loaded);
+    return 0;
+}
+
+void telemetry_store_close(void) {
+    if (!store_open) return;
+
+    pthread_rwlock_wrlock(&store_lock);
+    for (int i = 0; i < STORE_MAX_SEGMENTS; i++) {
+        if (segments[i].in_use) {
+            msync(segments[i].map, segments[i].bytes, MS_SYNC);
+            store_unmap_segment(&segments[i]);
+            segments[i].in_use = 0;
+        }
+    }
+    active_segment = NULL;
+    store_open = 0;
+    pthread_rwlock_unlock(&store_lock);
+}
+
+int telemetry_store_is_open(void) {
+    return store_open;
+}
+
+// ============ ESCRITA ============
+
+void telemetry_store_append(const char *rover_id, const TelemetryMessage *msg) {
+    if (!store_open || !rover_id || !msg) return;
+
+    uint32_t now = (uint32_t)time(NULL);
+
+    // Rollover por tamanho ou por idade do segmento
+    if (active_segment &&
+        (active_segment->hdr->count >= active_segment->hdr->capacity ||
+         now - active_segment->hdr->created_at >= STORE_SEGMENT_MAX_AGE)) {
+        store_seal_segment(active_segment);
+        active_segment = NULL;
+    }
+    if (!active_segment) {
+        active_segment = store_create_segment(now);
+        if (!active_segment) return;
+    }
+
+    StoreSegmentHeader *hdr = active_segment->hdr;
+    uint32_t idx = hdr->count;
+
+    TelemetryRecord *rec = &active_segment->records[idx];
+    memset(rec, 0, sizeof(*rec));
+    rec->timestamp = msg->timestamp;
+    rec->timestamp_ms = msg->timestamp_ms;
+    strncpy(rec->rover_id, rover_id, sizeof(rec->rover_id) - 1);
+    rec->position_x = msg->position_x;
+    rec->position_y = msg->position_y;
+    rec->temperature = msg->temperature;
+    rec->battery = msg->battery;
+    rec->state = msg->state;
+    rec->signal_strength = msg->signal_strength;
+
+    // Índice esparso: intervalo temporal e rovers de cada bloco de registos
+    // (o ficheiro novo vem a zeros: filtros vazios)
+    StoreIndexEntry *ie = &hdr->index[idx / STORE_INDEX_STRIDE];
+    store_filter_add(active_segment->filters[idx / STORE_INDEX_STRIDE], store_rover_hash(rec->rover_id));
+    if (idx % STORE_INDEX_STRIDE == 0) {
+        ie->min_ts = rec->timestamp;
+        ie->max_ts = rec->timestamp;
+    } else {
+        if (rec->timestamp < ie->min_ts) ie->min_ts = rec->timestamp;
+        if (rec->timestamp > ie->max_ts) ie->max_ts = rec->timestamp;
+    }
+    if (rec->timestamp < hdr->min_ts) hdr->min_ts = rec->timestamp;
+    if (rec->timestamp > hdr->max_ts) hdr->max_ts = rec->timestamp;
+
+    // Publicar o registo aos leitores só depois de escrito
+    __atomic_store_n(&hdr->count, idx + 1, __ATOMIC_RELEASE);
+}
+
+// ============ MANUTENÇÃO ============
+
+void telemetry_store_maintain(time_t now) {
+    if (!store_open) return;
+
+    // Rollover por tempo mesmo sem novas amostras
+    if (active_segment && (uint32_t)now - active_segment->hdr->created_at >= STORE_SEGMENT_MAX_AGE) {
+        store_seal_segment(active_segment);
+        active_segment = NULL;
+    }
+
+    // Retenção: nunca bloquear o ciclo principal à espera de consultas
+    if (pthread_rwlock_trywrlock(&store_lock) != 0) return;
+
+    int removed = 0;
+    for (int i = 0; i < STORE_MAX_SEGMENTS; i++) {
+        StoreSegment *seg = &segments[i];
+        if (!seg->in_use || seg == active_segment) continue;
+        if (seg->hdr->count > 0 && (time_t)seg->hdr->max_ts + STORE_RETENTION_SECONDS >= now) continue;
+        if (seg->hdr->count == 0 && (time_t)seg->hdr->created_at + STORE_RETENTION_SECONDS >= now) continue;
+
+        __atomic_store_n(&seg->in_use, 0, __ATOMIC_RELEASE);
+        unlink(seg->path);
+        store_unmap_segment(seg);
+        removed++;
+    }
+
+    // Espaço: manter STORE_SEGMENT_HEADROOM slots livres para os rollovers
+    int used = 0;
+    for (int i = 0; i < STORE_MAX_SEGMENTS; i++) used += segments[i].in_use;
+    while (used > STORE_MAX_SEGMENTS - STORE_SEGMENT_HEADROOM && store_evict_oldest()) {
+        used--;
+        removed++;
+    }
+    pthread_rwlock_unlock(&store_lock);
+
+    if (removed > 0) {
+        print_timestamp();
+        printf("🗑  Retenção de telemetria: %d segmentos apagados\n", removed);
+    }
+}
+
+// ============ CONSULTA ============
+
+size_t telemetry_store_query(const char *rover_id, uint32_t from, uint32_t to,
+                             TelemetryStoreVisitor visit, void *ctx) {
+    if (!store_open || !rover_id || !visit || from > to) return 0;
+
+    pthread_rwlock_rdlock(&store_lock);
+
+    // Ordenar segmentos relevantes por id (ordem de escrita)
+    StoreSegment *selected[STORE_MAX_SEGMENTS];
+    int num_selected = 0;
+    for (int i = 0; i < STORE_MAX_SEGMENTS; i++) {
+        StoreSegment *seg = &segments[i];
+        if (!__atomic_load_n(&seg->in_use, __ATOMIC_ACQUIRE)) continue;
+        if (__atomic_load_n(&seg->hdr->count, __ATOMIC_ACQUIRE) == 0) continue;
+        if (seg->hdr->max_ts < from || seg->hdr->min_ts > to) continue;
+
+        int j = num_selected++;
+        while (j > 0 && selected[j - 1]->id > seg->id) {
+            selected[j] = selected[j - 1];
+            j--;
+        }
+        selected[j] = seg;
+    }
+
+    size_t visited = 0;
+    int stop = 0;
+    uint64_t hash = store_rover_hash(rover_id);
+
+    for (int s = 0; s < num_selected && !stop; s++) {
+        StoreSegment *seg = selected[s];
+        uint32_t count = __atomic_load_n(&seg->hdr->count, __ATOMIC_ACQUIRE);
+        uint32_t blocks = (count + STORE_INDEX_STRIDE - 1) / STORE_INDEX_STRIDE;
+
+        for (uint32_t b = 0; b < blocks && !stop; b++) {
+            const StoreIndexEntry *ie = &seg->hdr->index[b];
+            if (ie->max_ts < from || ie->min_ts > to) continue;
+            if (seg->filters && !store_filter_test(seg->filters[b], hash)) continue;
+
+            uint32_t first = b * STORE_INDEX_STRIDE;
+            uint32_t last = first + STORE_INDEX_STRIDE;
+            if (last > count) last = count;
+
+            for (uint32_t r = first; r < last; r++) {
+                const TelemetryRecord *rec = &seg->records[r];
+                if (rec->timestamp < from || rec->timestamp > to) continue;
+                if (strncmp(rec->rover_id, rover_id, sizeof(rec->rover_id)) != 0) continue;
+
+                visited++;
+                if (!visit(rec, ctx)) {
+                    stop = 1;
+                    break;
+                }
+            }
+        }
+    }
+
+    pthread_rwlock_unlock(&store_lock);
+    return visited;
+}
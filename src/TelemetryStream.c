@@ -1,13 +1,258 @@
 // ============ TelemetryStream.c ============
 // Implementação do protocolo de telemetria via TCP
 #include "TelemetryStream.h"
+#include "TelemetryRollup.h"
+#include "SpatialIndex.h"
+#include "RoverRegistry.h"
 #include "MissionLink.h"
+#include "MissionLinkWire.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <sys/select.h>
+#include <sys/time.h>
+#include <stddef.h>
+
+// ============ CODEC V2 (DELTAS) ============
+
+static size_t put_varint(uint8_t *p, uint32_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+// Devolve os bytes lidos (0 se o varint estiver truncado ou for inválido)
+static size_t get_varint(const uint8_t *p, const uint8_t *end, uint32_t *v) {
+    uint32_t result = 0;
+    for (size_t n = 0; n < 5 && p + n < end; n++) {
+        result |= (uint32_t)(p[n] & 0x7F) << (7 * n);
+        if (!(p[n] & 0x80)) {
+            *v = result;
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+// Diferenças em aritmética modular de 32 bits, mapeadas para inteiros sem sinal
+static uint32_t zigzag_delta(uint32_t cur, uint32_t prev) {
+    int32_t d = (int32_t)(cur - prev);
+    return ((uint32_t)d << 1) ^ (uint32_t)(d >> 31);
+}
+
+static uint32_t unzigzag_apply(uint32_t prev, uint32_t z) {
+    uint32_t d = (z >> 1) ^ (0u - (z & 1));
+    return prev + d;
+}
+
+// Timestamps v3: milissegundos desde a época (não cabem em 32 bits)
+static size_t put_varint64(uint8_t *p, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+static size_t get_varint64(const uint8_t *p, const uint8_t *end, uint64_t *v) {
+    uint64_t result = 0;
+    for (size_t n = 0; n < 10 && p + n < end; n++) {
+        result |= (uint64_t)(p[n] & 0x7F) << (7 * n);
+        if (!(p[n] & 0x80)) {
+            *v = result;
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+static uint64_t state_time_ms(const TelemetryV2State *st) {
+    return (uint64_t)st->timestamp * 1000 + st->timestamp_ms;
+}
+
+// Versão efetiva de um pedido/resposta de negociação
+static int clamp_version(int version) {
+    if (version > TELEMETRY_VERSION_MAX) return TELEMETRY_VERSION_MAX;
+    return (version >= 2) ? version : 1;
+}
+
+static int32_t position_to_fixed(float v) {
+    float scaled = v * TELEMETRY_POSITION_SCALE;
+    if (scaled > 2e9f) scaled = 2e9f;
+    if (scaled < -2e9f) scaled = -2e9f;
+    return (int32_t)(scaled + (scaled >= 0 ? 0.5f : -0.5f));
+}
+
+// Codificar uma amostra relativamente ao estado anterior (que é atualizado).
+// Na v3 o delta do timestamp é em milissegundos; na v2 os milissegundos perdem-se.
+static size_t encode_sample_v2(TelemetryV2State *st, int version, const TelemetryMessage *m,
+                               uint8_t *out) {
+    int32_t x = position_to_fixed(m->position_x);
+    int32_t y = position_to_fixed(m->position_y);
+    uint16_t ms = (version >= 3 && m->timestamp_ms < 1000) ? m->timestamp_ms : 0;
+    uint8_t bitmap = 0;
+    size_t n = 1;
+    
+    if (version >= 3) {
+        uint64_t cur = (uint64_t)m->timestamp * 1000 + ms;
+        uint64_t prev = state_time_ms(st);
+        if (cur != prev) {
+            int64_t d = (int64_t)(cur - prev);
+            bitmap |= TV2_TIMESTAMP;
+            n += put_varint64(out + n, ((uint64_t)d << 1) ^ (uint64_t)(d >> 63));
+        }
+    } else if (m->timestamp != st->timestamp) {
+        bitmap |= TV2_TIMESTAMP;
+        n += put_varint(out + n, zigzag_delta(m->timestamp, st->timestamp));
+    }
+    if (x != st->position_x) {
+        bitmap |= TV2_POSITION_X;
+        n += put_varint(out + n, zigzag_delta((uint32_t)x, (uint32_t)st->position_x));
+    }
+    if (y != st->position_y) {
+        bitmap |= TV2_POSITION_Y;
+        n += put_varint(out + n, zigzag_delta((uint32_t)y, (uint32_t)st->position_y));
+    }
+    if (m->battery != st->battery) {
+        bitmap |= TV2_BATTERY;
+        out[n++] = m->battery;
+    }
+    if (m->state != st->state) {
+        bitmap |= TV2_STATE;
+        out[n++] = m->state;
+    }
+    if (memcmp(&m->temperature, &st->temperature, sizeof(float)) != 0) {
+        bitmap |= TV2_TEMPERATURE;
+        memcpy(out + n, &m->temperature, sizeof(float));
+        n += sizeof(float);
+    }
+    if (m->signal_strength != st->signal_strength) {
+        bitmap |= TV2_SIGNAL;
+        out[n++] = m->signal_strength;
+    }
+    if (m->nonce != st->nonce) {
+        bitmap |= TV2_NONCE;
+        n += put_varint(out + n, m->nonce);
+    }
+    out[0] = bitmap;
+    
+    st->timestamp = m->timestamp;
+    st->timestamp_ms = ms;
+    st->position_x = x;
+    st->position_y = y;
+    st->battery = m->battery;
+    st->state = m->state;
+    st->temperature = m->temperature;
+    st->signal_strength = m->signal_strength;
+    st->nonce = m->nonce;
+    return n;
+}
+
+// Reconstruir uma amostra completa. Devolve os bytes consumidos (0 = inválida)
+static size_t decode_sample_v2(TelemetryV2State *st, int version, const uint8_t *p,
+                               const uint8_t *end, TelemetryMessage *m) {
+    if (p >= end) return 0;
+    uint8_t bitmap = p[0];
+    const uint8_t *q = p + 1;
+    uint32_t v;
+    size_t r;
+    
+    if ((bitmap & TV2_TIMESTAMP) && version >= 3) {
+        uint64_t z;
+        if (!(r = get_varint64(q, end, &z))) return 0;
+        uint64_t t = state_time_ms(st) + ((z >> 1) ^ (0ull - (z & 1)));
+        st->timestamp = (uint32_t)(t / 1000);
+        st->timestamp_ms = (uint16_t)(t % 1000);
+        q += r;
+    } else if (bitmap & TV2_TIMESTAMP) {
+        if (!(r = get_varint(q, end, &v))) return 0;
+        st->timestamp = unzigzag_apply(st->timestamp, v);
+        q += r;
+    }
+    if (bitmap & TV2_POSITION_X) {
+        if (!(r = get_varint(q, end, &v))) return 0;
+        st->position_x = (int32_t)unzigzag_apply((uint32_t)st->position_x, v);
+        q += r;
+    }
+    if (bitmap & TV2_POSITION_Y) {
+        if (!(r = get_varint(q, end, &v))) return 0;
+        st->position_y = (int32_t)unzigzag_apply((uint32_t)st->position_y, v);
+        q += r;
+    }
+    if (bitmap & TV2_BATTERY) {
+        if (q >= end) return 0;
+        st->battery = *q++;
+    }
+    if (bitmap & TV2_STATE) {
+        if (q >= end) return 0;
+        st->state = *q++;
+    }
+    if (bitmap & TV2_TEMPERATURE) {
+        if (end - q < (ptrdiff_t)sizeof(float)) return 0;
+        memcpy(&st->temperature, q, sizeof(float));
+        q += sizeof(float);
+    }
+    if (bitmap & TV2_SIGNAL) {
+        if (q >= end) return 0;
+        st->signal_strength = *q++;
+    }
+    if (bitmap & TV2_NONCE) {
+        if (!(r = get_varint(q, end, &v))) return 0;
+        st->nonce = v;
+        q += r;
+    }
+    
+    m->timestamp = st->timestamp;
+    m->timestamp_ms = st->timestamp_ms;
+    m->position_x = (float)st->position_x / TELEMETRY_POSITION_SCALE;
+    m->position_y = (float)st->position_y / TELEMETRY_POSITION_SCALE;
+    m->battery = st->battery;
+    m->state = st->state;
+    m->temperature = st->temperature;
+    m->signal_strength = st->signal_strength;
+    m->nonce = st->nonce;
+    return (size_t)(q - p);
+}
+
+// ============ MENSAGENS V1 ============
+// O formato v1 não tem milissegundos: chegam como 0 e perdem-se no envio
+
+static void message_from_v1(TelemetryMessage *m, const TelemetryMessageV1 *w) {
+    memset(m, 0, sizeof(*m));
+    m->timestamp = w->timestamp;
+    memcpy(m->rover_id, w->rover_id, sizeof(m->rover_id));
+    m->position_x = w->position_x;
+    m->position_y = w->position_y;
+    m->battery = w->battery;
+    m->state = w->state;
+    m->temperature = w->temperature;
+    m->signal_strength = w->signal_strength;
+    m->nonce = w->nonce;
+}
+
+static void message_to_v1(TelemetryMessageV1 *w, const TelemetryMessage *m) {
+    w->timestamp = m->timestamp;
+    memcpy(w->rover_id, m->rover_id, sizeof(w->rover_id));
+    w->position_x = m->position_x;
+    w->position_y = m->position_y;
+    w->battery = m->battery;
+    w->state = m->state;
+    w->temperature = m->temperature;
+    w->signal_strength = m->signal_strength;
+    w->nonce = m->nonce;
+}
 
 // ============ SERVIDOR (NAVE-MÃE) ============
 
@@ -48,14 +293,194 @@ int create_telemetry_server(int port) {
     return fd;
 }
 
-// Aceitar nova conexão TCP
-void accept_telemetry_connection(int server_fd, TelemetrySession *sessions, int *count) {
-    if (*count >= MAX_TELEMETRY_CONNECTIONS) {
+// ============ POOL DE SESSÕES ============
+// Ligações (lista livre, tabela de IDs, lista LRU) usam índices base 1,
+// para que um pool zerado seja válido.
+
+TelemetrySession* telemetry_pool_at(const TelemetryPool *pool, size_t i) {
+    return &pool->slabs[i / TELEMETRY_SLAB_SESSIONS][i % TELEMETRY_SLAB_SESSIONS];
+}
+
+static TelemetrySession* pool_slot(const TelemetryPool *pool, int slot) {
+    return telemetry_pool_at(pool, (size_t)(slot - 1));
+}
+
+static unsigned session_id_hash(const char *rover_id) {
+    // FNV-1a
+    uint32_t h = 2166136261u;
+    for (const char *p = rover_id; *p; p++) {
+        h ^= (uint8_t)*p;
+        h *= 16777619u;
+    }
+    return h & (TELEMETRY_POOL_ID_BUCKETS - 1);
+}
+
+void telemetry_pool_init(TelemetryPool *pool) {
+    memset(pool, 0, sizeof(*pool));
+}
+
+static void lru_unlink(TelemetryPool *pool, TelemetrySession *s) {
+    if (s->lru_prev) pool_slot(pool, s->lru_prev)->lru_next = s->lru_next;
+    else pool->lru_head = s->lru_next;
+    if (s->lru_next) pool_slot(pool, s->lru_next)->lru_prev = s->lru_prev;
+    else pool->lru_tail = s->lru_prev;
+    s->lru_prev = s->lru_next = 0;
+}
+
+static void lru_append(TelemetryPool *pool, TelemetrySession *s) {
+    s->lru_prev = pool->lru_tail;
+    s->lru_next = 0;
+    if (pool->lru_tail) pool_slot(pool, pool->lru_tail)->lru_next = s->slot;
+    else pool->lru_head = s->slot;
+    pool->lru_tail = s->slot;
+}
+
+// Registar atividade: a sessão passa para o fim da lista LRU
+static void pool_touch(TelemetryPool *pool, TelemetrySession *s) {
+    s->last_activity = time(NULL);
+    if (pool->lru_tail != s->slot) {
+        lru_unlink(pool, s);
+        lru_append(pool, s);
+    }
+}
+
+static TelemetrySession* pool_alloc(TelemetryPool *pool) {
+    if (pool->live >= MAX_TELEMETRY_CONNECTIONS) return NULL;
+
+    int slot;
+    if (pool->free_head) {
+        slot = pool->free_head;
+        pool->free_head = pool_slot(pool, slot)->pool_next;
+    } else {
+        if (pool->used == pool->num_slabs * TELEMETRY_SLAB_SESSIONS) {
+            // Novo slab; os anteriores não se movem
+            TelemetrySession **slabs = realloc(pool->slabs,
+                                               (pool->num_slabs + 1) * sizeof(*slabs));
+            if (!slabs) return NULL;
+            pool->slabs = slabs;
+            TelemetrySession *slab = calloc(TELEMETRY_SLAB_SESSIONS, sizeof(TelemetrySession));
+            if (!slab) return NULL;
+            pool->slabs[pool->num_slabs++] = slab;
+        }
+        slot = (int)++pool->used;
+    }
+
+    TelemetrySession *s = pool_slot(pool, slot);
+    memset(s, 0, sizeof(*s));
+    s->slot = slot;
+    s->active = 1;
+    s->last_update = time(NULL);
+    s->last_activity = s->last_update;
+    lru_append(pool, s);
+    pool->live++;
+    return s;
+}
+
+// Devolver o slot ao pool (não mexe no índice espacial)
+static void pool_release(TelemetryPool *pool, TelemetrySession *s) {
+    if (!s->active) return;
+
+    if (s->sockfd > 0) close(s->sockfd);
+    free(s->rx_buf);
+    s->sockfd = 0;
+    s->active = 0;
+    s->rx_buf = NULL;
+    s->rx_len = 0;
+
+    if (s->id_linked) {
+        int *link = &pool->id_heads[session_id_hash(s->rover_id)];
+        while (*link != s->slot) link = &pool_slot(pool, *link)->id_next;
+        *link = s->id_next;
+        s->id_linked = 0;
+        rover_registry_detach_telemetry(s);
+    }
+    lru_unlink(pool, s);
+
+    s->pool_next = pool->free_head;
+    pool->free_head = s->slot;
+    pool->live--;
+}
+
+TelemetrySession* telemetry_pool_find(const TelemetryPool *pool, const char *rover_id) {
+    if (!rover_id || rover_id[0] == '\0') return NULL;
+    for (int e = pool->id_heads[session_id_hash(rover_id)]; e; e = pool_slot(pool, e)->id_next) {
+        TelemetrySession *s = pool_slot(pool, e);
+        if (strcmp(s->rover_id, rover_id) == 0) return s;
+    }
+    return NULL;
+}
+
+// Associar o rover_id à sessão. Se o rover já tinha outra sessão (reconexão,
+// ou sessão só-UDP), o estado conhecido passa para esta e a antiga é fechada.
+static void bind_session(TelemetryPool *pool, TelemetrySession *s, const char *rover_id) {
+    if (s->id_linked || rover_id[0] == '\0') return;
+
+    TelemetrySession *old = telemetry_pool_find(pool, rover_id);
+    if (old && old != s) {
+        s->last_position_x = old->last_position_x;
+        s->last_position_y = old->last_position_y;
+        s->last_battery = old->last_battery;
+        s->last_state = old->last_state;
+        s->last_temperature = old->last_temperature;
+        s->last_signal_strength = old->last_signal_strength;
+        s->udp_active = old->udp_active;
+        s->udp_max_seq = old->udp_max_seq;
+        s->udp_received = old->udp_received;
+        s->udp_lost = old->udp_lost;
+        s->udp_stale = old->udp_stale;
+        s->udp_last_update = old->udp_last_update;
+
         print_timestamp();
-        printf("⚠  Limite de conexões telemetria atingido\n");
-        return;
+        printf("♻  Telemetria %s: sessão anterior (slot %d) substituída pelo slot %d\n\n",
+               rover_id, old->slot, s->slot);
+        pool_release(pool, old);
     }
+
+    strncpy(s->rover_id, rover_id, sizeof(s->rover_id) - 1);
+    unsigned b = session_id_hash(s->rover_id);
+    s->id_next = pool->id_heads[b];
+    pool->id_heads[b] = s->slot;
+    s->id_linked = 1;
     
+    // A entidade do rover passa a apontar diretamente para esta sessão
+    rover_registry_attach_telemetry(s);
+}
+
+// Fechar sessão de telemetria
+static void close_telemetry_session(TelemetryPool *pool, TelemetrySession *session) {
+    spatial_index_remove(session->rover_id);
+    pool_release(pool, session);
+}
+
+size_t telemetry_pool_reap(TelemetryPool *pool, time_t now) {
+    size_t reaped = 0;
+
+    // A lista LRU está ordenada por atividade: parar na primeira sessão viva
+    while (pool->lru_head) {
+        TelemetrySession *s = pool_slot(pool, pool->lru_head);
+        if (now - s->last_activity < TELEMETRY_IDLE_TIMEOUT) break;
+
+        print_timestamp();
+        printf("⏱  Sessão de telemetria %s inativa há %lds - a fechar\n\n",
+               s->rover_id[0] ? s->rover_id : "(sem ID)", (long)(now - s->last_activity));
+        close_telemetry_session(pool, s);
+        reaped++;
+    }
+    return reaped;
+}
+
+void telemetry_pool_destroy(TelemetryPool *pool) {
+    for (size_t i = 0; i < pool->used; i++) {
+        TelemetrySession *s = telemetry_pool_at(pool, i);
+        if (s->active) close_telemetry_session(pool, s);
+    }
+    for (size_t i = 0; i < pool->num_slabs; i++) free(pool->slabs[i]);
+    free(pool->slabs);
+    memset(pool, 0, sizeof(*pool));
+}
+
+// Aceitar nova conexão TCP
+void accept_telemetry_connection(int server_fd, TelemetryPool *pool) {
     struct sockaddr_in client_addr;
     socklen_t addr_len = sizeof(client_addr);
     
@@ -64,64 +489,356 @@ void accept_telemetry_connection(int server_fd, TelemetrySession *sessions, int
         perror("accept telemetria");
         return;
     }
+    if (client_fd >= FD_SETSIZE) {
+        // O ciclo principal usa select(): descritores acima do limite não cabem
+        print_timestamp();
+        printf("⚠  Descritor de telemetria acima de FD_SETSIZE - conexão recusada\n");
+        close(client_fd);
+        return;
+    }
     
-    // Registar nova sessão
-    TelemetrySession *session = &sessions[*count];
-    memset(session, 0, sizeof(*session));
+    // Registar nova sessão (o rover_id só é conhecido na negociação/1.ª amostra)
+    TelemetrySession *session = pool_alloc(pool);
+    if (!session) {
+        print_timestamp();
+        printf("⚠  Limite de conexões telemetria atingido\n");
+        close(client_fd);
+        return;
+    }
     session->sockfd = client_fd;
     session->addr = client_addr;
-    session->active = 1;
-    session->last_update = time(NULL);
-    (*count)++;
     
     print_timestamp();
-    printf("✅ Nova conexão telemetria aceita (%d/%d)\n", *count, MAX_TELEMETRY_CONNECTIONS);
+    printf("✅ Nova conexão telemetria aceita (%zu/%d, slot %d)\n",
+           pool->live, MAX_TELEMETRY_CONNECTIONS, session->slot);
     printf("   IP: %s | Porto: %d\n\n",
            inet_ntoa(client_addr.sin_addr),
            ntohs(client_addr.sin_port));
 }
 
+// Amostras processadas (TCP + UDP), lido pelo controlo de taxa
+static uint64_t samples_ingested = 0;
+
+uint64_t telemetry_samples_ingested(void) {
+    return samples_ingested;
+}
+
+// Atualizar o estado ao vivo da sessão (última posição, bateria, ...)
+static void update_session_live(TelemetrySession *session, const TelemetryMessage *msg) {
+    session->last_position_x = msg->position_x;
+    session->last_position_y = msg->position_y;
+    session->last_battery = msg->battery;
+    if (session->entity) rover_registry_set_battery(session->entity, msg->battery);
+    session->last_state = msg->state;
+    session->last_temperature = msg->temperature;
+    session->last_signal_strength = msg->signal_strength;
+    session->last_update = time(NULL);
+    
+    // Atualizar índice espacial (bbox / vizinhos mais próximos)
+    spatial_index_update(session->rover_id, msg->position_x, msg->position_y);
+}
+
+// Processar uma amostra fiável (TCP, isolada ou dentro de um lote)
+static void process_telemetry_message(TelemetryPool *pool, TelemetrySession *session,
+                                      TelemetryMessage *msg) {
+    samples_ingested++;
+    
+    // Rovers v1 identificam-se na primeira amostra
+    if (!session->id_linked) {
+        msg->rover_id[sizeof(msg->rover_id) - 1] = '\0';
+        bind_session(pool, session, msg->rover_id);
+    }
+    
+    // Telemetria ligada antes do handshake MissionLink: tentar outra vez
+    if (!session->entity && session->id_linked) {
+        rover_registry_attach_telemetry(session);
+    }
+    
+    // Com o canal UDP ativo, as amostras TCP chegam depois das UDP e não
+    // devem recuar o estado ao vivo; continuam a alimentar o histórico.
+    int udp_live = session->udp_active &&
+                   (time(NULL) - session->udp_last_update) < TELEMETRY_UDP_LIVE_WINDOW;
+    if (!udp_live) {
+        update_session_live(session, msg);
+    }
+    
+    // Guardar no histórico (série temporal por rover)
+    store_telemetry(session, msg);
+    
+    // Atualizar agregados (10 s, 1 min, 1 h)
+    telemetry_rollup_update(session->rover_id, msg);
+    
+    // Tendências de saúde (só o canal fiável: amostras ordenadas, sem duplicados)
+    if (session->entity) {
+        rover_health_update(&session->entity->health, session->rover_id, msg);
+    }
+}
+
+// Imprimir a última amostra de um frame
+static void print_telemetry_message(const TelemetryMessage *msg, size_t batch) {
+    const char *state_str[] = {"IDLE", "IN_MISSION", "RETURNING", "ERROR", "CHARGING"};
+    const char *state_name = (msg->state < 5) ? state_str[msg->state] : "UNKNOWN";
+    
+    print_timestamp();
+    if (batch > 0) {
+        printf("[TELEMETRY] %s (lote de %zu amostras)\n", msg->rover_id, batch);
+    } else {
+        printf("[TELEMETRY] %s\n", msg->rover_id);
+    }
+    printf("   Posição: (%.2f, %.2f)\n", msg->position_x, msg->position_y);
+    printf("   Bateria: %u%% | Temp: %.1f°C | Sinal: %u%%\n",
+           msg->battery, msg->temperature, msg->signal_strength);
+    printf("   Estado: %s | Nonce: %u\n\n", state_name, msg->nonce);
+}
+
 // Receber dados de telemetria
-void receive_telemetry_data(TelemetrySession *session) {
-    TelemetryMessage msg;
-    memset(&msg, 0, sizeof(msg));
+// O stream TCP pode trazer frames partidos ou vários frames por leitura:
+// os bytes acumulam-se em rx_buf e só frames completos são processados.
+void receive_telemetry_data(TelemetryPool *pool, TelemetrySession *session) {
+    if (!session->rx_buf) {
+        session->rx_buf = malloc(TELEMETRY_RX_BUFFER_SIZE);
+        session->rx_len = 0;
+        if (!session->rx_buf) {
+            print_timestamp();
+            printf("❌ Sem memória para sessão de telemetria\n");
+            close_telemetry_session(pool, session);
+            return;
+        }
+    }
     
-    ssize_t n = recv(session->sockfd, (char*)&msg, sizeof(TelemetryMessage), 0);
+    ssize_t n = recv(session->sockfd, (char*)session->rx_buf + session->rx_len,
+                     TELEMETRY_RX_BUFFER_SIZE - session->rx_len, 0);
     
     if (n <= 0) {
         // Conexão fechada ou erro
         print_timestamp();
         printf("❌ Conexão telemetria perdida: %s\n", session->rover_id);
-        close(session->sockfd);
-        session->sockfd = 0;
-        session->active = 0;
+        close_telemetry_session(pool, session);
         return;
     }
+    session->rx_len += (size_t)n;
+    pool_touch(pool, session);
     
-    // Armazenar dados
-    strncpy(session->rover_id, msg.rover_id, sizeof(session->rover_id) - 1);
-    session->last_position_x = msg.position_x;
-    session->last_position_y = msg.position_y;
-    session->last_battery = msg.battery;
-    session->last_state = msg.state;
-    session->last_temperature = msg.temperature;
-    session->last_signal_strength = msg.signal_strength;
-    session->last_update = time(NULL);
+    size_t off = 0;
+    while (session->active && session->rx_len > off) {
+        uint8_t *frame = session->rx_buf + off;
+        size_t avail = session->rx_len - off;
+        
+        if (session->version >= 2) {
+            // Stream v2/v3: frames com amostras codificadas por deltas
+            TelemetryV2Header hdr;
+            if (avail < sizeof(hdr)) break;
+            memcpy(&hdr, frame, sizeof(hdr));
+            
+            if (hdr.count == 0 || hdr.count > TELEMETRY_BATCH_MAX_SAMPLES ||
+                hdr.length > (size_t)hdr.count * TELEMETRY_V2_MAX_SAMPLE) {
+                print_timestamp();
+                printf("❌ Frame v2 inválido (%u amostras, %u bytes): %s\n",
+                       hdr.count, hdr.length, session->rover_id);
+                close_telemetry_session(pool, session);
+                return;
+            }
+            if (avail < sizeof(hdr) + hdr.length) break;
+            
+            const uint8_t *p = frame + sizeof(hdr);
+            const uint8_t *end = p + hdr.length;
+            TelemetryMessage msg;
+            memset(&msg, 0, sizeof(msg));
+            snprintf(msg.rover_id, sizeof(msg.rover_id), "%s", session->rover_id);
+            
+            for (uint8_t i = 0; i < hdr.count; i++) {
+                size_t used = decode_sample_v2(&session->v2, session->version, p, end, &msg);
+                if (used == 0) {
+                    print_timestamp();
+                    printf("❌ Amostra v2 corrompida: %s\n", session->rover_id);
+                    close_telemetry_session(pool, session);
+                    return;
+                }
+                p += used;
+                process_telemetry_message(pool, session, &msg);
+            }
+            print_telemetry_message(&msg, hdr.count);
+            off += sizeof(hdr) + hdr.length;
+            continue;
+        }
+        
+        if (avail < sizeof(uint32_t)) break;
+        uint32_t magic;
+        memcpy(&magic, frame, sizeof(magic));
+        
+        if (magic == TELEMETRY_HELLO_MAGIC) {
+            // Negociação: o rover indica o ID e a versão mais alta que suporta
+            TelemetryHello hello;
+            if (avail < sizeof(hello)) break;
+            memcpy(&hello, frame, sizeof(hello));
+            hello.rover_id[sizeof(hello.rover_id) - 1] = '\0';
+            
+            session->version = (uint8_t)clamp_version(hello.version);
+            bind_session(pool, session, hello.rover_id);
+            memset(&session->v2, 0, sizeof(session->v2));
+            
+            TelemetryHelloAck ack;
+            ack.magic = TELEMETRY_HELLO_MAGIC;
+            ack.version = session->version;
+            send(session->sockfd, &ack, sizeof(ack), MSG_NOSIGNAL);
+            
+            print_timestamp();
+            printf("🤝 Telemetria %s negociada: versão %u\n\n", session->rover_id, session->version);
+            off += sizeof(hello);
+        } else if (magic == TELEMETRY_BATCH_MAGIC) {
+            TelemetryBatchHeader hdr;
+            if (avail < sizeof(hdr)) break;
+            memcpy(&hdr, frame, sizeof(hdr));
+            
+            if (hdr.count == 0 || hdr.count > TELEMETRY_BATCH_MAX_SAMPLES) {
+                print_timestamp();
+                printf("❌ Lote de telemetria inválido (%u amostras): %s\n",
+                       hdr.count, session->rover_id);
+                close_telemetry_session(pool, session);
+                return;
+            }
+            
+            size_t frame_len = sizeof(hdr) + (size_t)hdr.count * sizeof(TelemetryMessageV1);
+            if (avail < frame_len) break;
+            
+            TelemetryMessageV1 wire;
+            TelemetryMessage msg;
+            for (uint16_t i = 0; i < hdr.count; i++) {
+                memcpy(&wire, frame + sizeof(hdr) + i * sizeof(wire), sizeof(wire));
+                message_from_v1(&msg, &wire);
+                process_telemetry_message(pool, session, &msg);
+            }
+            print_telemetry_message(&msg, hdr.count);
+            off += frame_len;
+        } else {
+            // Mensagem isolada (rovers sem batcher)
+            if (avail < sizeof(TelemetryMessageV1)) break;
+            
+            TelemetryMessageV1 wire;
+            TelemetryMessage msg;
+            memcpy(&wire, frame, sizeof(wire));
+            message_from_v1(&msg, &wire);
+            process_telemetry_message(pool, session, &msg);
+            print_telemetry_message(&msg, 0);
+            off += sizeof(wire);
+        }
+    }
     
-    // Imprimir para debug
-    const char *state_str[] = {"IDLE", "IN_MISSION", "RETURNING", "ERROR", "CHARGING"};
-    const char *state_name = (msg.state < 5) ? state_str[msg.state] : "UNKNOWN";
+    // Manter apenas o frame incompleto no início do buffer
+    if (off > 0) {
+        memmove(session->rx_buf, session->rx_buf + off, session->rx_len - off);
+        session->rx_len -= off;
+    }
+}
+
+// ============ CANAL UDP (SERVIDOR) ============
+
+int create_telemetry_udp_server(int port) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        perror("socket telemetria UDP");
+        return -1;
+    }
+    
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(port);
+    
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("bind telemetria UDP");
+        close(fd);
+        return -1;
+    }
     
     print_timestamp();
-    printf("[TELEMETRY] %s\n", msg.rover_id);
-    printf("   Posição: (%.2f, %.2f)\n", msg.position_x, msg.position_y);
-    printf("   Bateria: %u%% | Temp: %.1f°C | Sinal: %u%%\n",
-           msg.battery, msg.temperature, msg.signal_strength);
-    printf("   Estado: %s | Nonce: %u\n\n", state_name, msg.nonce);
+    printf("📡 Canal UDP de telemetria ligado na porta %d\n\n", port);
+    return fd;
+}
+
+// Sessão do rover (prefere a que tem conexão TCP); cria uma só-UDP se preciso
+static TelemetrySession* find_udp_session(TelemetryPool *pool, const char *rover_id) {
+    TelemetrySession *session = telemetry_pool_find(pool, rover_id);
+    if (session) return session;
+    
+    session = pool_alloc(pool);
+    if (!session) return NULL;
+    bind_session(pool, session, rover_id);
+    
+    print_timestamp();
+    printf("✅ Nova sessão de telemetria só-UDP: %s\n\n", rover_id);
+    return session;
+}
+
+// Validar cabeçalho (magic, versão, comprimento, CRC) e descodificar o corpo.
+// Devolve 0 se o datagrama for aceite, -1 caso contrário
+static int datagram_decode(const uint8_t *buf, size_t len, uint32_t *seq, TelemetryMessage *msg) {
+    if (len < TELEMETRY_DATAGRAM_SIZE) return -1;
+    if (ml_get_le32(buf) != TELEMETRY_DATAGRAM_MAGIC || buf[4] == 0) return -1;
+    
+    uint16_t length = ml_get_le16(buf + 6);
+    if (length < TELEMETRY_DATAGRAM_SIZE || length > len) return -1;
+    
+    uint32_t crc = crc32c(0, buf, 8);
+    crc = crc32c(crc, buf + 12, length - 12);
+    if (crc != ml_get_le32(buf + 8)) return -1;
+    
+    memset(msg, 0, sizeof(*msg));
+    *seq = ml_get_le32(buf + TDG_OFF_SEQ);
+    msg->timestamp = ml_get_le32(buf + TDG_OFF_TIMESTAMP);
+    msg->timestamp_ms = ml_get_le16(buf + TDG_OFF_TIMESTAMP_MS);
+    if (msg->timestamp_ms >= 1000) msg->timestamp_ms = 0;
+    memcpy(msg->rover_id, buf + TDG_OFF_ROVER_ID, sizeof(msg->rover_id) - 1);
+    msg->position_x = ml_get_lef32(buf + TDG_OFF_POSITION_X);
+    msg->position_y = ml_get_lef32(buf + TDG_OFF_POSITION_Y);
+    msg->battery = buf[TDG_OFF_BATTERY];
+    msg->state = buf[TDG_OFF_STATE];
+    msg->temperature = ml_get_lef32(buf + TDG_OFF_TEMPERATURE);
+    msg->signal_strength = buf[TDG_OFF_SIGNAL];
+    msg->nonce = ml_get_le32(buf + TDG_OFF_NONCE);
+    return 0;
+}
+
+void receive_telemetry_datagram(int fd, TelemetryPool *pool) {
+    uint8_t buf[512];
+    ssize_t n = recvfrom(fd, buf, sizeof(buf), 0, NULL, NULL);
+    if (n <= 0) return;
+    
+    uint32_t seq;
+    TelemetryMessage msg;
+    if (datagram_decode(buf, (size_t)n, &seq, &msg) < 0) return;
+    if (msg.rover_id[0] == '\0') return;
+    
+    TelemetrySession *session = find_udp_session(pool, msg.rover_id);
+    if (!session) return;
+    pool_touch(pool, session);
+    
+    if (session->udp_active) {
+        uint32_t behind = session->udp_max_seq - seq;
+        if (seq == session->udp_max_seq ||
+            (behind < TELEMETRY_UDP_RESTART_GAP && (int32_t)(seq - session->udp_max_seq) < 0)) {
+            // Atrasado ou duplicado: o estado ao vivo já é mais recente
+            session->udp_stale++;
+            return;
+        }
+        if ((int32_t)(seq - session->udp_max_seq) > 0) {
+            session->udp_lost += seq - session->udp_max_seq - 1;
+        }
+        // (sequência muito atrás: o rover reiniciou, recomeçar a contagem)
+    }
+    
+    session->udp_active = 1;
+    session->udp_max_seq = seq;
+    session->udp_received++;
+    session->udp_last_update = time(NULL);
+    samples_ingested++;
+    if (!session->entity) rover_registry_attach_telemetry(session);
+    update_session_live(session, &msg);
 }
 
 // Imprimir status de todas as conexões de telemetria
-void print_telemetry_status(TelemetrySession *sessions, int count) {
+void print_telemetry_status(const TelemetryPool *pool) {
     print_timestamp();
     printf("\n╔════════════════════════════════════════════════════════════════╗\n");
     printf("║              📡 ESTADO DAS TELEMETRIAS                        ║\n");
@@ -129,22 +846,23 @@ void print_telemetry_status(TelemetrySession *sessions, int count) {
     printf("║ Rover      │ Posição        │ Bat  │ Temp  │ Sinal │ Ativo   ║\n");
     printf("╠════════════════════════════════════════════════════════════════╣\n");
     
-    if (count == 0) {
+    if (pool->live == 0) {
         printf("║ Nenhuma telemetria ativa                                       ║\n");
     } else {
-        for (int i = 0; i < count; i++) {
-            if (!sessions[i].active) continue;
+        for (size_t i = 0; i < pool->used; i++) {
+            const TelemetrySession *s = telemetry_pool_at(pool, i);
+            if (!s->active) continue;
             
-            time_t time_since_update = time(NULL) - sessions[i].last_update;
+            time_t time_since_update = time(NULL) - s->last_update;
             const char *status = (time_since_update < 10) ? "✓ OK" : "⚠ LENTO";
             
             printf("║ %-10s │ (%.1f, %.1f)    │ %3u%% │ %.1f° │ %3u%% │ %s  ║\n",
-                   sessions[i].rover_id,
-                   sessions[i].last_position_x,
-                   sessions[i].last_position_y,
-                   sessions[i].last_battery,
-                   sessions[i].last_temperature,
-                   sessions[i].last_signal_strength,
+                   s->rover_id,
+                   s->last_position_x,
+                   s->last_position_y,
+                   s->last_battery,
+                   s->last_temperature,
+                   s->last_signal_strength,
                    status);
         }
     }
@@ -189,20 +907,269 @@ void send_telemetry_message(int fd, TelemetryMessage *msg) {
     if (fd < 0) return;
     
     msg->timestamp = (uint32_t)time(NULL);
+    msg->timestamp_ms = 0;
     msg->nonce = rand() % 100000;
     
-    ssize_t sent = send(fd, (char*)msg, sizeof(TelemetryMessage), 0);
+    // Mensagens isoladas usam sempre o formato v1
+    TelemetryMessageV1 wire;
+    message_to_v1(&wire, msg);
+    ssize_t sent = send(fd, (char*)&wire, sizeof(wire), 0);
     
     if (sent < 0) {
         print_timestamp();
         printf("❌ Erro ao enviar telemetria\n");
-    } else if (sent == sizeof(TelemetryMessage)) {
+    } else if (sent == sizeof(wire)) {
         print_timestamp();
         printf("[SENT] 📡 Telemetria enviada: %s\n", msg->rover_id);
         printf("   Pos: (%.2f, %.2f) | Bat: %u%% | Temp: %.1f°C\n\n",
                msg->position_x, msg->position_y, msg->battery, msg->temperature);
     } else {
         print_timestamp();
-        printf("⚠  Envio parcial de telemetria (%zd/%zu bytes)\n\n", sent, sizeof(TelemetryMessage));
+        printf("⚠  Envio parcial de telemetria (%zd/%zu bytes)\n\n", sent, sizeof(wire));
+    }
+}
+// ============ BATCHER (ROVER) ============
+
+static uint64_t monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+int telemetry_negotiate(int fd, const char *rover_id) {
+    if (fd <= 0 || !rover_id) return 1;
+    
+    TelemetryHello hello;
+    memset(&hello, 0, sizeof(hello));
+    hello.magic = TELEMETRY_HELLO_MAGIC;
+    hello.version = TELEMETRY_VERSION_MAX;
+    strncpy(hello.rover_id, rover_id, sizeof(hello.rover_id) - 1);
+    
+    if (send(fd, &hello, sizeof(hello), MSG_NOSIGNAL) != (ssize_t)sizeof(hello)) return 1;
+    
+    struct timeval tv = {TELEMETRY_HELLO_TIMEOUT, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    
+    TelemetryHelloAck ack;
+    ssize_t r = recv(fd, &ack, sizeof(ack), MSG_WAITALL);
+    
+    tv.tv_sec = 0;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    
+    if (r != (ssize_t)sizeof(ack) || ack.magic != TELEMETRY_HELLO_MAGIC) {
+        print_timestamp();
+        printf("⚠  Servidor sem suporte a telemetria v2 - a usar v1\n\n");
+        return 1;
+    }
+    
+    print_timestamp();
+    printf("🤝 Telemetria negociada: versão %u\n\n", ack.version);
+    return clamp_version(ack.version);
+}
+
+void telemetry_batcher_init(TelemetryBatcher *b, int fd, int version,
+                            size_t max_samples, uint32_t max_latency_ms) {
+    memset(b, 0, sizeof(*b));
+    b->fd = fd;
+    b->version = clamp_version(version);
+    b->max_samples = (max_samples == 0 || max_samples > TELEMETRY_BATCH_MAX_SAMPLES) ?
+                     TELEMETRY_BATCH_MAX_SAMPLES : max_samples;
+    b->max_latency_ms = max_latency_ms;
+    
+    // O ciclo do rover nunca deve bloquear à espera do socket
+    if (fd > 0) {
+        int flags = fcntl(fd, F_GETFL, 0);
+        if (flags >= 0) fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    }
+}
+
+// Tentar enviar o resto de um frame parcialmente enviado (1=drenado)
+static int batcher_drain_pending(TelemetryBatcher *b) {
+    while (b->pending_off < b->pending_len) {
+        ssize_t sent = send(b->fd, b->pending + b->pending_off,
+                            b->pending_len - b->pending_off, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) return 0;
+            return -1;
+        }
+        b->pending_off += (size_t)sent;
+    }
+    b->pending_len = b->pending_off = 0;
+    return 1;
+}
+
+int telemetry_batcher_flush(TelemetryBatcher *b) {
+    if (!b || b->fd <= 0) return -1;
+    
+    // Um frame de cada vez: o anterior tem de sair completo primeiro
+    int drained = batcher_drain_pending(b);
+    if (drained <= 0) return drained;
+    if (b->count == 0) return 0;
+    
+    struct iovec iov[2];
+    TelemetryBatchHeader hdr;
+    TelemetryV2Header hdr_v2;
+    uint8_t encoded[TELEMETRY_BATCH_MAX_SAMPLES * TELEMETRY_V2_MAX_SAMPLE];
+    TelemetryMessageV1 legacy[TELEMETRY_BATCH_MAX_SAMPLES];
+    
+    if (b->version >= 2) {
+        // Deltas relativos à última amostra enviada (o ID seguiu na negociação)
+        size_t len = 0;
+        for (size_t i = 0; i < b->count; i++) {
+            len += encode_sample_v2(&b->v2, b->version, &b->samples[i], encoded + len);
+        }
+        hdr_v2.length = (uint16_t)len;
+        hdr_v2.count = (uint8_t)b->count;
+        iov[0].iov_base = &hdr_v2;
+        iov[0].iov_len = sizeof(hdr_v2);
+        iov[1].iov_base = encoded;
+        iov[1].iov_len = len;
+    } else {
+        hdr.magic = TELEMETRY_BATCH_MAGIC;
+        hdr.count = (uint16_t)b->count;
+        hdr.reserved = 0;
+        iov[0].iov_base = &hdr;
+        iov[0].iov_len = sizeof(hdr);
+        for (size_t i = 0; i < b->count; i++) message_to_v1(&legacy[i], &b->samples[i]);
+        iov[1].iov_base = legacy;
+        iov[1].iov_len = b->count * sizeof(TelemetryMessageV1);
+    }
+    
+    // Cabeçalho + amostras num único writev (um segmento TCP por lote)
+    size_t total = iov[0].iov_len + iov[1].iov_len;
+    ssize_t sent = writev(b->fd, iov, 2);
+    if (sent < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) return -1;
+        sent = 0;
+    }
+    
+    if ((size_t)sent < total) {
+        // Envio parcial ou socket cheio: o frame já está codificado (o estado
+        // v2 avançou), por isso o resto é guardado e enviado antes do próximo
+        memcpy(b->pending, iov[0].iov_base, iov[0].iov_len);
+        memcpy(b->pending + iov[0].iov_len, iov[1].iov_base, iov[1].iov_len);
+        b->pending_len = total;
+        b->pending_off = (size_t)sent;
+    }
+    
+    b->frames_sent++;
+    b->samples_sent += b->count;
+    
+    print_timestamp();
+    printf("[SENT] 📡 Lote de telemetria v%d: %zu amostras, %zu bytes (%llu lotes)\n",
+           b->version, b->count, total, (unsigned long long)b->frames_sent);
+    
+    b->count = 0;
+    return 0;
+}
+
+int telemetry_batcher_read_control(TelemetryBatcher *b, TelemetryRateControl *ctl) {
+    if (!b || b->fd <= 0) return -1;
+    
+    while (1) {
+        ssize_t n = recv(b->fd, b->control + b->control_len,
+                         sizeof(b->control) - b->control_len, MSG_DONTWAIT);
+        if (n == 0) return -1;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        }
+        
+        b->control_len += (size_t)n;
+        if (b->control_len < sizeof(b->control)) continue;
+        b->control_len = 0;
+        
+        TelemetryRateControl msg;
+        memcpy(&msg, b->control, sizeof(msg));
+        if (msg.magic != TELEMETRY_CONTROL_MAGIC || msg.sample_interval_ms == 0) {
+            continue;   // Lixo: descartar e tentar a próxima mensagem
+        }
+        *ctl = msg;
+        return 1;
     }
-}
\ No newline at end of file
+}
+
+int telemetry_batcher_add(TelemetryBatcher *b, const TelemetryMessage *msg) {
+    if (!b || !msg || b->fd <= 0) return -1;
+    
+    if (b->count == b->max_samples) {
+        // Lote anterior ainda preso no socket: descartar a amostra mais antiga
+        memmove(b->samples, b->samples + 1, (b->count - 1) * sizeof(TelemetryMessage));
+        b->count--;
+        b->samples_dropped++;
+    }
+    
+    if (b->count == 0) b->first_sample_ms = monotonic_ms();
+    b->samples[b->count++] = *msg;
+    
+    if (b->count >= b->max_samples) return telemetry_batcher_flush(b);
+    return 0;
+}
+
+int telemetry_batcher_poll(TelemetryBatcher *b) {
+    if (!b || b->fd <= 0) return -1;
+    
+    if (b->pending_len > 0 ||
+        (b->count > 0 && monotonic_ms() - b->first_sample_ms >= b->max_latency_ms)) {
+        return telemetry_batcher_flush(b);
+    }
+    return 0;
+}
+
+// ============ CANAL UDP (ROVER) ============
+
+int create_telemetry_udp_connection(const char *host, int port) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        perror("socket telemetria UDP cliente");
+        return -1;
+    }
+    
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    
+    // connect() fixa o destino: basta send() por amostra
+    if (inet_pton(AF_INET, host, &addr.sin_addr) <= 0 ||
+        connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("connect telemetria UDP");
+        close(fd);
+        return -1;
+    }
+    
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags >= 0) fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    
+    print_timestamp();
+    printf("✅ Canal UDP de telemetria ativo (%s:%d)\n\n", host, port);
+    return fd;
+}
+
+void send_telemetry_datagram(int fd, uint32_t seq, const TelemetryMessage *msg) {
+    if (fd < 0 || !msg) return;
+    
+    uint8_t buf[TELEMETRY_DATAGRAM_SIZE];
+    memset(buf, 0, sizeof(buf));
+    ml_put_le32(buf, TELEMETRY_DATAGRAM_MAGIC);
+    buf[4] = TELEMETRY_DATAGRAM_VERSION;
+    ml_put_le16(buf + 6, TELEMETRY_DATAGRAM_SIZE);
+    ml_put_le32(buf + TDG_OFF_SEQ, seq);
+    ml_put_le32(buf + TDG_OFF_TIMESTAMP, msg->timestamp);
+    ml_put_le16(buf + TDG_OFF_TIMESTAMP_MS, msg->timestamp_ms);
+    memcpy(buf + TDG_OFF_ROVER_ID, msg->rover_id, sizeof(msg->rover_id));
+    ml_put_lef32(buf + TDG_OFF_POSITION_X, msg->position_x);
+    ml_put_lef32(buf + TDG_OFF_POSITION_Y, msg->position_y);
+    buf[TDG_OFF_BATTERY] = msg->battery;
+    buf[TDG_OFF_STATE] = msg->state;
+    ml_put_lef32(buf + TDG_OFF_TEMPERATURE, msg->temperature);
+    buf[TDG_OFF_SIGNAL] = msg->signal_strength;
+    ml_put_le32(buf + TDG_OFF_NONCE, msg->nonce);
+    
+    uint32_t crc = crc32c(0, buf, 8);
+    crc = crc32c(crc, buf + 12, sizeof(buf) - 12);
+    ml_put_le32(buf + 8, crc);
+    
+    // Sem retransmissão: se o socket estiver cheio a amostra perde-se
+    send(fd, buf, sizeof(buf), MSG_DONTWAIT);
+}
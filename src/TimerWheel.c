@@ -0,0 +1,207 @@
+// ============ TimerWheel.c ============
+// Implementação da roda de temporizadores hierárquica
+#include "TimerWheel.h"
+#include <string.h>
+
+#define TIMER_WHEEL_MASK (TIMER_WHEEL_SLOTS - 1)
+#define LEVEL_SHIFT(l) ((l) * TIMER_WHEEL_BITS)
+#define WHEEL_SPAN ((uint64_t)1 << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_BITS))
+
+static uint64_t tick_of(uint64_t ms) {
+    return ms / TIMER_WHEEL_TICK_MS;
+}
+
+// Tick em que o temporizador vence: arredondar para cima, nunca dispara cedo
+static uint64_t expiry_tick(uint64_t ms) {
+    return (ms + TIMER_WHEEL_TICK_MS - 1) / TIMER_WHEEL_TICK_MS;
+}
+
+// ============ LISTAS ============
+
+static void list_init(Timer *head) {
+    head->next = head->prev = head;
+}
+
+static void list_insert(Timer *head, Timer *timer) {
+    timer->prev = head->prev;
+    timer->next = head;
+    head->prev->next = timer;
+    head->prev = timer;
+}
+
+static void list_unlink(Timer *timer) {
+    timer->prev->next = timer->next;
+    timer->next->prev = timer->prev;
+    timer->next = timer->prev = NULL;
+}
+
+// ============ COLOCAÇÃO ============
+
+// Nível mais baixo que alcança o tick de expiração; ranhura pelos bits do
+// próprio tick (o nível l só é visitado quando os bits abaixo voltam a 0).
+// first_tick: primeiro tick ainda por processar
+static void wheel_place(TimerWheel *wheel, Timer *timer, uint64_t first_tick) {
+    uint64_t expires = expiry_tick(timer->expires_ms);
+    if (expires < first_tick) expires = first_tick;          // Já vencido
+
+    uint64_t delta = expires - wheel->tick;
+    if (delta >= WHEEL_SPAN) {
+        // Além da roda: fica na última ranhura alcançável e volta a ser
+        // colocado quando lá chegar
+        delta = WHEEL_SPAN - 1;
+        expires = wheel->tick + delta;
+    }
+
+    int level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 &&
+           delta >= ((uint64_t)1 << LEVEL_SHIFT(level + 1))) {
+        level++;
+    }
+    int slot = (int)((expires >> LEVEL_SHIFT(level)) & TIMER_WHEEL_MASK);
+
+    timer->level = level;
+    timer->slot = slot;
+    list_insert(&wheel->slots[level][slot], timer);
+    wheel->occupied[level] |= (uint64_t)1 << slot;
+}
+
+static void wheel_unlink(TimerWheel *wheel, Timer *timer) {
+    Timer *head = &wheel->slots[timer->level][timer->slot];
+    list_unlink(timer);
+    if (head->next == head) {
+        wheel->occupied[timer->level] &= ~((uint64_t)1 << timer->slot);
+    }
+}
+
+// Esvaziar uma ranhura para a lista dst
+static void wheel_take_slot(TimerWheel *wheel, int level, int slot, Timer *dst) {
+    Timer *head = &wheel->slots[level][slot];
+    while (head->next != head) {
+        Timer *timer = head->next;
+        list_unlink(timer);
+        list_insert(dst, timer);
+    }
+    wheel->occupied[level] &= ~((uint64_t)1 << slot);
+}
+
+static int wheel_empty(const TimerWheel *wheel) {
+    for (int l = 0; l < TIMER_WHEEL_LEVELS; l++) {
+        if (wheel->occupied[l]) return 0;
+    }
+    return 1;
+}
+
+// ============ API ============
+
+void timer_wheel_init(TimerWheel *wheel, uint64_t now_ms) {
+    for (int l = 0; l < TIMER_WHEEL_LEVELS; l++) {
+        for (int s = 0; s < TIMER_WHEEL_SLOTS; s++) {
+            list_init(&wheel->slots[l][s]);
+        }
+        wheel->occupied[l] = 0;
+    }
+    wheel->tick = tick_of(now_ms);
+    wheel->armed = 0;
+}
+
+void timer_init(Timer *timer, TimerCallback fn, void *arg) {
+    memset(timer, 0, sizeof(*timer));
+    timer->fn = fn;
+    timer->arg = arg;
+}
+
+int timer_armed(const Timer *timer) {
+    return timer->next != NULL;
+}
+
+void timer_cancel(TimerWheel *wheel, Timer *timer) {
+    if (!timer_armed(timer)) return;
+    wheel_unlink(wheel, timer);
+    wheel->armed--;
+}
+
+void timer_arm(TimerWheel *wheel, Timer *timer, uint64_t expires_ms) {
+    timer_cancel(wheel, timer);
+    timer->expires_ms = expires_ms;
+    wheel_place(wheel, timer, wheel->tick + 1);
+    wheel->armed++;
+}
+
+int timer_wheel_advance(TimerWheel *wheel, uint64_t now_ms) {
+    uint64_t target = tick_of(now_ms);
+
+    // Recolher primeiro os vencidos: os callbacks podem rearmar na mesma ranhura
+    Timer expired;
+    list_init(&expired);
+
+    while (wheel->tick < target) {
+        uint64_t t = ++wheel->tick;
+
+        // Descer de nível as ranhuras que começam neste tick (do mais alto
+        // para o mais baixo, para que cheguem ao nível 0 ainda neste tick)
+        int top = 0;
+        while (top < TIMER_WHEEL_LEVELS - 1 &&
+               (t & (((uint64_t)1 << LEVEL_SHIFT(top + 1)) - 1)) == 0) {
+            top++;
+        }
+        for (int l = top; l >= 1; l--) {
+            int slot = (int)((t >> LEVEL_SHIFT(l)) & TIMER_WHEEL_MASK);
+            if (!(wheel->occupied[l] & ((uint64_t)1 << slot))) continue;
+
+            Timer cascade;
+            list_init(&cascade);
+            wheel_take_slot(wheel, l, slot, &cascade);
+            while (cascade.next != &cascade) {
+                Timer *timer = cascade.next;
+                list_unlink(timer);
+                wheel_place(wheel, timer, t);
+            }
+        }
+
+        int slot = (int)(t & TIMER_WHEEL_MASK);
+        if (wheel->occupied[0] & ((uint64_t)1 << slot)) {
+            wheel_take_slot(wheel, 0, slot, &expired);
+        }
+
+        // Roda vazia: saltar direto para o fim
+        if (wheel_empty(wheel)) wheel->tick = target;
+    }
+
+    int fired = 0;
+    while (expired.next != &expired) {
+        Timer *timer = expired.next;
+        list_unlink(timer);
+        wheel->armed--;
+        fired++;
+        timer->fn(timer, timer->arg);
+    }
+    return fired;
+}
+
+// Distância (1..TIMER_WHEEL_SLOTS) da ranhura atual à próxima ocupada
+static int next_occupied(uint64_t occupied, int current) {
+    int shift = (current + 1) & TIMER_WHEEL_MASK;
+    uint64_t rotated = (occupied >> shift) | (shift ? occupied << (TIMER_WHEEL_SLOTS - shift) : 0);
+    return __builtin_ctzll(rotated) + 1;
+}
+
+int timer_wheel_next_timeout(const TimerWheel *wheel, uint64_t now_ms) {
+    if (wheel->armed == 0) return -1;
+
+    uint64_t best = UINT64_MAX;
+    for (int l = 0; l < TIMER_WHEEL_LEVELS; l++) {
+        if (!wheel->occupied[l]) continue;
+
+        // Nível 0: o tick exato do temporizador; acima: o tick em que a
+        // ranhura desce de nível (início da ranhura)
+        uint64_t unit = wheel->tick >> LEVEL_SHIFT(l);
+        int d = next_occupied(wheel->occupied[l], (int)(unit & TIMER_WHEEL_MASK));
+        uint64_t at = (unit + (uint64_t)d) << LEVEL_SHIFT(l);
+        if (at < best) best = at;
+    }
+
+    uint64_t at_ms = best * TIMER_WHEEL_TICK_MS;
+    if (at_ms <= now_ms) return 0;
+    uint64_t wait = at_ms - now_ms;
+    return wait > INT32_MAX ? INT32_MAX : (int)wait;
+}
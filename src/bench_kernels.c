@@ -0,0 +1,138 @@
+// ============ bench_kernels.c ============
+// Benchmark dos kernels de agregação de telemetria
+// Mede o débito (milhões de elementos e GB por segundo, num único core)
+// de cada kernel em cada variante suportada pelo CPU.
+//
+// Uso: ./bin/bench_kernels [elementos] [repetições]
+
+#include "TelemetryKernels.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_DEFAULT_ELEMENTS (1u << 20)
+#define BENCH_DEFAULT_REPEATS 200
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Evita que o compilador elimine chamadas cujo resultado não é usado
+static volatile double bench_sink;
+
+static void report(const char *variant, const char *kernel, size_t n, size_t elem_size,
+                   int repeats, double elapsed) {
+    double elems = (double)n * repeats;
+    printf("  %-7s %-16s %9.1f Melem/s %8.2f GB/s\n",
+           variant, kernel, elems / elapsed / 1e6, elems * elem_size / elapsed / 1e9);
+}
+
+static void bench_variant(const TelemetryKernels *k, const float *f, const uint8_t *b,
+                          size_t n, int repeats) {
+    double t0, sink = 0.0;
+    float fmin, fmax;
+    uint8_t bmin, bmax;
+
+    t0 = now_seconds();
+    for (int r = 0; r < repeats; r++) {
+        k->minmax_f32(f, n, &fmin, &fmax);
+        sink += fmin + fmax;
+    }
+    report(k->name, "minmax_f32", n, sizeof(float), repeats, now_seconds() - t0);
+
+    t0 = now_seconds();
+    for (int r = 0; r < repeats; r++) sink += k->sum_f32(f, n);
+    report(k->name, "sum_f32", n, sizeof(float), repeats, now_seconds() - t0);
+
+    t0 = now_seconds();
+    for (int r = 0; r < repeats; r++) sink += (double)k->count_below_f32(f, n, 25.0f);
+    report(k->name, "count_below_f32", n, sizeof(float), repeats, now_seconds() - t0);
+
+    t0 = now_seconds();
+    for (int r = 0; r < repeats; r++) {
+        k->minmax_u8(b, n, &bmin, &bmax);
+        sink += bmin + bmax;
+    }
+    report(k->name, "minmax_u8", n, 1, repeats, now_seconds() - t0);
+
+    t0 = now_seconds();
+    for (int r = 0; r < repeats; r++) sink += (double)k->sum_u8(b, n);
+    report(k->name, "sum_u8", n, 1, repeats, now_seconds() - t0);
+
+    t0 = now_seconds();
+    for (int r = 0; r < repeats; r++) sink += (double)k->count_below_u8(b, n, 30);
+    report(k->name, "count_below_u8", n, 1, repeats, now_seconds() - t0);
+
+    bench_sink = sink;
+}
+
+// Confirmar que a variante produz os mesmos resultados que a escalar
+static int verify_variant(const TelemetryKernels *k, const TelemetryKernels *ref,
+                          const float *f, const uint8_t *b, size_t n) {
+    float a_min, a_max, r_min, r_max;
+    uint8_t ab_min, ab_max, rb_min, rb_max;
+
+    k->minmax_f32(f, n, &a_min, &a_max);
+    ref->minmax_f32(f, n, &r_min, &r_max);
+    k->minmax_u8(b, n, &ab_min, &ab_max);
+    ref->minmax_u8(b, n, &rb_min, &rb_max);
+
+    double sum = k->sum_f32(f, n), ref_sum = ref->sum_f32(f, n);
+    double diff = sum - ref_sum;
+    if (diff < 0) diff = -diff;
+
+    return a_min == r_min && a_max == r_max &&
+           ab_min == rb_min && ab_max == rb_max &&
+           diff <= 1e-9 * (ref_sum < 0 ? -ref_sum : ref_sum) + 1e-6 &&
+           k->count_below_f32(f, n, 25.0f) == ref->count_below_f32(f, n, 25.0f) &&
+           k->sum_u8(b, n) == ref->sum_u8(b, n) &&
+           k->count_below_u8(b, n, 30) == ref->count_below_u8(b, n, 30);
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = (argc > 1) ? (size_t)strtoul(argv[1], NULL, 10) : BENCH_DEFAULT_ELEMENTS;
+    int repeats = (argc > 2) ? atoi(argv[2]) : BENCH_DEFAULT_REPEATS;
+    if (n == 0 || repeats <= 0) {
+        fprintf(stderr, "Uso: %s [elementos] [repetições]\n", argv[0]);
+        return 1;
+    }
+
+    float *f = malloc(n * sizeof(float));
+    uint8_t *b = malloc(n);
+    if (!f || !b) {
+        fprintf(stderr, "Sem memória para %zu elementos\n", n);
+        return 1;
+    }
+
+    // Dados sintéticos com a forma da telemetria (temperatura, bateria)
+    srand(42);
+    for (size_t i = 0; i < n; i++) {
+        f[i] = 15.0f + (float)(rand() % 2000) / 100.0f;
+        b[i] = (uint8_t)(rand() % 101);
+    }
+
+    const TelemetryKernels *ref = telemetry_kernels_variant(TK_SCALAR);
+    printf("📊 Kernels de telemetria: %zu elementos x %d repetições (1 core)\n", n, repeats);
+    printf("   Seleção automática: %s\n\n", telemetry_kernels()->name);
+
+    int status = 0;
+    for (int v = 0; v < TK_VARIANTS; v++) {
+        const TelemetryKernels *k = telemetry_kernels_variant((TelemetryKernelISA)v);
+        if (!k) {
+            printf("  (variante %d não suportada neste CPU)\n", v);
+            continue;
+        }
+        if (!verify_variant(k, ref, f, b, n)) {
+            printf("  ❌ %s: resultados diferem da implementação escalar\n", k->name);
+            status = 1;
+        }
+        bench_variant(k, f, b, n, repeats);
+        printf("\n");
+    }
+
+    free(f);
+    free(b);
+    return status;
+}
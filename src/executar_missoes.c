@@ -166,7 +166,7 @@ void send_progress_update(int sockfd, struct sockaddr_in *server_addr,
     printf("📤 Enviando PROGRESS (seq=%u | progr=%u%% | bat=%u%%)\n",
            pkt.seq, progress, battery);
 
-    ssize_t result = send_udp_with_ack(sockfd, server_addr, (char *)&pkt, sizeof(pkt));
+    ssize_t result = send_udp_with_ack(sockfd, server_addr, &pkt);
 
     if (result < 0)
     {
@@ -248,17 +248,20 @@ void execute_mission_progress(int sockfd, struct sockaddr_in *server_addr,
                 int rv = select(sockfd + 1, &readfds, NULL, NULL, &tv);
                 if (rv > 0 && FD_ISSET(sockfd, &readfds))
                 {
-                    Packet ping_pkt;
+                    uint8_t buf[ML_WIRE_PACKET_SIZE];
+                    PacketView ping_pkt;
                     socklen_t addr_len = sizeof(*server_addr);
 
-                    int r = recvfrom(sockfd, &ping_pkt, sizeof(ping_pkt), 0,
+                    int r = recvfrom(sockfd, buf, sizeof(buf), 0,
                                      (struct sockaddr *)server_addr, &addr_len);
 
-                    if (r == sizeof(Packet) && ping_pkt.type == PKT_PING)
+                    if (r > 0 && ml_view_init(&ping_pkt, buf, (size_t)r) == ML_WIRE_OK &&
+                        ml_view_type(&ping_pkt) == PKT_PING)
                     {
                         print_timestamp();
                         printf("\n🏓 PING recebido - Respondendo...\n");
-                        process_ping_and_respond(sockfd, &ping_pkt, server_addr, state->rover_id);
+                        process_ping_and_respond(sockfd, &ping_pkt, server_addr, state->rover_id,
+                                                 state->conn_id);
                         print_timestamp();
                         printf("⏱ Continuando aguardar (%u segundos restantes)...\n",
                                state->update_interval - i - 1);
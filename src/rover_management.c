@@ -40,6 +40,9 @@ void prepare_request_packet(RoverState *state, Packet *pkt) {
     pkt->battery = state->battery;
     pkt->progress = 0;
     pkt->nonce = rand() % 100000;
+    pkt->conn_id = state->conn_id;
+    pkt->resume_token = state->resume_token;
+    pkt->queue_depth = state->queue_depth;
     strncpy(pkt->rover_id, state->rover_id, sizeof(pkt->rover_id) - 1);
 }
 
@@ -51,6 +54,8 @@ void prepare_progress_packet(RoverState *state, Packet *pkt, uint8_t progress, u
     pkt->battery = battery;
     pkt->progress = progress;
     pkt->nonce = rand() % 100000;
+    pkt->conn_id = state->conn_id;
+    pkt->resume_token = state->resume_token;
     strncpy(pkt->rover_id, state->rover_id, sizeof(pkt->rover_id) - 1);
     strncpy(pkt->mission_id, state->mission_id, sizeof(pkt->mission_id) - 1);
     strncpy(pkt->task_type, state->task_type, sizeof(pkt->task_type) - 1);
@@ -64,7 +69,49 @@ void prepare_complete_packet(RoverState *state, Packet *pkt, uint8_t battery) {
     pkt->battery = battery;
     pkt->progress = 100;
     pkt->nonce = rand() % 100000;
+    pkt->conn_id = state->conn_id;
+    pkt->resume_token = state->resume_token;
     strncpy(pkt->rover_id, state->rover_id, sizeof(pkt->rover_id) - 1);
     strncpy(pkt->mission_id, state->mission_id, sizeof(pkt->mission_id) - 1);
     strncpy(pkt->task_type, state->task_type, sizeof(pkt->task_type) - 1);
-}
\ No newline at end of file
+}
+// ============ FILA DE MISSÕES ============
+
+void mission_queue_init(MissionQueue *queue) {
+    memset(queue, 0, sizeof(*queue));
+}
+
+static Packet *queue_at(MissionQueue *queue, int i) {
+    return &queue->items[(queue->head + i) % MISSION_QUEUE_MAX];
+}
+
+int mission_queue_push(MissionQueue *queue, const Packet *assign_pkt) {
+    if (queue->count >= MISSION_QUEUE_MAX) return -1;
+    for (int i = 0; i < queue->count; i++) {
+        if (strcmp(queue_at(queue, i)->mission_id, assign_pkt->mission_id) == 0) return -1;
+    }
+    *queue_at(queue, queue->count) = *assign_pkt;
+    queue->count++;
+    return 0;
+}
+
+int mission_queue_pop(MissionQueue *queue, Packet *assign_pkt) {
+    if (queue->count == 0) return -1;
+    *assign_pkt = queue->items[queue->head];
+    queue->head = (queue->head + 1) % MISSION_QUEUE_MAX;
+    queue->count--;
+    return 0;
+}
+
+// Desloca as seguintes uma posição para manter a ordem
+int mission_queue_remove(MissionQueue *queue, const char *mission_id) {
+    for (int i = 0; i < queue->count; i++) {
+        if (strcmp(queue_at(queue, i)->mission_id, mission_id) != 0) continue;
+        for (int j = i; j < queue->count - 1; j++) {
+            *queue_at(queue, j) = *queue_at(queue, j + 1);
+        }
+        queue->count--;
+        return 1;
+    }
+    return 0;
+}
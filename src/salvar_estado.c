@@ -75,6 +75,8 @@ void save_rover_state(const char *rover_id, RoverState *state,
     persisted.position_x = position_x;
     persisted.position_y = position_y;
     persisted.timestamp = (uint32_t)time(NULL);
+    persisted.conn_id = state->conn_id;
+    persisted.resume_token = state->resume_token;
     
     // Escrever no arquivo
     FILE *f = fopen(filename, "wb");
@@ -146,6 +148,8 @@ int load_rover_state(const char *rover_id, RoverState *state,
     state->mission_duration = 0;
     state->update_interval = 0;
     state->has_mission = 0;
+    state->conn_id = persisted.conn_id;
+    state->resume_token = persisted.resume_token;
     
     *position_x = persisted.position_x;
     *position_y = persisted.position_y;